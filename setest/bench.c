@@ -0,0 +1,227 @@
+#include <time.h>
+#include <math.h>
+#include "setest.h"
+
+// Benchmark mode (option -b):
+// The test cases are run with the parameters of the fixture file,
+// like in gen mode, but the checks are skipped and the test case
+// functions (including setup) are timed instead.
+// Each ITERATION section of the fixture is a workload; its multivalues
+// give the samples. Fixture parameters:
+//   bench-repeat: N      call the test case N times per iteration
+//   bench-cold: 1        call swe_close() before each call
+//   bench-tolerance: x   regression, if median is more than x slower
+//                        than in the baseline (default 0.25)
+// The results are written to <name>.json. With option -c <file>, they are
+// compared against a baseline file written by an earlier run.
+
+static double now( );
+static int bench_param_i(const char *name, int default_value, test_context *ctx);
+static void workload_name(char *name, test_context *ctx);
+static void finish_workload(test_context *ctx);
+static void write_json(test_context *ctx);
+static void compare_with_baseline(test_context *ctx);
+static int compare_doubles(const void *a, const void *b);
+
+void run_testcase(setupFunction setup, testFunction test, test_context *ctx) {
+  if (!ctx->benchmode) {
+    if (setup) setup( );
+    test(ctx);
+    return;
+  }
+  bench_data *b = ctx->bench;
+  test_key key = {
+    .testsuite = ctx->current.suite.id,
+    .testcase  = ctx->current.testcase.id,
+    .iteration = ctx->current.iteration.section
+  };
+  if (b->samples > 0 &&
+      (key.testsuite != b->key.testsuite ||
+       key.testcase  != b->key.testcase  ||
+       key.iteration != b->key.iteration)) {
+    finish_workload(ctx);
+  }
+  if (b->samples == 0) {
+    b->key = key;
+    workload_name(b->name,ctx);
+  }
+  int repeat = bench_param_i("bench-repeat",1,ctx);
+  bool cold = bench_param_i("bench-cold",0,ctx) != 0;
+  if (repeat < 1) repeat = 1;
+// Later calls of the same iteration must get the same parameters
+  mvalues_state state;
+  multivalues_save(ctx->multivalues,&state);
+  double total = 0;
+  for (int i=0; i<repeat; i++) {
+    if (i > 0) multivalues_restore(ctx->multivalues,&state);
+    if (cold) swe_close( );
+    double t0 = now( );
+    if (setup) setup( );
+    test(ctx);
+    total += now( ) - t0;
+  }
+  if (b->samples < SETEST_MAX_BENCH_SAMPLES) {
+    b->sample[b->samples++] = total / repeat;
+  }
+  b->calls += repeat;
+  b->total += total;
+}
+
+void bench_close(test_context *ctx) {
+  bench_data *b = ctx->bench;
+  if (b->samples > 0) finish_workload(ctx);
+  write_json(ctx);
+  printf("%-10s %-50s %8s %12s %10s %10s %10s\n",
+    "workload","name","calls","calls/s","p50[us]","p90[us]","p99[us]");
+  for (int i=0; i<b->length; i++) {
+    bench_result *r = &b->result[i];
+    printf("%-10s %-50.50s %8d %12.1f %10.3f %10.3f %10.3f\n",
+      r->id, r->name, r->calls, r->throughput, r->p50, r->p90, r->p99);
+  }
+  if (!is_empty(b->compare_file)) compare_with_baseline(ctx);
+}
+
+static void finish_workload(test_context *ctx) {
+  bench_data *b = ctx->bench;
+  if (b->length >= SETEST_MAX_BENCH_RESULTS) {
+    fprintf(stderr,"Maximum number %d of workloads exceeded\n",SETEST_MAX_BENCH_RESULTS);
+    exit(EXIT_FAILURE);
+  }
+  bench_result *r = &b->result[b->length++];
+  sprintf(r->id,"%d.%d.%d",b->key.testsuite,b->key.testcase,b->key.iteration);
+  strcpy(r->name,b->name);
+  qsort(b->sample,b->samples,sizeof(double),compare_doubles);
+  auto double percentile(double q);
+  r->samples = b->samples;
+  r->calls = b->calls;
+  r->total = b->total;
+  r->throughput = b->total > 0 ? b->calls / b->total : 0;
+  r->p50 = percentile(0.50);
+  r->p90 = percentile(0.90);
+  r->p99 = percentile(0.99);
+  r->max = b->sample[b->samples-1] * 1e6;
+  b->samples = 0;
+  b->calls = 0;
+  b->total = 0;
+  double percentile(double q) {
+    int i = (int) ceil(q * b->samples) - 1;
+    if (i < 0) i = 0;
+    return b->sample[i] * 1e6;
+  }
+}
+
+static void write_json(test_context *ctx) {
+  bench_data *b = ctx->bench;
+  char file[SETEST_MAX_SYMBOL_SIZE+5], version[20];
+  sprintf(file,"%s.json",ctx->test_collection);
+  FILE *f = fopen(file,"w");
+  if (!f) {
+    fprintf(stderr,"Can't open file '%s' for output... using stdout\n",file);
+    f = stdout;
+  }
+  swe_version(version);
+  time_t t = time(NULL);
+  struct tm tm = *localtime(&t);
+  fprintf(f,"{\n");
+  fprintf(f,"  \"collection\": \"%s\",\n",ctx->test_collection);
+  fprintf(f,"  \"swisseph-version\": \"%s\",\n",version);
+  fprintf(f,"  \"localtime\": \"%02d.%02d.%04d %02d:%02d:%02d\",\n",
+    tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+  fprintf(f,"  \"workloads\": [\n");
+// One workload per line, the baseline reader depends on it
+  for (int i=0; i<b->length; i++) {
+    bench_result *r = &b->result[i];
+    fprintf(f,"    { \"id\": \"%s\", \"name\": \"%s\", \"samples\": %d, \"calls\": %d, "
+              "\"total-s\": %.6f, \"throughput\": %.1f, "
+              "\"p50-us\": %.3f, \"p90-us\": %.3f, \"p99-us\": %.3f, \"max-us\": %.3f }%s\n",
+      r->id, r->name, r->samples, r->calls, r->total, r->throughput,
+      r->p50, r->p90, r->p99, r->max,
+      i < b->length - 1 ? "," : "");
+  }
+  fprintf(f,"  ]\n}\n");
+  if (f != stdout) {
+    fclose(f);
+    printf("Benchmark results written to %s\n",file);
+  }
+}
+
+static void compare_with_baseline(test_context *ctx) {
+  bench_data *b = ctx->bench;
+  FILE *f = fopen(b->compare_file,"r");
+  if (!f) {
+    fprintf(stderr,"Can't open baseline file '%s'\n",b->compare_file);
+    exit(EXIT_FAILURE);
+  }
+  const char *tol = read_value(&ctx->reader,"bench-tolerance",GENERAL,GENERAL);
+  double tolerance = tol ? atof(tol) : SETEST_BENCH_TOLERANCE;
+  bench_result base[SETEST_MAX_BENCH_RESULTS];
+  int nbase = 0;
+  char line[READER_MAX_LINESIZE];
+  while (fgets(line,sizeof(line),f) && nbase < SETEST_MAX_BENCH_RESULTS) {
+    bench_result *r = &base[nbase];
+    if (sscanf(line,
+      " { \"id\": \"%49[^\"]\", \"name\": \"%99[^\"]\", \"samples\": %d, \"calls\": %d, "
+      "\"total-s\": %lf, \"throughput\": %lf, "
+      "\"p50-us\": %lf, \"p90-us\": %lf, \"p99-us\": %lf, \"max-us\": %lf",
+      r->id, r->name, &r->samples, &r->calls, &r->total, &r->throughput,
+      &r->p50, &r->p90, &r->p99, &r->max) == 10) {
+      nbase++;
+    }
+  }
+  fclose(f);
+  printf("\nComparison with baseline %s (tolerance %.0f%%):\n",
+    b->compare_file, tolerance * 100);
+  printf("%-10s %-50s %10s %10s %8s\n",
+    "workload","name","base[us]","p50[us]","ratio");
+  int regressions = 0;
+  for (int i=0; i<b->length; i++) {
+    bench_result *r = &b->result[i], *rb = NULL;
+    for (int j=0; j<nbase && !rb; j++) {
+      if (equals(base[j].id,r->id) && equals(base[j].name,r->name)) rb = &base[j];
+    }
+    if (!rb || rb->p50 <= 0) {
+      printf("%-10s %-50.50s %10s %10.3f %8s\n", r->id, r->name, "-", r->p50, "new");
+      continue;
+    }
+    double ratio = r->p50 / rb->p50;
+    bool regression = ratio > 1 + tolerance;
+    if (regression) regressions++;
+    printf("%-10s %-50.50s %10.3f %10.3f %8.2f%s\n",
+      r->id, r->name, rb->p50, r->p50, ratio, regression ? "  REGRESSION" : "");
+  }
+  printf("%d regressions\n",regressions);
+  ctx->count.failures += regressions;
+}
+
+// Name of a workload: test case description (preferably from the fixture),
+// followed by the description of the ITERATION section, if any
+static void workload_name(char *name, test_context *ctx) {
+  const char* tcdescr = read_value_in_section(&ctx->reader,"section-descr",TESTCASE);
+  const char* descr = read_value_in_section(&ctx->reader,"section-descr",ITERATION);
+  if (!tcdescr) tcdescr = ctx->current.testcase.descr;
+  snprintf(name,2*SETEST_MAX_SYMBOL_SIZE,"%s%s%s",
+    tcdescr ? tcdescr : "",
+    descr ? " / " : "",
+    descr ? descr : "");
+  trim_trailing_space(name);
+// The name is written as JSON string
+  for (char *p = name; *p != '\0'; p++) {
+    if (*p == '"' || *p == '\\') *p = '\'';
+  }
+}
+
+static int bench_param_i(const char *name, int default_value, test_context *ctx) {
+  const char *value = read_value(&ctx->reader,name,ITERATION,GENERAL);
+  return value ? atoi(value) : default_value;
+}
+
+static double now( ) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double d = *(const double *) a - *(const double *) b;
+  return d < 0 ? -1 : d > 0 ? 1 : 0;
+}
@@ -0,0 +1,39 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#define SETEST_MAX_BENCH_SAMPLES  10000
+#define SETEST_MAX_BENCH_RESULTS  200
+#define SETEST_BENCH_TOLERANCE    0.25
+
+typedef void (*setupFunction)(void);
+
+// Timing of one workload, i.e. of one ITERATION section of the fixture
+// with all the iterations that its multivalues expand to
+typedef struct {
+  char id[SETEST_MAX_SYMBOL_SIZE];          // "suite.testcase.section"
+  char name[2*SETEST_MAX_SYMBOL_SIZE];
+  int samples;                              // iterations
+  int calls;                                // iterations * bench-repeat
+  double total;                             // seconds
+  double throughput;                        // calls per second
+  double p50, p90, p99, max;                // microseconds per call
+  } bench_result;
+
+typedef struct bench_data {
+  char compare_file[SETEST_MAX_COMMAND_LENGTH];
+// Workload currently being measured
+  test_key key;
+  char name[2*SETEST_MAX_SYMBOL_SIZE];
+  int calls;
+  double total;
+  double sample[SETEST_MAX_BENCH_SAMPLES];
+  int samples;
+// Finished workloads
+  bench_result result[SETEST_MAX_BENCH_RESULTS];
+  int length;
+  } bench_data;
+
+void run_testcase(setupFunction setup, testFunction test, test_context *ctx);
+void bench_close(test_context *ctx);
+
+#endif
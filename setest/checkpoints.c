@@ -21,6 +21,7 @@ void check_dd(const double *field, const int length, const char *name, test_cont
 }
 
 void check_d_internal(const double field,const char* name, double precision, test_context *ctx) {
+  if (ctx->benchmode) return;
   if (!ctx->testmode) {
     typed_value act = { .value.d = field, .type = D };
     pair p = make_pair(name, & act );
@@ -40,6 +41,7 @@ void check_d_internal(const double field,const char* name, double precision, tes
 }
 
 void check_i(const int field,const char* name, test_context *ctx) {
+  if (ctx->benchmode) return;
   if (! ctx->testmode ) {
     typed_value act = { .value.i = field, .type = I };
     pair p = make_pair(name, &act);
@@ -59,6 +61,7 @@ void check_i(const int field,const char* name, test_context *ctx) {
 }
 
 void check_i_internal(const int field,const char* name, test_context *ctx) {
+  if (ctx->benchmode) return;
   if (!ctx->testmode) {
     typed_value act = { .value.i = field, .type = I };
     pair p = make_pair(name, & act );
@@ -195,6 +198,7 @@ void check_ii(const int *field, const int length, const char* name, test_context
 }
 
 void check_s(const char* field,const char* name, test_context *ctx) {
+  if (ctx->benchmode) return;
   if (! ctx->testmode ) {
     fprintf(ctx->out,"      %s: ",name);
     for (const char *p = field; *p!='\0';p++) {
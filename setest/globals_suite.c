@@ -58,5 +58,34 @@ void check_swehouses_armc_ex2_results(int rc, double armc, int ihsy, double *cus
   CHECK_I(rc);
 }
 
+// Functions that compute several dates or bodies in one call (*_array( ),
+// swe_calc_bodies( ) etc.) must give the same results as the functions for
+// one date or body. The test cases compute the results both ways and 
+// compare them with check_array_results( ).
+
+// Dates jd, jd + step, jd + 2 * step, ...
+void fill_date_series(double *tjd, int n, double jd, double step) {
+  for (int i=0; i<n; i++) tjd[i] = jd + i * step;
+}
+
+// Closes the files and forgets the saved positions, so that both ways 
+// of computing start from the same state
+void reset_ephemeris( ) {
+  swe_close( );
+  swe_set_ephe_path(NULL);
+}
+
+// x: n results of nvalues doubles each, from one call for all; 
+// x_exp: the same, from one call per date or body. The return codes
+// rc and rc_exp are compared, unless rc is NULL.
+void check_array_results(const double *x, const double *x_exp, int n, int nvalues, const int32 *rc, const int32 *rc_exp, test_context* ctx) {
+  for (int i=0; i<n; i++) {
+    if (rc != NULL) {
+      CHECK_EQUALS_I(rc[i],rc_exp[i]);
+    }
+    CHECK_EQUALS_DD(x + i*nvalues,nvalues,x_exp + i*nvalues);
+  }
+}
+
 // End of source file globals_suite.c
 
@@ -218,3 +218,23 @@ void multivalues_clear(mvalues_tab* multivalues) {
   multivalues->length = 0;
 }
 
+void multivalues_save(const mvalues_tab* multivalues, mvalues_state* state) {
+  state->length = multivalues->length;
+  for (int i=0; i<multivalues->length;i++) {
+    state->i[i] = multivalues->mv[i].i;
+    state->carry[i] = multivalues->mv[i].carry;
+  }
+}
+
+// Multivalues that were added after saving are reset to 'just created'
+void multivalues_restore(mvalues_tab* multivalues, const mvalues_state* state) {
+  for (int i=0; i<multivalues->length;i++) {
+    if (i < state->length) {
+      multivalues->mv[i].i = state->i[i];
+      multivalues->mv[i].carry = state->carry[i];
+    } else {
+      multivalues->mv[i].i = -1;
+      multivalues->mv[i].carry = false;
+    }
+  }
+}
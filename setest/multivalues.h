@@ -17,6 +17,13 @@ typedef struct {
   int length;
 } mvalues_tab;
 
+// Saved iteration state of all multivalues (used in benchmark mode)
+typedef struct {
+  int length;
+  int i[SETEST_MAX_MULTIVARS];
+  bool carry[SETEST_MAX_MULTIVARS];
+} mvalues_state;
+
 mvalues_tab* multivalues_create_table( );
 void multivalues_destroy_table( mvalues_tab* tab);
 int multivalues_get_index(const char* name,mvalues_tab* multivalues);
@@ -27,6 +34,8 @@ bool multivalues_all_done(mvalues_tab* multivalues);
 void parse_int_range( const char* value, mvalues* mval);
 void parse_double_range( const char* value, mvalues* mval);
 void multivalues_clear(mvalues_tab* multivalues);
+void multivalues_save(const mvalues_tab* multivalues, mvalues_state* state);
+void multivalues_restore(mvalues_tab* multivalues, const mvalues_state* state);
 
 bool add_int_to_table(int value, mvalues* mval);
 bool add_double_to_table(double value, mvalues* mval);
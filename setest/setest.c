@@ -28,6 +28,7 @@ void run( test_context* ctx ) {
   read_next_block( & ctx->reader, GENERAL );
   if (ctx->parameters.source) read_next_block( & ctx->parameters, GENERAL );
   run_tests( ctx );
+  if (ctx->benchmode) bench_close( ctx );
   print_stats( );
   general_cleanup( );
 // --- Done. Details follow
@@ -60,7 +61,11 @@ void run( test_context* ctx ) {
   }
   void open_output_stream() {
     char file[SETEST_MAX_SYMBOL_SIZE];
-    if (!ctx->testmode) {
+    if (ctx->benchmode) {
+// Benchmark mode: the values of gen mode are not needed
+      ctx->out = fopen("/dev/null","w");
+    }
+    else if (!ctx->testmode) {
       strcpy(file,ctx->test_collection);
       strcat(file,".exp");
       ctx->out = fopen(file,"w");
@@ -77,7 +82,7 @@ void run( test_context* ctx ) {
   }
   void print_stats( ) {
     printf( "%s '%s': Total %d/%d/%d", 
-      ctx->testmode ? "Testmode" : "gen-mode",
+      ctx->testmode ? "Testmode" : ctx->benchmode ? "bench-mode" : "gen-mode",
       ctx->test_collection,
       ctx->count.testsuite,
       ctx->count.testcase,
@@ -85,6 +90,9 @@ void run( test_context* ctx ) {
     if (ctx->testmode) {
       printf( " ... %d failures in %d iterations",ctx->count.failures, ctx->count.failed_iterations );
     }
+    if (ctx->benchmode && ctx->count.failures > 0) {
+      printf( " ... %d regressions",ctx->count.failures );
+    }
     printf(".\n");
     }
   void check_file_existence( ) {
@@ -124,7 +132,8 @@ void initialize_test_context( test_context *ctx ) {
     .precisions = { .all = DEFAULT_PRECISION, .xx = { [0 ... 5] = DEFAULT_PRECISION } },
     .multivalues = multivalues_create_table( ),
     .reader     = { .source = NULL },
-    .parameters = { .source = NULL }
+    .parameters = { .source = NULL },
+    .bench      = calloc( 1, sizeof( bench_data ) )
   };
   // The best readable way to initialize a char array:
   strcpy(ctx->test_collection, DEFAULT_TEST_COLLECTION );
@@ -135,6 +144,8 @@ void evaluate_cmdline_options(int argc, char** argv, test_context *ctx) {
   auto void parse_select(const char *optarg,test_key *selected);
   struct option long_options[] = {
     { "gen",        no_argument,       0, 'g' },
+    { "bench",      no_argument,       0, 'b' },
+    { "compare",    required_argument, 0, 'c' },
     { "verbose",    no_argument,       0, 'v' },
     { "select",     required_argument, 0, 's' },
     { "preprocess", required_argument, 0, 'P' },
@@ -144,7 +155,7 @@ void evaluate_cmdline_options(int argc, char** argv, test_context *ctx) {
   };
   while (1) {
     int option_index = 0;
-    c = getopt_long_only( argc, argv, "gvs:rp:P:?", long_options, &option_index );
+    c = getopt_long_only( argc, argv, "gbc:vs:rp:P:?", long_options, &option_index );
     if (c == -1) break;
     switch(c) {
       case 0:
@@ -153,6 +164,13 @@ void evaluate_cmdline_options(int argc, char** argv, test_context *ctx) {
       case 'g':
         ctx->testmode = false;
         break;
+      case 'b':
+        ctx->testmode = false;
+        ctx->benchmode = true;
+        break;
+      case 'c':
+        strcpy(ctx->bench->compare_file,optarg);
+        break;
       case 'p':
         ctx->parameters = get_param_reader(optarg);
         break;
@@ -285,6 +303,7 @@ void open_testcase(int id, char* description, test_context *ctx) {
   ctx->current.testcase.id = id;
   ctx->current.testcase.descr = description; // Transfer pointer only
   ctx->current.section = TESTCASE;
+  ctx->current.iteration.section = 0;
   if (ctx->verbose) {
     printf("  Opening test case \n    %d: %s\n", id, description);
   }
@@ -321,6 +340,7 @@ void open_iteration( int id, test_context *ctx ) {
     multivalues_clear(ctx->multivalues);
     // Read next iteration section if present (no error if nothing found)
     read_next_section( & ctx->reader, id, ITERATION );
+    ctx->current.iteration.section++;
   }
   if (!ctx->testmode && enabled) {
     fprintf(ctx->out,"    ITERATION\n");
@@ -465,6 +485,7 @@ void sha1_from_file(const char *name, SHA1HASH* hash) {
 void cleanup(test_context* ctx) {
 
   multivalues_destroy_table( ctx->multivalues );
+  free( ctx->bench );
 
 }
 
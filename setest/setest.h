@@ -51,6 +51,9 @@ typedef struct {
 
   bool testmode;
 
+// Benchmark mode: fixture is read as in gen mode, test cases are timed
+  bool benchmode;
+
 // Current test suite, testcase
   struct {
     struct {
@@ -63,6 +66,7 @@ typedef struct {
       } testcase;
     struct {
       int id;
+      int section;    // number of ITERATION section within test case
       failures failures;
       } iteration;
     t_section section;
@@ -106,6 +110,9 @@ typedef struct {
 
     bool verbose;
 
+// Timings in benchmark mode
+    struct bench_data *bench;
+
   } test_context;
 
 typedef void (*testFunction)(test_context*);
@@ -146,6 +153,7 @@ int get_disabled(const t_section section,test_context *ctx);
 
 
 #include "checkpoints.h"
+#include "bench.h"
 
 entry get_entry( const char *name, const st_type type, const test_context *ctx);
 
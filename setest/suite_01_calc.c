@@ -59,4 +59,275 @@ TESTCASE(5,"swe_calc_pctr( ) - planetocentic position") {
   check_swecalc_results(rc,xx,serr,ctx);
   }
 
+TESTCASE(6,"swe_calc_all_frames_ut( ) - all coordinate frames in one call") {
+  double xall[SE_NFRAME_VALUES], xaz[3];
+  double *xecl = xall + SE_FRAME_ECL, *xecl_xyz = xall + SE_FRAME_ECL_XYZ,
+         *xequ = xall + SE_FRAME_EQU, *xequ_xyz = xall + SE_FRAME_EQU_XYZ,
+         *xsid = xall + SE_FRAME_SID, *xhor = xall + SE_FRAME_HOR;
+  double geopos[3] = { GET_D(geolon), GET_D(geolat), GET_D(altitude) };
+  int ipl = GET_I(ipl);
+  swe_set_sid_mode(GET_I(sid_mode),0,0);
+  int rc = swe_calc_all_frames_ut(jd, ipl, iflag | iephe | SEFLG_SIDEREAL, geopos, 0, 0, xall, serr);
+// Each frame must be the same as from the functions for one frame
+  int rc_ecl = swe_calc_ut(jd, ipl, iflag | iephe, xx, serr);
+  CHECK_EQUALS_I(rc,rc_ecl | SEFLG_SIDEREAL);
+  CHECK_EQUALS_DD(xecl,6,xx);
+  swe_calc_ut(jd, ipl, iflag | iephe | SEFLG_XYZ, xx, serr);
+  CHECK_EQUALS_DD(xecl_xyz,6,xx);
+  swe_calc_ut(jd, ipl, iflag | iephe | SEFLG_EQUATORIAL | SEFLG_XYZ, xx, serr);
+  CHECK_EQUALS_DD(xequ_xyz,6,xx);
+  swe_calc_ut(jd, ipl, iflag | iephe | SEFLG_EQUATORIAL, xx, serr);
+  CHECK_EQUALS_DD(xequ,6,xx);
+  if (rc != ERR) {
+    swe_azalt(jd, SE_EQU2HOR, geopos, 0, 0, xx, xaz);
+    CHECK_EQUALS_DD(xhor,3,xaz);
+  }
+  swe_calc_ut(jd, ipl, iflag | iephe | SEFLG_SIDEREAL, xx, serr);
+  CHECK_EQUALS_DD(xsid,6,xx);
+  swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY,0,0);
+  }
+
+TESTCASE(7,"swe_calc_bodies_ut( ) - several bodies in one call") {
+  int32 ipl[] = { SE_SUN, SE_MOON, SE_MERCURY, SE_VENUS, SE_EARTH, SE_MARS, SE_JUPITER,
+                  SE_SATURN, SE_URANUS, SE_NEPTUNE, SE_PLUTO, SE_TRUE_NODE, SE_CHIRON };
+  const int n = sizeof(ipl) / sizeof(ipl[0]);
+  double xall[6*n], xref[6*n];
+  int32 iflgret[n], rcref[n];
+  char serr_exp[255];
+// Reference: one swe_calc_ut( ) per body, without anything saved before
+  reset_ephemeris( );
+  for (int i=0; i<n; i++) {
+    rcref[i] = swe_calc_ut(jd, ipl[i], iflag | iephe, xref + 6*i, serr);
+    if (rcref[i] == ERR) memset(xref + 6*i, 0, 6*sizeof(double));
+    }
+  reset_ephemeris( );
+  swe_calc_bodies_ut(jd, ipl, n, iflag | iephe, xall, iflgret, serr);
+  check_array_results(xall, xref, n, 6, iflgret, rcref, ctx);
+// Edge case: the JPL file does not exist, so all bodies fall back to the 
+// Swiss Ephemeris or to Moshier. Each body keeps the flags of its fallback,
+// a body that fails (Chiron before 675 AD) has zeros, and serr is the 
+// message of the first body that fails.
+  swe_set_jpl_file("nosuchfile.eph");
+  reset_ephemeris( );
+  *serr_exp = '\0';
+  for (int i=0; i<n; i++) {
+    rcref[i] = swe_calc_ut(jd, ipl[i], iflag | SEFLG_JPLEPH, xref + 6*i, serr);
+    if (rcref[i] == ERR) {
+      memset(xref + 6*i, 0, 6*sizeof(double));
+      if (*serr_exp == '\0') strcpy(serr_exp, serr);
+      }
+    }
+  reset_ephemeris( );
+  swe_calc_bodies_ut(jd, ipl, n, iflag | SEFLG_JPLEPH, xall, iflgret, serr);
+  check_array_results(xall, xref, n, 6, iflgret, rcref, ctx);
+// (the geocentric earth, the heliocentric sun and node need no ephemeris
+// and keep the flags of the call)
+  for (int i=0; i<n; i++) {
+    if (ipl[i] < SE_MOON || ipl[i] > SE_PLUTO) continue;
+    CHECK_EQUALS_I(iflgret[i] != ERR && (iflgret[i] & SEFLG_JPLEPH),0);
+    }
+  CHECK_EQUALS_S(serr,serr_exp);
+  swe_set_jpl_file("de431.eph");
+  }
+
+TESTCASE(8,"swe_calc_pctr_bodies( ) - several bodies from one center") {
+  int32 ipl[] = { SE_SUN, SE_MOON, SE_MERCURY, SE_VENUS, SE_EARTH, SE_MARS, SE_JUPITER,
+                  SE_SATURN, SE_URANUS, SE_NEPTUNE, SE_PLUTO, SE_CHIRON, 9501 };
+  const int n = sizeof(ipl) / sizeof(ipl[0]);
+  int32 iplctr = GET_I(iplctr);
+  double xall[6*n], xref[6*n];
+  int32 iflgret[n], rcref[n];
+  char serr_exp[255];
+// Reference: one swe_calc_pctr( ) per body, without anything saved before
+  reset_ephemeris( );
+  for (int i=0; i<n; i++) {
+    rcref[i] = swe_calc_pctr(jd, ipl[i], iplctr, iflag | iephe, xref + 6*i, serr);
+    if (rcref[i] == ERR) memset(xref + 6*i, 0, 6*sizeof(double));
+    }
+  reset_ephemeris( );
+  swe_calc_pctr_bodies(jd, ipl, n, iplctr, iflag | iephe, xall, iflgret, serr);
+  check_array_results(xall, xref, n, 6, iflgret, rcref, ctx);
+// Edge case: the JPL file does not exist, so the center and the bodies 
+// fall back to the Swiss Ephemeris or to Moshier. The return flags are 
+// those of swe_calc_pctr( ), which returns the flags of the call, the 
+// center itself in the list and bodies without ephemeris fail and have 
+// zeros, and serr is the message of the first body that fails.
+  swe_set_jpl_file("nosuchfile.eph");
+  reset_ephemeris( );
+  *serr_exp = '\0';
+  for (int i=0; i<n; i++) {
+    rcref[i] = swe_calc_pctr(jd, ipl[i], iplctr, iflag | SEFLG_JPLEPH, xref + 6*i, serr);
+    if (rcref[i] == ERR) {
+      memset(xref + 6*i, 0, 6*sizeof(double));
+      if (*serr_exp == '\0') strcpy(serr_exp, serr);
+      }
+    }
+  reset_ephemeris( );
+  swe_calc_pctr_bodies(jd, ipl, n, iplctr, iflag | SEFLG_JPLEPH, xall, iflgret, serr);
+  check_array_results(xall, xref, n, 6, iflgret, rcref, ctx);
+  CHECK_EQUALS_S(serr,serr_exp);
+  swe_set_jpl_file("de431.eph");
+  }
+
+TESTCASE(9,"swe_prefetch( ) - positions after opening the files in advance") {
+  int32 ipl[] = { SE_SUN, SE_MOON, SE_MERCURY, SE_MARS, SE_JUPITER, SE_PLUTO, SE_CHIRON, SE_CERES };
+  const int n = sizeof(ipl) / sizeof(ipl[0]);
+  int32 body_mask = 0;
+  double x[6*n], xref[6*n], dstat[3], tfstart, tfend;
+  int32 rcx[n], rcref[n];
+  int denum;
+  for (int i=0; i<n; i++) body_mask |= 1 << ipl[i];
+// Reference: without prefetch
+  reset_ephemeris( );
+  int32 rcexp = OK;
+  for (int i=0; i<n; i++) {
+    rcref[i] = swe_calc(jd, ipl[i], iflag | iephe, xref + 6*i, serr);
+// Without the ephemeris files, swe_prefetch( ) fails
+    if (rcref[i] == ERR || !(rcref[i] & iephe)) rcexp = ERR;
+    }
+  reset_ephemeris( );
+  swe_get_prefetch_stats(dstat);
+  CHECK_EQUALS_D(dstat[1],0);
+  int32 rc = swe_prefetch(jd - 1000, jd + 1000, body_mask, iephe, serr);
+  CHECK_EQUALS_I(rc,rcexp);
+// The planet, moon and main asteroid files of the range are open and 
+// their segment indices in memory (each range of t.fix lies in one file)
+  swe_get_prefetch_stats(dstat);
+  CHECK_EQUALS_I(dstat[0] >= 3,rc == OK);
+  CHECK_EQUALS_I(dstat[1] > 0 && dstat[2] > 0,rc == OK);
+  for (int ifno=0; ifno<=2; ifno++) {
+    const char *fnam = swe_get_current_file_data(ifno, &tfstart, &tfend, &denum);
+    CHECK_EQUALS_I(fnam != NULL && tfstart <= jd - 1000 && jd + 1000 <= tfend,rc == OK);
+    }
+  for (int i=0; i<n; i++) 
+    rcx[i] = swe_calc(jd, ipl[i], iflag | iephe, x + 6*i, serr);
+  check_array_results(x, xref, n, 6, rcx, rcref, ctx);
+  }
+
+TESTCASE(10,"swe_set_ephe_preload( ) - positions from decoded segments in memory") {
+  int32 ipl[] = { SE_SUN, SE_MOON, SE_MERCURY, SE_MARS, SE_JUPITER, SE_PLUTO, SE_CHIRON, SE_CERES };
+  const int n = sizeof(ipl) / sizeof(ipl[0]);
+  double x[6*n], xref[6*n], dstat[3], dstat2[3];
+  int32 rcx[n], rcref[n], rcexp = OK;
+// Reference: without preload
+  reset_ephemeris( );
+  for (int i=0; i<n; i++) {
+    rcref[i] = swe_calc(jd, ipl[i], iflag | iephe, xref + 6*i, serr);
+// Without the ephemeris files, swe_set_ephe_preload( ) fails
+    if (rcref[i] == ERR || !(rcref[i] & iephe)) rcexp = ERR;
+    }
+  int32 rc = swe_set_ephe_preload(jd - 1000, jd + 1000, serr);
+  CHECK_EQUALS_I(rc,rcexp);
+// The files of the range are open and their segments decoded
+  swe_get_prefetch_stats(dstat);
+  CHECK_EQUALS_I(dstat[0] >= 3,rc == OK);
+  swe_get_ephe_preload_stats(dstat);
+  CHECK_EQUALS_I(dstat[0] > 0 && dstat[1] > 0 && dstat[2] > 0,rc == OK);
+  for (int i=0; i<n; i++) 
+    rcx[i] = swe_calc(jd, ipl[i], iflag | iephe, x + 6*i, serr);
+  check_array_results(x, xref, n, 6, rcx, rcref, ctx);
+// Positions inside the range need no other segments
+  swe_get_ephe_preload_stats(dstat2);
+  CHECK_EQUALS_DD(dstat2,3,dstat);
+  swe_set_ephe_preload(0, 0, serr);
+  swe_get_ephe_preload_stats(dstat);
+  CHECK_EQUALS_D(dstat[0],0);
+  }
+
+// Workload of bench.fix: like test case 2, but the ephemeris files stay open
+TESTCASE(11,"swe_calc_ut( ) - with open ephemeris files") {
+  int ipl = GET_I(ipl); 
+  int rc = swe_calc_ut(jd, ipl, iflag | iephe, xx, serr);
+  check_swecalc_results(rc,xx,serr,ctx);
+  }
+
+TESTCASE(12,"swe_set_calc_cache( ) - size, hits and misses, invalidation") {
+  int32 nentries = GET_I(nentries);
+  int ipl = GET_I(ipl);
+  double x2[6], dstat[4];
+// Positions of a fallback ephemeris are not saved, so the ephemeris
+// available is used
+  iephe = swe_calc(jd, ipl, iflag | iephe, xx, serr) & (SEFLG_JPLEPH|SEFLG_SWIEPH|SEFLG_MOSEPH);
+  swe_set_calc_cache(nentries);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[1],0);
+  CHECK_EQUALS_D(dstat[2],0);
+  int rc = swe_calc(jd, ipl, iflag | iephe, xx, serr);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[0],nentries > 0 ? nentries : 64);
+  CHECK_EQUALS_D(dstat[1],0);
+  CHECK_EQUALS_D(dstat[2],1);
+// Same body and date, also in other coordinates: from the cache
+  int rc2 = swe_calc(jd, ipl, iflag | iephe, x2, serr);
+  CHECK_EQUALS_I(rc2,rc);
+  CHECK_EQUALS_DD(x2,6,xx);
+  swe_calc(jd, ipl, iflag | iephe | SEFLG_EQUATORIAL, x2, serr);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[1],2);
+  CHECK_EQUALS_D(dstat[2],1);
+// Settings that change positions invalidate the cache
+  swe_set_tid_acc(-20);
+  swe_calc(jd, ipl, iflag | iephe, x2, serr);
+  swe_set_tid_acc(SE_TIDAL_AUTOMATIC);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[1],2);
+  CHECK_EQUALS_D(dstat[2],2);
+  swe_set_astro_models("", iflag);
+  swe_calc(jd, ipl, iflag | iephe, x2, serr);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[1],2);
+  CHECK_EQUALS_D(dstat[2],3);
+// With a user defined Delta T, swe_calc_ut( ) computes the position 
+// for jd + dt, which the following swe_calc( ) must find in the cache
+  swe_set_delta_t_userdef(0.01);
+  swe_calc_ut(jd, ipl, iflag | iephe, x2, serr);
+  swe_calc(jd + 0.01, ipl, iflag | iephe, xx, serr);
+  swe_set_delta_t_userdef(SE_DELTAT_AUTOMATIC);
+  CHECK_EQUALS_DD(xx,6,x2);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[1],3);
+  CHECK_EQUALS_D(dstat[2],4);
+// Resizing empties the cache and resets the statistics
+  swe_set_calc_cache(0);
+  swe_calc(jd, ipl, iflag | iephe, x2, serr);
+  swe_get_calc_cache_stats(dstat);
+  CHECK_EQUALS_D(dstat[0],64);
+  CHECK_EQUALS_D(dstat[1],0);
+  CHECK_EQUALS_D(dstat[2],1);
+  }
+
+TESTCASE(13,"swe_set_ast_file_pool( ) - numbered asteroids interleaved with planets") {
+  int32 ast1 = GET_I(ast1), ast2 = GET_I(ast2), ast3 = GET_I(ast3);
+  int32 ipl[] = { ast1, SE_MARS, ast2, SE_MOON, ast3, ast1, SE_CHIRON, ast2, 
+                  ast2, ast3, SE_JUPITER, ast1, SE_SUN, ast3, ast2, ast1 };
+  const int n = sizeof(ipl) / sizeof(ipl[0]);
+  int32 pool_size[] = { GET_I(npool), 1, -1 };
+  double x[6*n], xref[3][6*n];
+  int32 rcx[n], rcref[3][n];
+// Without the files of the asteroids and moons, there is nothing to keep open
+  reset_ephemeris( );
+  if (swe_calc(jd, ast1, iflag | iephe, xx, serr) == ERR
+   || swe_calc(jd, ast2, iflag | iephe, xx, serr) == ERR
+   || swe_calc(jd, ast3, iflag | iephe, xx, serr) == ERR) 
+    return;
+// Reference: without pool, each asteroid file is opened again. Each call
+// has another date, so that the position does not come from the cache
+// and the parked segment is not always the right one.
+  swe_set_ast_file_pool(0);
+  reset_ephemeris( );
+  for (int k=0; k<3; k++) {
+    for (int i=0; i<n; i++)
+      rcref[k][i] = swe_calc(jd + i * 10 + k, ipl[i], iflag | iephe, xref[k] + 6*i, serr);
+    }
+// With the pool size of the fixture, then, without swe_close( ), with 
+// one parked file and with the default. Resizing closes the parked files.
+  reset_ephemeris( );
+  for (int k=0; k<3; k++) {
+    swe_set_ast_file_pool(pool_size[k]);
+    for (int i=0; i<n; i++)
+      rcx[i] = swe_calc(jd + i * 10 + k, ipl[i], iflag | iephe, x + 6*i, serr);
+    check_array_results(x, xref[k], n, 6, rcx, rcref[k], ctx);
+    }
+  }
+
 END_TESTSUITE
@@ -84,6 +84,30 @@ swe_set_ephe_path(NULL);
 
     }
 
+    TESTCASE(5, "Ayanamsa derived from a star, consecutive dates") {
 
+      // The star based ayanamsas are approximated from the
+      // fixed star position, when many dates are close together;
+      // the result must remain that of the star
+      set_sid_mode( );
+
+      double jd = GET_D(jd);
+      double step = GET_D(step);
+      double offset = GET_D(offset);
+      int iephe = GET_I(iephe);
+      int n = GET_I(n);
+      char star[100], s[100], serr[255];
+      double daya[100], daya_star[100], x[6];
+      GET_S(star);
+      if (n > 100) n = 100;
+      for (int i=0; i<n; i++) {
+        swe_get_ayanamsa_ex(jd + i * step, iephe | SEFLG_NONUT, daya + i, serr);
+        strcpy(s, star);
+        swe_fixstar(s, jd + i * step, iephe | SEFLG_NONUT, x, serr);
+        daya_star[i] = swe_degnorm(x[0] - offset);
+      }
+      CHECK_EQUALS_DD(daya, n, daya_star);
+
+    }
 
 END_TESTSUITE
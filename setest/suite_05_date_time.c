@@ -75,7 +75,80 @@ swe_set_ephe_path(NULL);
     CHECK_D(tjd_lmt);
   }
 
+  TESTCASE(7,"swe_utc_to_jd_array( ), swe_jdet_to_utc_array( ), swe_jdut1_to_utc_array( ) ") {
+    enum { NT = 8 };
+    double tjd[NT], tjd_day[NT], dsec_day[NT], tjd_day_ut[NT], dsec_day_ut[NT], dret[2*NT];
+    double ref_day[NT], ref_sec[NT], ref_day_ut[NT], ref_sec_ut[NT], ref_ret[2*NT];
+    int year, month, day, hour, min;
+    double sec;
+    double jd = GET_D(jd), step = GET_D(step);
+    fill_date_series(tjd, NT, jd, step);
+// TT during the leap second at the end of 30 June 2015: 23:59:60.5 UTC,
+// with TT - UTC = 32.184 + 35 s before the leap second
+    tjd[NT-1] = 2457204.5 + (67.184 + 0.5) / 86400;
+    swe_jdet_to_utc_array(tjd, NT, tjd_day, dsec_day);
+    swe_jdut1_to_utc_array(tjd, NT, tjd_day_ut, dsec_day_ut);
+    rc = swe_utc_to_jd_array(tjd_day, dsec_day, NT, dret, serr);
+// Each date must give the same as the functions for one date
+    int rc_exp = OK;
+    for (int i=0; i<NT; i++) {
+      swe_jdet_to_utc(tjd[i], SE_GREG_CAL, &year, &month, &day, &hour, &min, &sec);
+      ref_day[i] = swe_julday(year, month, day, 0, SE_GREG_CAL);
+      ref_sec[i] = hour * 3600.0 + min * 60.0 + sec;
+      if (swe_utc_to_jd(year, month, day, hour, min, sec, SE_GREG_CAL, ref_ret + 2*i, serr) == ERR) {
+        rc_exp = ERR;
+        ref_ret[2*i] = ref_ret[2*i+1] = 0;
+      }
+      swe_jdut1_to_utc(tjd[i], SE_GREG_CAL, &year, &month, &day, &hour, &min, &sec);
+      ref_day_ut[i] = swe_julday(year, month, day, 0, SE_GREG_CAL);
+      ref_sec_ut[i] = hour * 3600.0 + min * 60.0 + sec;
+    }
+    check_array_results(tjd_day, ref_day, NT, 1, NULL, NULL, ctx);
+    check_array_results(dsec_day, ref_sec, NT, 1, NULL, NULL, ctx);
+    check_array_results(dret, ref_ret, NT, 2, NULL, NULL, ctx);
+    check_array_results(tjd_day_ut, ref_day_ut, NT, 1, NULL, NULL, ctx);
+    check_array_results(dsec_day_ut, ref_sec_ut, NT, 1, NULL, NULL, ctx);
+    CHECK_EQUALS_I(rc,rc_exp);
+// Edge case: the leap second is second 60 of 30 June 2015 and gives the
+// date back within 1 ms
+    CHECK_EQUALS_D(tjd_day[NT-1],2457203.5);
+    CHECK_EQUALS_I(dsec_day[NT-1] > 86400 && dsec_day[NT-1] < 86401,1);
+    CHECK_EQUALS_I(fabs(dret[2*(NT-1)] - tjd[NT-1]) * 86400 < 1e-3,1);
+// Second 60 of a day without leap second is an error, as with 
+// swe_utc_to_jd( ), and gives zeros
+    double tday_noleap = 2457202.5, dsec_noleap = 86400.5;
+    rc = swe_utc_to_jd_array(&tday_noleap, &dsec_noleap, 1, dret, serr);
+    rc_exp = swe_utc_to_jd(2015, 6, 29, 23, 59, 60.5, SE_GREG_CAL, ref_ret, serr);
+    CHECK_EQUALS_I(rc,rc_exp);
+    CHECK_EQUALS_I(rc,ERR);
+    CHECK_EQUALS_D(dret[0],0);
+    CHECK_EQUALS_D(dret[1],0);
+  }
 
-
+  TESTCASE(8,"swe_deltat_array( ) ") {
+    enum { NT = 6 };
+    double tjd[NT], deltat[NT], ref[NT];
+    int iephe = GET_I(iephe);
+    double jd = GET_D(jd), step = GET_D(step);
+    fill_date_series(tjd, NT, jd, step);
+    swe_deltat_array(tjd, NT, iephe, deltat, serr);
+// Each date must give the same as swe_deltat_ex()
+    for (int i=0; i<NT; i++) ref[i] = swe_deltat_ex(tjd[i], iephe, serr);
+    check_array_results(deltat, ref, NT, 1, NULL, NULL, ctx);
+// Edge case: a Delta T of swe_set_delta_t_userdef() applies to all dates, 
+// inside and outside the table, as with swe_deltat_ex()
+    swe_set_delta_t_userdef(0.001);
+    swe_deltat_array(tjd, NT, iephe, deltat, serr);
+    for (int i=0; i<NT; i++) {
+      ref[i] = swe_deltat_ex(tjd[i], iephe, serr);
+      CHECK_EQUALS_D(ref[i],0.001);
+    }
+    swe_set_delta_t_userdef(SE_DELTAT_AUTOMATIC);
+    check_array_results(deltat, ref, NT, 1, NULL, NULL, ctx);
+// No dates, nothing written
+    deltat[0] = -1;
+    swe_deltat_array(tjd, 0, iephe, deltat, serr);
+    CHECK_EQUALS_D(deltat[0],-1);
+  }
 
 END_TESTSUITE
@@ -84,5 +84,31 @@ TESTCASE(9,"swe_houses_armc_ex2( ) - Koch and Placidus with cusp speeds") {
   rc = swe_houses_armc_ex2(armc, geolat, eps, ihsy, cusps, ascmc,cusp_speed,ascmc_speed,serr);
   check_swehouses_armc_ex2_results(rc,armc,ihsy,cusps,ascmc,cusp_speed,ascmc_speed,serr,ctx);
   }
+TESTCASE(10,"swe_sidtime_array( ) ") {
+  enum { NT = 200 };
+  double tjd[NT], tsid[NT], ref[NT];
+  double tlim[] = { 2396758.5, 2469807.5 };
+  int nexact;
+  fill_date_series(tjd, NT, jd_ut, GET_D(step));
+  swe_sidtime_array(tjd, NT, tsid);
+// Each date must give swe_sidtime(), up to the interpolation of dense dates
+  for (int i=0; i<NT; i++) ref[i] = swe_sidtime(tjd[i]);
+  check_array_results(tsid, ref, NT, 1, NULL, NULL, ctx);
+// Edge case: near the beginning and the end of the long-term model 
+// (1850 and 2050, SIDT_LTERM_T0/T1), dense dates are not interpolated
+  for (int k=0; k<2; k++) {
+    fill_date_series(tjd, NT, tlim[k] - NT / 2 / 1440.0, 1 / 1440.0);
+    swe_sidtime_array(tjd, NT, tsid);
+    nexact = 0;
+    for (int i=0; i<NT; i++) nexact += (tsid[i] == swe_sidtime(tjd[i]));
+    CHECK_EQUALS_I(nexact,NT);
+  }
+// Sparse dates out of order are not interpolated either
+  for (int i=0; i<NT; i++) tjd[i] = jd_ut + (i * 37 % NT) * 1.3;
+  swe_sidtime_array(tjd, NT, tsid);
+  nexact = 0;
+  for (int i=0; i<NT; i++) nexact += (tsid[i] == swe_sidtime(tjd[i]));
+  CHECK_EQUALS_I(nexact,NT);
+ }
 
 END_TESTSUITE
@@ -59,4 +59,34 @@ TESTCASE(4,"swe_orbit_max_min_true_distance( ) ") {
   CHECK_D(dtrue);
   }
 
+TESTCASE(5,"swe_get_orbital_elements_array( ), swe_orbit_max_min_true_distance_array( ) ") {
+  int ipl[] = { SE_MERCURY, SE_EARTH, SE_MARS, SE_JUPITER, SE_CHIRON };
+  enum { NB = sizeof(ipl) / sizeof(ipl[0]), NT = 3 };
+  double tjd[NT], delem[NB*NT*SE_NORBEL_VALUES], ddist[NB*NT*3], de[50], dd[3];
+  double step = GET_D(step);
+  jd = GET_D(jd);
+  for (int j=0; j<NT; j++) tjd[j] = jd + j * step;
+  int rc_elem = swe_get_orbital_elements_array(tjd, NT, ipl, NB, iflag|iephe, delem, serr);
+  int rc_dist = swe_orbit_max_min_true_distance_array(tjd, NT, ipl, NB, iflag|iephe, ddist, serr);
+// Each body and date must give the same as the functions for one body and date
+  int rc_elem_exp = OK, rc_dist_exp = OK;
+  for (int i=0; i<NB; i++) {
+    for (int j=0; j<NT; j++) {
+      double *elem = delem + (i*NT+j)*SE_NORBEL_VALUES, *dist = ddist + (i*NT+j)*3;
+      if (swe_get_orbital_elements(tjd[j], ipl[i], iflag|iephe, de, serr) == ERR) {
+        rc_elem_exp = ERR;
+        memset(de,0,sizeof(de));
+      }
+      CHECK_EQUALS_DD(elem,SE_NORBEL_VALUES,de);
+      if (swe_orbit_max_min_true_distance(tjd[j], ipl[i], iflag|iephe, dd, dd+1, dd+2, serr) == ERR) {
+        rc_dist_exp = ERR;
+        memset(dd,0,sizeof(dd));
+      }
+      CHECK_EQUALS_DD(dist,3,dd);
+    }
+  }
+  CHECK_EQUALS_I(rc_elem,rc_elem_exp);
+  CHECK_EQUALS_I(rc_dist,rc_dist_exp);
+  }
+
 END_TESTSUITE
@@ -114,4 +114,37 @@ TESTCASE(10,"swe_lun_eclipse_how( ) ") {
   CHECK_DD(xxattr,11);
   }
 
+TESTCASE(11,"swe_pheno_array( ), swe_pheno_ut_array( ) ") {
+  int ipl[] = { SE_SUN, SE_MOON, SE_MERCURY, SE_VENUS, SE_MARS, SE_SATURN, SE_CHIRON };
+  enum { NB = sizeof(ipl) / sizeof(ipl[0]), NT = 3 };
+  double tjd[NT], attr[NB*NT*SE_NPHENO_VALUES], attr_ut[NB*NT*SE_NPHENO_VALUES], dattr[20];
+  int iflag = GET_I(iephe) | GET_I(iflag);
+  double step = GET_D(step);
+  jd = GET_D(jd);
+  for (int j=0; j<NT; j++) tjd[j] = jd + j * step;
+  int rc_ut = swe_pheno_ut_array(tjd, NT, ipl, NB, iflag, attr_ut, serr);
+  rc = swe_pheno_array(tjd, NT, ipl, NB, iflag, attr, serr);
+// The array functions extrapolate the heliocentric position to the time
+// of light emission: precision-xx of the fixture gives the tolerances
+  int rc_exp = OK, rc_ut_exp = OK;
+  for (int i=0; i<NB; i++) {
+    for (int j=0; j<NT; j++) {
+      double *xx = attr + (i*NT+j)*SE_NPHENO_VALUES;
+      if (swe_pheno(tjd[j], ipl[i], iflag, dattr, serr) == ERR) {
+        rc_exp = ERR;
+        memset(dattr,0,sizeof(dattr));
+      }
+      CHECK_EQUALS_DD(xx,SE_NPHENO_VALUES,dattr);
+      xx = attr_ut + (i*NT+j)*SE_NPHENO_VALUES;
+      if (swe_pheno_ut(tjd[j], ipl[i], iflag, dattr, serr) == ERR) {
+        rc_ut_exp = ERR;
+        memset(dattr,0,sizeof(dattr));
+      }
+      CHECK_EQUALS_DD(xx,SE_NPHENO_VALUES,dattr);
+    }
+  }
+  CHECK_EQUALS_I(rc,rc_exp);
+  CHECK_EQUALS_I(rc_ut,rc_ut_exp);
+  }
+
 END_TESTSUITE
@@ -84,4 +84,54 @@ TESTCASE(5,"swe_vis_limit_mag()( ) ") {
   CHECK_DD(xxtret,3);
   }
 
+TESTCASE(6,"swe_azalt_array( ), swe_azalt_rev_array( ) ") {
+  enum { NT = 4, NC = 12 };
+  double geopos[3] = {geolon, geolat, altitude};
+  double tjd[NT], xin[NC*2], xaz[NC*NT*3], xout[NC*NT*2];
+  double ref_az[NC*NT*3], ref_out[NC*NT*2];
+  int calc_flag = GET_I(calc_flag);
+  jd = GET_D(jd);
+  fill_date_series(tjd, NT, jd, GET_D(step));
+// Positions from pole to pole; as azimuth and altitude for the reverse
+  for (int i=0; i<NC; i++) {
+    xin[i*2] = i * 31.7;
+    xin[i*2+1] = -90 + i * 180.0 / (NC - 1);
+  }
+  swe_azalt_array(tjd, NT, calc_flag, geopos, atpress, attemp, xin, NC, xaz);
+  swe_azalt_rev_array(tjd, NT, calc_flag, geopos, xin, NC, xout);
+// Each position must be the same as with swe_azalt( ) and swe_azalt_rev( )
+  for (int i=0; i<NC; i++) {
+    for (int j=0; j<NT; j++) {
+      swe_azalt(tjd[j], calc_flag, geopos, atpress, attemp, xin + i*2, ref_az + (i*NT+j)*3);
+      swe_azalt_rev(tjd[j], calc_flag, geopos, xin + i*2, ref_out + (i*NT+j)*2);
+    }
+  }
+  check_array_results(xaz, ref_az, NC*NT, 3, NULL, NULL, ctx);
+  check_array_results(xout, ref_out, NC*NT, 2, NULL, NULL, ctx);
+// Edge case: the horizon of refraction. Below the dip of the horizon, the
+// apparent altitude is the true one. Positions with true altitudes from 
+// -3 to +0.5 degrees lie on both sides of it at each place of t.fix.
+  enum { NH = 36 };
+  double xhor[NH*2], xequ[NH*2], xazh[NH*3], dret[4];
+  double press = atpress != 0 ? atpress : 1013.25 * pow(1 - 0.0065 * altitude / 288, 5.255);
+  int nrefr = 0, nrefr_exp = 0;
+  for (int i=0; i<NH; i++) {
+    xhor[i*2] = i * 10.0;
+    xhor[i*2+1] = -3 + i * 0.1;
+  }
+  swe_azalt_rev_array(tjd, 1, SE_HOR2EQU, geopos, xhor, NH, xequ);
+  swe_azalt_array(tjd, 1, SE_EQU2HOR, geopos, atpress, attemp, xequ, NH, xazh);
+// Each apparent altitude as with swe_refrac_extended( ), which tells 
+// whether the position is above the horizon; 0.0065 is the default lapse 
+// rate of swe_set_lapse_rate( )
+  for (int i=0; i<NH; i++) {
+    double *xp = xazh + i*3;
+    CHECK_EQUALS_D(xp[2],swe_refrac_extended(xp[1], altitude, press, attemp, 0.0065, SE_TRUE_TO_APP, dret));
+    nrefr_exp += (dret[0] != dret[1]);
+    nrefr += (xp[2] != xp[1]);
+  }
+  CHECK_EQUALS_I(nrefr,nrefr_exp);
+  CHECK_EQUALS_I(nrefr > 0 && nrefr < NH,1);
+  }
+
 END_TESTSUITE
@@ -114,19 +114,19 @@ entry get_required_entry(
 
 double get_d( const char* name, const test_context *ctx) {
   pair p = get_required_entry(name,D,ctx).pair;
-  print_if(!ctx->testmode,&p, ctx->out);
+  print_if(!ctx->testmode && !ctx->benchmode,&p, ctx->out);
   return p.tvalue.value.d;
 }
 
 int get_i( const char* name, const test_context *ctx) {
   pair p = get_required_entry(name,I,ctx).pair;
-  print_if(!ctx->testmode,&p, ctx->out);
+  print_if(!ctx->testmode && !ctx->benchmode,&p, ctx->out);
   return p.tvalue.value.i;
 }
 
 const char* get_s( const char* name, const test_context *ctx) {
   pair p = get_required_entry(name,S,ctx).pair;
-  print_if(!ctx->testmode,&p, ctx->out);
+  print_if(!ctx->testmode && !ctx->benchmode,&p, ctx->out);
   return p.tvalue.value.s;
 }
 
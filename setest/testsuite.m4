@@ -60,8 +60,7 @@ TEST_NUMERIC($1,` Error: testcase id $1 in suite 'SUITE_NO` is not a positive in
       ctx->current.iteration.id++;
       open_iteration( ctx->current.iteration.id, ctx );
       if (is_iteration_selected(ctx)) {
-        ifelse(HAS_SETUP,`1',`setup_`'SUITE_NO`'();')
-        testcase_`'SUITE_NO`'_$1(ctx);
+        run_testcase(ifelse(HAS_SETUP,`1',`setup_`'SUITE_NO',`NULL'), testcase_`'SUITE_NO`'_$1, ctx);
         ifelse(HAS_TEARDOWN,`1',`teardown_`'SUITE_NO`'();')
         close_iteration(ctx);
       }
@@ -71,6 +71,8 @@ static int find_zero(double y00, double y11, double y2, double dx,
 			double *dxret, double *dxret2);
 static double calc_dip(double geoalt, double atpress, double attemp, double lapse_rate);
 static double calc_astronomical_refr(double geoalt,double atpress, double attemp);
+static double refrac_true_to_app(double inalt, double atpress, double attemp, double dip, double *refr);
+static void cotrans_sc(double *xpo, double *xpn, double sine, double cose);
 static TLS double const_lapse_rate = SE_LAPSE_RATE;  /* for refraction */
 
 #if 0
@@ -103,6 +105,13 @@ static int32 calc_mer_trans(
                double *tret,
                char *serr); 
 static int32 calc_planet_star(double tjd_et, int32 ipl, char *starname, int32 iflag, double *x, char *serr);
+static int32 get_orbel_state(double tjd_et, int32 ipl, int32 iflag, double *xpos, double *gmsm, char *serr);
+static void orbel_from_state(double tjd_et, int32 ipl, double *xpos, double Gmsm, double *dret);
+static void orbit_max_min_true_distance_elem(double *dp, double *de, double *dmax, double *dmin, double *dtrue);
+static int32 pheno_ipl(int32 ipl);
+static int32 pheno_iflag(int32 iflag);
+static int32 pheno(double tjd, int32 ipl, int32 iflag, double *xgeo, int32 retgeo, double *xsun, double *xhel, double *attr, char *serr);
+static int32 pheno_array(double *tjd, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, AS_BOOL is_ut, double *attr, char *serr);
 
 struct saros_data {int series_no; double tstart;};
 
@@ -2799,7 +2808,7 @@ void CALL_CONV swe_azalt(
   int i;
   double x[6], xra[3];
   double armc = swe_degnorm(swe_sidtime(tjd_ut) * 15 + geopos[0]);
-  double mdd, eps_true;
+  double eps_true;
   for (i = 0; i < 2; i++)
     xra[i] = xin[i];
   xra[2] = 1;
@@ -2808,9 +2817,18 @@ void CALL_CONV swe_azalt(
     eps_true = x[0];
     swe_cotrans(xra, xra, -eps_true);
   }
-  mdd = swe_degnorm(xra[0] - armc);
+  swi_equ2hor_armc(armc, geopos, atpress, attemp, xra, xaz);
+}
+
+/* equatorial coordinates xin (right ascension and declination of date)
+ * to azimuth, true and apparent altitude, for a given armc (sidereal
+ * time in degrees + geographic longitude); see swe_azalt() */
+void swi_equ2hor_armc(double armc, double *geopos, double atpress, double attemp, double *xin, double *xaz)
+{
+  double x[3], mdd;
+  mdd = swe_degnorm(xin[0] - armc);
   x[0] = swe_degnorm(mdd - 90);
-  x[1] = xra[1];
+  x[1] = xin[1];
   x[2] = 1;
   /* azimuth from east, counterclock */
   swe_cotrans(x, x, 90 - geopos[1]);
@@ -2874,6 +2892,123 @@ void CALL_CONV swe_azalt_rev(
   }
 }
 
+/* swe_cotrans() with the sine and cosine of the angle given */
+static void cotrans_sc(double *xpo, double *xpn, double sine, double cose)
+{
+  double x[3];
+  x[0] = xpo[0] * DEGTORAD;
+  x[1] = xpo[1] * DEGTORAD;
+  x[2] = 1;
+  swi_polcart(x, x);
+  swi_coortrf2(x, x, sine, cose);
+  swi_cartpol(x, x);
+  xpn[0] = x[0] * RADTODEG;
+  xpn[1] = x[1] * RADTODEG;
+}
+
+/* Horizontal coordinates of several positions at several dates, 
+ * as with swe_azalt().
+ * tjd_ut[ntimes]	dates, UT
+ * calc_flag, geopos, atpress, attemp	as with swe_azalt()
+ * xin[ncoord * 2]	positions, ecliptic or equatorial longitude and
+ *                      latitude, depending on calc_flag
+ * xaz			return values, declare as xaz[ncoord * ntimes * 3];
+ *                      azimuth, true and apparent altitude of position i
+ *                      at date tjd_ut[j] are at xaz + (i * ntimes + j) * 3.
+ * Sidereal time and obliquity are computed once per date, the sine and
+ * cosine of the rotations once per date and observer, the pressure and
+ * the dip of the horizon once for all. Then the positions of each date 
+ * are rotated, and the refraction is computed for them in a second 
+ * loop. The arithmetic for each position is that of swe_azalt(), so 
+ * the results are the same.
+ */
+void CALL_CONV swe_azalt_array(double *tjd_ut, int32 ntimes, int32 calc_flag, double *geopos, double atpress, double attemp, double *xin, int32 ncoord, double *xaz)
+{
+  int32 i, j, n3 = ntimes * 3;
+  double x[6], armc, mdd, refr, alt, *xp;
+  double sineps = 0, coseps = 1, sinlat, coslat, dip;
+  double e = (90 - geopos[1]) * DEGTORAD;
+  sinlat = sin(e);
+  coslat = cos(e);
+  if (atpress == 0) {
+    /* estimate atmospheric pressure, as in swi_equ2hor_armc() */
+    atpress = 1013.25 * pow(1 - 0.0065 * geopos[2] / 288, 5.255);
+  } 
+  dip = calc_dip(geopos[2], atpress, attemp, const_lapse_rate);
+  for (j = 0; j < ntimes; j++) {
+    armc = swe_degnorm(swe_sidtime(tjd_ut[j]) * 15 + geopos[0]);
+    if (calc_flag == SE_ECL2HOR) {
+      swe_calc(tjd_ut[j] + swe_deltat_ex(tjd_ut[j], -1, NULL), SE_ECL_NUT, 0, x, NULL);
+      e = -x[0] * DEGTORAD;
+      sineps = sin(e);
+      coseps = cos(e);
+    }
+    for (i = 0, xp = xaz + j * 3; i < ncoord; i++, xp += n3) {
+      x[0] = xin[i * 2];
+      x[1] = xin[i * 2 + 1];
+      if (calc_flag == SE_ECL2HOR) 
+	cotrans_sc(x, x, sineps, coseps);
+      mdd = swe_degnorm(x[0] - armc);
+      x[0] = swe_degnorm(mdd - 90);
+      /* azimuth from east, counterclock */
+      cotrans_sc(x, x, sinlat, coslat);
+      /* azimuth from south to west */
+      x[0] = swe_degnorm(x[0] + 90);
+      xp[0] = 360 - x[0];
+      xp[1] = x[1];		/* true height */
+    }
+    /* apparent height */
+    for (i = 0, xp = xaz + j * 3; i < ncoord; i++, xp += n3) {
+      alt = xp[1];
+      if (alt > 90)
+	alt = 180 - alt;
+      xp[2] = refrac_true_to_app(alt, atpress, attemp, dip, &refr);
+    }
+  }
+}
+
+/* Ecliptic or equatorial coordinates of several horizontal positions
+ * at several dates, as with swe_azalt_rev().
+ * xin[ncoord * 2]	azimuth and true altitude
+ * xout			return values, declare as xout[ncoord * ntimes * 2];
+ *                      the coordinates of position i at date tjd_ut[j] 
+ *                      are at xout + (i * ntimes + j) * 2.
+ * See swe_azalt_array(); the results are the same as with swe_azalt_rev().
+ */
+void CALL_CONV swe_azalt_rev_array(double *tjd_ut, int32 ntimes, int32 calc_flag, double *geopos, double *xin, int32 ncoord, double *xout)
+{
+  int32 i, j, n2 = ntimes * 2;
+  double x[6], armc, *xp;
+  double sineps = 0, coseps = 1, sinlat, coslat;
+  double e = (geopos[1] - 90) * DEGTORAD;
+  sinlat = sin(e);
+  coslat = cos(e);
+  for (j = 0; j < ntimes; j++) {
+    armc = swe_degnorm(swe_sidtime(tjd_ut[j]) * 15 + geopos[0]);
+    if (calc_flag == SE_HOR2ECL) {
+      swe_calc(tjd_ut[j] + swe_deltat_ex(tjd_ut[j], -1, NULL), SE_ECL_NUT, 0, x, NULL);
+      e = x[0] * DEGTORAD;
+      sineps = sin(e);
+      coseps = cos(e);
+    }
+    for (i = 0, xp = xout + j * 2; i < ncoord; i++, xp += n2) {
+      /* azimuth is from south, clockwise. 
+       * we need it from east, counterclock */
+      x[0] = 360 - xin[i * 2];
+      x[0] = swe_degnorm(x[0] - 90);
+      x[1] = xin[i * 2 + 1];
+      /* equatorial positions */
+      cotrans_sc(x, x, sinlat, coslat);
+      x[0] = swe_degnorm(x[0] + armc + 90);
+      /* ecliptic positions */
+      if (calc_flag == SE_HOR2ECL) 
+	cotrans_sc(x, x, sineps, coseps);
+      xp[0] = x[0];
+      xp[1] = x[1];
+    }
+  }
+}
+
 /* swe_refrac()
  * Transforms apparent to true altitude and vice-versa.
  * These formulae do not handle the case when the
@@ -3037,57 +3172,20 @@ void CALL_CONV swe_set_lapse_rate(double lapse_rate)
 double CALL_CONV swe_refrac_extended(double inalt, double geoalt, double atpress, double attemp, double lapse_rate, int32 calc_flag, double *dret)
 {
   double refr;
-  double trualt;
+  double trualt, appalt;
   double dip = calc_dip(geoalt, atpress, attemp, lapse_rate);
-  double D, D0, N, y, yy0;
-  int i;
   /* make sure that inalt <=90 */
   if( (inalt>90) )
     inalt=180-inalt;
   if (calc_flag == SE_TRUE_TO_APP) {
-    if (inalt < -10) {
-      if (dret != NULL) {
-	dret[0]=inalt;
-	dret[1]=inalt;
-	dret[2]=0;
-	dret[3]=dip;
-      }
-      return inalt;
-    }
-    /* by iteration */
-    y = inalt;
-    D = 0.0;
-    yy0 = 0;
-    D0 = D;
-    for(i=0; i<5; i++) {
-      D = calc_astronomical_refr(y,atpress,attemp);
-      N = y - yy0;
-      yy0 = D - D0 - N; /* denominator of derivative */
-      if (N != 0.0 && yy0 != 0.0) /* sic !!! code by Moshier */
-        N = y - N*(inalt + D - y)/yy0; /* Newton iteration with numerically estimated derivative */
-      else /* Can't do it on first pass */
-        N = inalt + D;
-      yy0 = y;
-      D0 = D;
-      y = N;
-    }
-    refr = D;
-    if( (inalt + refr < dip) ) {
-      if (dret != NULL) {
-	dret[0]=inalt;
-	dret[1]=inalt;
-	dret[2]=0;
-	dret[3]=dip;
-      }
-      return inalt;
-    }
+    appalt = refrac_true_to_app(inalt, atpress, attemp, dip, &refr);
     if (dret != NULL) {
       dret[0]=inalt;
-      dret[1]=inalt+refr;
+      dret[1]=appalt;
       dret[2]=refr;
       dret[3]=dip;
     }
-    return inalt+refr;
+    return appalt;
   } else {
     refr = calc_astronomical_refr(inalt,atpress,attemp);
     trualt=inalt-refr;
@@ -3116,6 +3214,41 @@ double CALL_CONV swe_refrac_extended(double inalt, double geoalt, double atpress
   }
 }
 
+/* true to apparent altitude, for swe_refrac_extended() and 
+ * swe_azalt_array(); inalt <= 90, dip as from calc_dip().
+ * Returns the apparent altitude and the refraction in *refr, or
+ * inalt and 0 if the body is not visible above the horizon.
+ */
+static double refrac_true_to_app(double inalt, double atpress, double attemp, double dip, double *refr)
+{
+  double D, D0, N, y, yy0;
+  int i;
+  *refr = 0;
+  if (inalt < -10)
+    return inalt;
+  /* by iteration */
+  y = inalt;
+  D = 0.0;
+  yy0 = 0;
+  D0 = D;
+  for(i=0; i<5; i++) {
+    D = calc_astronomical_refr(y,atpress,attemp);
+    N = y - yy0;
+    yy0 = D - D0 - N; /* denominator of derivative */
+    if (N != 0.0 && yy0 != 0.0) /* sic !!! code by Moshier */
+      N = y - N*(inalt + D - y)/yy0; /* Newton iteration with numerically estimated derivative */
+    else /* Can't do it on first pass */
+      N = inalt + D;
+    yy0 = y;
+    D0 = D;
+    y = N;
+  }
+  if( (inalt + D < dip) )
+    return inalt;
+  *refr = D;
+  return inalt+D;
+}
+
 /* calculate the astronomical refraction
  * input parameters:
  * double inalt        * apparent altitude of object
@@ -3792,31 +3925,58 @@ static const double mag_elem[NMAG_ELEM][4] = {
                 };
 int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char *serr)
 {
-  int i;
-  double xx[6], xx2[6], xxs[6], lbr[6], lbr2[6], dt = 0, dd;
-  double fac;
-  double T, in, om, sinB;
-  double ph1, ph2, me[2];
-  int32 iflagp, epheflag, retflag, epheflag2;
-  char serr2[AS_MAXCH];
-  *serr2 = '\0';
-  iflag &= ~(SEFLG_JPLHOR | SEFLG_JPLHOR_APPROX);
+  ipl = pheno_ipl(ipl);
+  iflag = pheno_iflag(iflag);
+  return pheno(tjd, ipl, iflag, NULL, 0, NULL, NULL, attr, serr);
+}
+
+/* body number as swe_pheno() computes it */
+static int32 pheno_ipl(int32 ipl)
+{
   /* function calls for Pluto with asteroid number 134340
    * are treated as calls for Pluto as main body SE_PLUTO */
   if (ipl == SE_AST_OFFSET + 134340)
     ipl = SE_PLUTO;
-  for (i = 0; i < 20; i++)
-    attr[i] = 0;
   /* Ceres - Vesta must be SE_CERES etc., not 10001 etc. */
   if (ipl > SE_AST_OFFSET && ipl <= SE_AST_OFFSET + 4)
         ipl = ipl - SE_AST_OFFSET - 1 + SE_CERES;
-  iflag = iflag & (SEFLG_EPHMASK | 
+  return ipl;
+}
+
+/* flags that swe_pheno() uses */
+static int32 pheno_iflag(int32 iflag)
+{
+  iflag &= ~(SEFLG_JPLHOR | SEFLG_JPLHOR_APPROX);
+  return iflag & (SEFLG_EPHMASK | 
                    SEFLG_TRUEPOS | 
                    SEFLG_J2000 | 
                    SEFLG_NONUT |
                    SEFLG_NOGDEFL |
                    SEFLG_NOABERR |
                    SEFLG_TOPOCTR);
+}
+
+/* phenomena of body ipl, for swe_pheno() and swe_pheno_array().
+ * ipl and iflag must have passed pheno_ipl() and pheno_iflag().
+ * xgeo, if not NULL, is the geocentric cartesian position of the body,
+ * as swe_calc(tjd, ipl, iflag | SEFLG_XYZ, ...) returns it with the
+ * return flag retgeo; xsun, if not NULL, is the same for the sun. 
+ * xhel, if not NULL, is the heliocentric cartesian position and speed 
+ * of the body at tjd; the position at tjd - light-time is then 
+ * extrapolated from it. Otherwise these positions are computed here.
+ */
+static int32 pheno(double tjd, int32 ipl, int32 iflag, double *xgeo, int32 retgeo, double *xsun, double *xhel, double *attr, char *serr)
+{
+  int i;
+  double xx[6], xx2[6], xxs[6], lbr[6], lbr2[6], dt = 0, dd;
+  double fac;
+  double T, in, om, sinB;
+  double ph1, ph2, me[2];
+  int32 iflagp, epheflag, retflag, epheflag2;
+  char serr2[AS_MAXCH];
+  *serr2 = '\0';
+  for (i = 0; i < 20; i++)
+    attr[i] = 0;
   iflagp = iflag & (SEFLG_EPHMASK | 
                    SEFLG_TRUEPOS | 
                    SEFLG_J2000 | 
@@ -3827,7 +3987,11 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
   /*  
    * geocentric planet
    */
-  if ((retflag = swe_calc(tjd, (int) ipl, iflag | SEFLG_XYZ, xx, serr)) == ERR)
+  if (xgeo != NULL) {
+    for (i = 0; i <= 5; i++)
+      xx[i] = xgeo[i];
+    retflag = retgeo;
+  } else if ((retflag = swe_calc(tjd, (int) ipl, iflag | SEFLG_XYZ, xx, serr)) == ERR)
     /* int cast can be removed when swe_calc() gets int32 ipl definition */
     return ERR;
   // check epheflag and adjust iflag
@@ -3844,7 +4008,10 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
     return ERR;
   /* if moon, we need sun as well, for magnitude */
   if (ipl == SE_MOON) {
-    if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xxs, serr) == ERR)
+    if (xsun != NULL) {
+      for (i = 0; i <= 5; i++)
+        xxs[i] = xsun[i];
+    } else if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xxs, serr) == ERR)
       return ERR;
   }
   if (ipl != SE_SUN && ipl != SE_EARTH &&
@@ -3859,12 +4026,22 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
     /* 
      * heliocentric planet at tjd - dt
      */
-    if (swe_calc(tjd - dt, (int) ipl, iflagp | SEFLG_XYZ, xx2, serr) == ERR)
-    /* int cast can be removed when swe_calc() gets int32 ipl definition */
-      return ERR;
-    if (swe_calc(tjd - dt, (int) ipl, iflagp, lbr2, serr) == ERR)
-    /* int cast can be removed when swe_calc() gets int32 ipl definition */
-      return ERR;
+    if (xhel != NULL) {
+      for (i = 0; i <= 2; i++) {
+	xx2[i] = xhel[i] - dt * xhel[i+3];
+	xx2[i+3] = xhel[i+3];
+      }
+      swi_cartpol(xx2, lbr2);
+      lbr2[0] *= RADTODEG;
+      lbr2[1] *= RADTODEG;
+    } else {
+      if (swe_calc(tjd - dt, (int) ipl, iflagp | SEFLG_XYZ, xx2, serr) == ERR)
+      /* int cast can be removed when swe_calc() gets int32 ipl definition */
+	return ERR;
+      if (swe_calc(tjd - dt, (int) ipl, iflagp, lbr2, serr) == ERR)
+      /* int cast can be removed when swe_calc() gets int32 ipl definition */
+	return ERR;
+    }
     /*
      * phase angle
      */
@@ -4076,10 +4253,15 @@ int32 CALL_CONV swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
     /* 
      * elongation of planet
      */
-    if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xx2, serr) == ERR)
-      return ERR;
-    if (swe_calc(tjd, SE_SUN, iflag, lbr2, serr) == ERR)
-      return ERR;
+    if (xsun != NULL) {
+      for (i = 0; i <= 5; i++)
+        xx2[i] = xsun[i];
+    } else {
+      if (swe_calc(tjd, SE_SUN, iflag | SEFLG_XYZ, xx2, serr) == ERR)
+	return ERR;
+      if (swe_calc(tjd, SE_SUN, iflag, lbr2, serr) == ERR)
+	return ERR;
+    }
     attr[2] = acos(swi_dot_prod_unit(xx, xx2)) * RADTODEG;
   }
   /* horizontal parallax */
@@ -4147,6 +4329,114 @@ int32 CALL_CONV swe_pheno_ut(double tjd_ut, int32 ipl, int32 iflag, double *attr
   return retflag;
 }
 
+/* Phenomena of several bodies at several dates, as with swe_pheno().
+ * tjd_et[ntimes]	dates, TT
+ * ipl[nbodies]		bodies
+ * iflag		as with swe_pheno()
+ * attr			return values, 
+ *                      declare as attr[nbodies * ntimes * SE_NPHENO_VALUES];
+ *                      the values of body ipl[i] at date tjd_et[j] are at
+ *                      attr + (i * ntimes + j) * SE_NPHENO_VALUES, in the
+ *                      order of swe_pheno().
+ * For each date, the geocentric positions of all bodies and of the sun 
+ * and the heliocentric positions of all bodies are computed first, with
+ * two calls of swe_calc_bodies(), and the phenomena are derived from 
+ * them. swe_pheno() computes the heliocentric position of each body at
+ * its own time of light emission, i.e. for a different date with each 
+ * body; here it is extrapolated linearly from the date to the time of
+ * light emission. The phase angle and the phase then differ from 
+ * swe_pheno() by less than 0.00001 degree and the magnitude by less than
+ * 0.00001 mag; elongation and diameter are the same. With SEFLG_TRUEPOS 
+ * there is no light-time, and the differences are rounding errors.
+ * If a body cannot be computed for a date, its values are 0, serr 
+ * contains the first error message, and the function returns ERR after
+ * all other values have been computed.
+ * The function does not start threads. Since the data of the library
+ * are thread-local, a long series can be divided among threads, each
+ * of which must make its own settings (swe_set_ephe_path() etc.).
+ */
+int32 CALL_CONV swe_pheno_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *attr, char *serr)
+{
+  return pheno_array(tjd_et, ntimes, ipl, nbodies, iflag, FALSE, attr, serr);
+}
+
+/* the same for dates in UT, as with swe_pheno_ut() */
+int32 CALL_CONV swe_pheno_ut_array(double *tjd_ut, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *attr, char *serr)
+{
+  return pheno_array(tjd_ut, ntimes, ipl, nbodies, iflag, TRUE, attr, serr);
+}
+
+#define PHENO_NBATCH  32	/* bodies per call of swe_calc_bodies() */
+
+static int32 pheno_array(double *tjd, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, AS_BOOL is_ut, double *attr, char *serr)
+{
+  int32 i, j, k, n, retflag, retval = OK;
+  int32 epheflag, iflagp, iplb[PHENO_NBATCH + 1];
+  int32 iflgret[PHENO_NBATCH + 1], iflgreth[PHENO_NBATCH];
+  double t, xx[(PHENO_NBATCH + 1) * 6], xxh[PHENO_NBATCH * 6];
+  double *xsun, a[20], *ap;
+  char s[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  epheflag = iflag & SEFLG_EPHMASK;
+  if (is_ut && epheflag == 0) {
+    epheflag = SEFLG_SWIEPH;
+    iflag |= SEFLG_SWIEPH;
+  }
+  iflag = pheno_iflag(iflag);
+  /* as in pheno() */
+  iflagp = iflag & (SEFLG_EPHMASK | 
+                   SEFLG_TRUEPOS | 
+                   SEFLG_J2000 | 
+                   SEFLG_NONUT |
+                   SEFLG_NOABERR);
+  iflagp |= SEFLG_HELCTR;                
+  for (j = 0; j < ntimes; j++) {
+    t = tjd[j];
+    if (is_ut)
+      t += swe_deltat_ex(tjd[j], iflag, NULL);
+    for (k = 0; k < nbodies; k += PHENO_NBATCH) {
+      n = nbodies - k;
+      if (n > PHENO_NBATCH)
+	n = PHENO_NBATCH;
+      for (i = 0; i < n; i++)
+	iplb[i] = pheno_ipl(ipl[k + i]);
+      /* the sun is needed for the elongation */
+      iplb[n] = SE_SUN;
+      swe_calc_bodies(t, iplb, n + 1, iflag | SEFLG_XYZ, xx, iflgret, NULL);
+      swe_calc_bodies(t, iplb, n, iflagp | SEFLG_XYZ | SEFLG_SPEED, xxh, iflgreth, NULL);
+      for (i = 0; i < n; i++) {
+	ap = attr + ((size_t) (k + i) * ntimes + j) * SE_NPHENO_VALUES;
+	*s = '\0';
+	if (iflgret[i] == ERR || iflgreth[i] == ERR
+	  || (iflgret[i] & SEFLG_EPHMASK) != (iflag & SEFLG_EPHMASK)
+	  || (iflgreth[i] & SEFLG_EPHMASK) != (iflag & SEFLG_EPHMASK)) {
+	  /* error message, or other ephemeris (and delta t) */
+	  if (is_ut)
+	    retflag = swe_pheno_ut(tjd[j], ipl[k + i], iflag, a, s);
+	  else
+	    retflag = pheno(t, iplb[i], iflag, NULL, 0, NULL, NULL, a, s);
+	} else {
+	  xsun = NULL;
+	  if (iflgret[n] != ERR 
+	    && (iflgret[n] & SEFLG_EPHMASK) == (iflag & SEFLG_EPHMASK))
+	    xsun = xx + 6 * n;
+	  retflag = pheno(t, iplb[i], iflag, xx + 6 * i, iflgret[i], xsun, xxh + 6 * i, a, s);
+	}
+	if (retflag == ERR) {
+	  memset((void *) ap, 0, SE_NPHENO_VALUES * sizeof(double));
+	  if (retval == OK && serr != NULL)
+	    strcpy(serr, s);
+	  retval = ERR;
+	  continue;
+	}
+	memcpy((void *) ap, (void *) a, SE_NPHENO_VALUES * sizeof(double));
+      }
+    }
+  }
+  return retval;
+}
+
 static int find_maximum(double y00, double y11, double y2, double dx, 
                         double *dxret, double *yret)
 {
@@ -5072,6 +5362,116 @@ static const double plmass[9] = {
   136566000,        /* Pluto */
 };
 static const int ipl_to_elem[15] = {2, 0, 0, 1, 3, 4, 5, 6, 7, 0, 0, 0, 0, 0, 2,};
+
+/* Osculating Kepler orbit of a body, derived from its position and speed
+ * (cartesian, relative to the central body) by osc_orbit_from_state().
+ * The osculating nodes and apsides of swe_nod_aps(), the elements of 
+ * swe_get_orbital_elements() and the distances of 
+ * swe_orbit_max_min_true_distance() are all derived from it. */
+struct osc_orbit {
+  double sema, ecce;
+  double sinincl, cosincl;
+  double sinnode, cosnode;
+  double uu;		/* argument of latitude, radians */
+  double ny;		/* true anomaly, radians */
+  double sinE, cosE;	/* eccentric anomaly */
+  double xq[3];		/* perihelion, cartesian */
+  double xa[3];		/* aphelion, or empty focal point */
+  double xn[3];		/* ascending node, on the ellipse */
+  double xs[3];		/* descending node, on the ellipse */
+};
+
+static void osc_orbit_from_state(double *xpos, double Gmsm, AS_BOOL do_focal_point, AS_BOOL limit_ecce, struct osc_orbit *op)
+{
+  int j;
+  double fac, sgn, rxy, rxyz, c2, xnorm[3];
+  double cosu, sinu, v2, pp, sema, ecce, ecce2;
+  double ny, ny2, cosE, cosE2, rn, rn2, ro, ro2;
+  double *xq = op->xq, *xa = op->xa, *xn = op->xn, *xs = op->xs;
+  fac = xpos[2] / xpos[5];
+  sgn = xpos[5] / fabs(xpos[5]);
+  for (j = 0; j <= 2; j++) {
+    xn[j] = (xpos[j] - fac * xpos[j+3]) * sgn;
+    xs[j] = -xn[j];
+  }
+  /* node */
+  rxy =  sqrt(xn[0] * xn[0] + xn[1] * xn[1]);
+  op->cosnode = xn[0] / rxy;	
+  op->sinnode = xn[1] / rxy;
+  /* inclination */
+  swi_cross_prod(xpos, xpos+3, xnorm);
+  rxy =  xnorm[0] * xnorm[0] + xnorm[1] * xnorm[1];
+  c2 = (rxy + xnorm[2] * xnorm[2]);
+  rxyz = sqrt(c2);
+  rxy = sqrt(rxy);
+  op->sinincl = rxy / rxyz;
+  op->cosincl = sqrt(1 - op->sinincl * op->sinincl);
+  if (xnorm[2] < 0) op->cosincl = -op->cosincl; /* retrograde asteroid, e.g. 20461 Dioretsa */
+  /* argument of latitude */
+  cosu = xpos[0] * op->cosnode + xpos[1] * op->sinnode;
+  sinu = xpos[2] / op->sinincl;	
+  op->uu = atan2(sinu, cosu);	
+  /* semi-axis */
+  rxyz = sqrt(square_sum(xpos));
+  v2 = square_sum((xpos+3));
+  sema = 1.0 / (2.0 / rxyz - v2 / Gmsm);	
+  /* eccentricity */
+  pp = c2 / Gmsm;
+  ecce = pp / sema;
+  /* swe_get_orbital_elements() limits the eccentricity to 0 <= e <= 1
+   * and avoids the division by 0, swe_nod_aps() does not */
+  if (limit_ecce && ecce > 1)
+    ecce = 1;
+  ecce = sqrt(1 - ecce);	
+  /* eccentric anomaly */
+  ecce2 = ecce;
+  if (limit_ecce && ecce2 == 0)
+    ecce2 = 0.0000000001;
+  op->cosE = 1 / ecce2 * (1 - rxyz / sema);	
+  op->sinE = 1 / ecce2 / sqrt(sema * Gmsm) * dot_prod(xpos, (xpos+3));
+  /* true anomaly */
+  ny = op->ny = 2 * atan(sqrt((1+ecce)/(1-ecce)) * op->sinE / (1 + op->cosE));
+  /* distance of perihelion from ascending node */
+  xq[0] = swi_mod2PI(op->uu - ny);
+  xq[1] = 0;			/* latitude */
+  xq[2] = sema * (1 - ecce);	/* distance of perihelion */
+  /* transformation to ecliptic coordinates */
+  swi_polcart(xq, xq);
+  swi_coortrf2(xq, xq, -op->sinincl, op->cosincl);
+  swi_cartpol(xq, xq);
+  /* adding node, we get perihelion in ecl. coord. */
+  xq[0] += atan2(op->sinnode, op->cosnode);
+  xa[0] = swi_mod2PI(xq[0] + PI);
+  xa[1] = -xq[1];
+  if (do_focal_point) {
+    xa[2] = sema * ecce * 2;	/* distance of aphelion */
+  } else {
+    xa[2] = sema * (1 + ecce);	/* distance of aphelion */
+  }
+  swi_polcart(xq, xq);
+  swi_polcart(xa, xa);
+  /* new distance of node from orbital ellipse:
+   * true anomaly of node: */
+  ny = swi_mod2PI(ny - op->uu);
+  ny2 = swi_mod2PI(ny + PI);
+  /* eccentric anomaly */
+  cosE = cos(2 * atan(tan(ny / 2) / sqrt((1+ecce) / (1-ecce))));
+  cosE2 = cos(2 * atan(tan(ny2 / 2) / sqrt((1+ecce) / (1-ecce))));
+  /* new distance */
+  rn = sema * (1 - ecce * cosE);
+  rn2 = sema * (1 - ecce * cosE2);
+  /* old node distance */
+  ro = sqrt(square_sum(xn));
+  ro2 = sqrt(square_sum(xs));
+  /* correct length of position vector */
+  for (j = 0; j <= 2; j++) {
+    xn[j] *= rn / ro;
+    xs[j] *= rn2 / ro2;
+  }
+  op->sema = sema;
+  op->ecce = ecce;
+}
+
 int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag, 
                       int32  method,
                       double *xnasc, double *xndsc, 
@@ -5086,13 +5486,14 @@ int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag,
   double daya, plm;
   double t = (tjd_et - J2000) / 36525, dt;
   double x[6], xx[24], *xp, xobs[6], x2000[6]; 
-  double xpos[3][6], xnorm[6];
+  double xpos[3][6];
   double xposm[6];
   double xn[3][6], xs[3][6];
   double xq[3][6], xa[3][6];
   double xobs2[6], x2[6];
   double *xna, *xnd, *xpe, *xap;
   double incl, sema, ecce, parg, ea, vincl, vsema, vecce, pargx, eax;
+  struct osc_orbit orb;
   struct plan_data *pedp = &swed.pldat[SEI_EARTH];
   struct plan_data *psbdp = &swed.pldat[SEI_SUNBARY];
   struct plan_data pldat;
@@ -5100,9 +5501,6 @@ int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag,
   double *xear = pedp->x;
   const double *ep;
   double Gmsm, dzmin;
-  double rxy, rxyz, fac, sgn;
-  double sinnode, cosnode, sinincl, cosincl, sinu, cosu, sinE, cosE, cosE2;
-  double uu, ny, ny2, c2, v2, pp, ro, ro2, rn, rn2;
   struct epsilon *oe;
   AS_BOOL is_true_nodaps = FALSE;
   AS_BOOL do_aberr = !(iflag & (SEFLG_TRUEPOS | SEFLG_NOABERR));
@@ -5300,79 +5698,12 @@ int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag,
     for (i = istart; i <= iend; i++) {
       if (fabs(xpos[i][5]) < dzmin)
         xpos[i][5] = dzmin;
-      fac = xpos[i][2] / xpos[i][5];
-      sgn = xpos[i][5] / fabs(xpos[i][5]);
-      for (j = 0; j <= 2; j++) {
-        xn[i][j] = (xpos[i][j] - fac * xpos[i][j+3]) * sgn;
-        xs[i][j] = -xn[i][j];
-      }
-    }
-    for (i = istart; i <= iend; i++) {
-      /* node */
-      rxy =  sqrt(xn[i][0] * xn[i][0] + xn[i][1] * xn[i][1]);
-      cosnode = xn[i][0] / rxy;	
-      sinnode = xn[i][1] / rxy;
-      /* inclination */
-      swi_cross_prod(xpos[i], xpos[i]+3, xnorm);
-      rxy =  xnorm[0] * xnorm[0] + xnorm[1] * xnorm[1];
-      c2 = (rxy + xnorm[2] * xnorm[2]);
-      rxyz = sqrt(c2);
-      rxy = sqrt(rxy);
-      sinincl = rxy / rxyz;
-      cosincl = sqrt(1 - sinincl * sinincl);
-      if (xnorm[2] < 0) cosincl = -cosincl; /* retrograde asteroid, e.g. 20461 Dioretsa */
-      /* argument of latitude */
-      cosu = xpos[i][0] * cosnode + xpos[i][1] * sinnode;
-      sinu = xpos[i][2] / sinincl;	
-      uu = atan2(sinu, cosu);	
-      /* semi-axis */
-      rxyz = sqrt(square_sum(xpos[i]));
-      v2 = square_sum((xpos[i]+3));
-      sema = 1 / (2 / rxyz - v2 / Gmsm);	
-      /* eccentricity */
-      pp = c2 / Gmsm;
-      ecce = sqrt(1 - pp / sema);	
-      /* eccentric anomaly */
-      cosE = 1 / ecce * (1 - rxyz / sema);	
-      sinE = 1 / ecce / sqrt(sema * Gmsm) * dot_prod(xpos[i], (xpos[i]+3));
-      /* true anomaly */
-      ny = 2 * atan(sqrt((1+ecce)/(1-ecce)) * sinE / (1 + cosE));
-      /* distance of perihelion from ascending node */
-      xq[i][0] = swi_mod2PI(uu - ny);
-      xq[i][1] = 0;			/* latitude */
-      xq[i][2] = sema * (1 - ecce);	/* distance of perihelion */
-      /* transformation to ecliptic coordinates */
-      swi_polcart(xq[i], xq[i]);
-      swi_coortrf2(xq[i], xq[i], -sinincl, cosincl);
-      swi_cartpol(xq[i], xq[i]);
-      /* adding node, we get perihelion in ecl. coord. */
-      xq[i][0] += atan2(sinnode, cosnode);
-      xa[i][0] = swi_mod2PI(xq[i][0] + PI);
-      xa[i][1] = -xq[i][1];
-      if (do_focal_point) {
-        xa[i][2] = sema * ecce * 2;	/* distance of aphelion */
-      } else {
-        xa[i][2] = sema * (1 + ecce);	/* distance of aphelion */
-      }
-      swi_polcart(xq[i], xq[i]);
-      swi_polcart(xa[i], xa[i]);
-      /* new distance of node from orbital ellipse:
-       * true anomaly of node: */
-      ny = swi_mod2PI(ny - uu);
-      ny2 = swi_mod2PI(ny + PI);
-      /* eccentric anomaly */
-      cosE = cos(2 * atan(tan(ny / 2) / sqrt((1+ecce) / (1-ecce))));
-      cosE2 = cos(2 * atan(tan(ny2 / 2) / sqrt((1+ecce) / (1-ecce))));
-      /* new distance */
-      rn = sema * (1 - ecce * cosE);
-      rn2 = sema * (1 - ecce * cosE2);
-      /* old node distance */
-      ro = sqrt(square_sum(xn[i]));
-      ro2 = sqrt(square_sum(xs[i]));
-      /* correct length of position vector */
+      osc_orbit_from_state(xpos[i], Gmsm, do_focal_point, FALSE, &orb);
       for (j = 0; j <= 2; j++) {
-        xn[i][j] *= rn / ro;
-        xs[i][j] *= rn2 / ro2;
+        xq[i][j] = orb.xq[j];
+        xa[i][j] = orb.xa[j];
+        xn[i][j] = orb.xn[j];
+        xs[i][j] = orb.xs[j];
       }
     }
     for (i = 0; i <= 2; i++) {
@@ -5400,9 +5731,10 @@ int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag,
   }
   /* to set the variables required in the save area,
    * i.e. ecliptic, nutation, barycentric sun, earth
-   * we compute the planet */
+   * we compute the planet; it must not be taken from the 
+   * position cache of swe_calc() */
+  swi_force_app_pos_etc();
   if (ipli == SE_MOON && (iflag & (SEFLG_HELCTR | SEFLG_BARYCTR))) {
-    swi_force_app_pos_etc();
     if (swe_calc(tjd_et, SE_SUN, iflg0, x, serr) == ERR)
       return ERR;
   } else {
@@ -5511,6 +5843,7 @@ int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag,
        */
       if (iflag & SEFLG_SPEED) {
         /* get barycentric sun and earth for t-dt into save area */
+        swi_force_app_pos_etc();
         if (swe_calc(tjd_et - dt, ipli, iflg0 | (iflag & SEFLG_TOPOCTR), x2, serr) == ERR)
           return ERR;
         if (iflag & SEFLG_TOPOCTR) {
@@ -5542,6 +5875,7 @@ int32 CALL_CONV swe_nod_aps(double tjd_et, int32 ipl, int32 iflag,
          * (i.e. bary sun, earth nutation matrix!). 
          * to restore it:
          */
+        swi_force_app_pos_etc();
         if (swe_calc(tjd_et, SE_SUN, iflg0 | (iflag & SEFLG_TOPOCTR), x2, serr) == ERR)
           return ERR;
       }
@@ -5786,28 +6120,34 @@ int32 CALL_CONV swe_get_orbital_elements(
   double *dret,
   char *serr) 
 {
-  int j;
-  double x[6], xpos[6], xposm[6], xn[6], xs[6], xnorm[6], xq[6], xa[6] ;
-  //int32 iflJ2000 = (iflag & SEFLG_EPHMASK)|SEFLG_J2000|SEFLG_EQUATORIAL|SEFLG_XYZ|SEFLG_TRUEPOS|SEFLG_NONUT|SEFLG_SPEED;
-  int32 iflJ2000 = (iflag & SEFLG_EPHMASK)|SEFLG_J2000|SEFLG_XYZ|SEFLG_TRUEPOS|SEFLG_NONUT|SEFLG_SPEED;
-  int32 iflJ2000p = (iflag & SEFLG_EPHMASK)|SEFLG_J2000|SEFLG_TRUEPOS|SEFLG_NONUT|SEFLG_SPEED;
-  double Gmsm;
-  int32 iflg0 = 0;
-  double fac, sgn, rxy, rxyz, c2, cosnode, sinnode;
-  double incl, node, parg, peri, mlon;
-  double csid, ctro, csyn, dmot, pa;
-  double ytrop, ysid, T, T2, T3, T4, T5;
-  double sinincl, cosincl, cosu, sinu, uu, eanom, tanom, manom;
-  double v2, sema, pp, ecce, cosE, sinE, ny, ny2, rn, rn2, ro, ro2, cosE2;
-  double r, ecce2;
+  double xpos[6], Gmsm;
   if (ipl <= 0 || ipl == SE_MEAN_NODE || ipl == SE_TRUE_NODE || ipl == SE_MEAN_APOG || ipl == SE_OSCU_APOG || ipl == SE_INTP_APOG || ipl == SE_INTP_PERG) {
     if (serr != NULL)
       sprintf(serr, "error in swe_get_orbital_elements(): object %d not valid\n", ipl);
     return ERR;
   }
-  if (ipl != SE_MOON)
-    iflg0 |= SEFLG_HELCTR;
-  /* first, we need a heliocentric distance of the planet */
+  if (get_orbel_state(tjd_et, ipl, iflag, xpos, &Gmsm, serr) == ERR)
+    return ERR;
+  orbel_from_state(tjd_et, ipl, xpos, Gmsm, dret);
+  return OK;
+}
+
+/* Position and speed of a body from which its osculating elements are
+ * derived: cartesian, ecliptic J2000, heliocentric or (with SEFLG_BARYCTR,
+ * beyond Jupiter) barycentric; for the Earth, the EMB is used; the Moon 
+ * is geocentric. 
+ * gmsm returns the gravitational constant of the two-body problem. */
+static int32 get_orbel_state(double tjd_et, int32 ipl, int32 iflag, double *xpos, double *gmsm, char *serr)
+{
+  int j;
+  double x[6], xposm[6], r;
+  int32 iflJ2000 = (iflag & SEFLG_EPHMASK)|SEFLG_J2000|SEFLG_XYZ|SEFLG_TRUEPOS|SEFLG_NONUT|SEFLG_SPEED;
+  int32 iflJ2000p = (iflag & SEFLG_EPHMASK)|SEFLG_J2000|SEFLG_TRUEPOS|SEFLG_NONUT|SEFLG_SPEED;
+  /* first, we need a heliocentric distance of the planet, for the 
+   * choice of the centre and for the masses of SEFLG_ORBEL_AA. 
+   * The call is also made without these flags: serr, e.g. the message
+   * of an ephemeris fallback, depends on the sequence of calls; the 
+   * next call finds the position in the save area. */
   if (swe_calc(tjd_et, ipl, iflJ2000p, x, serr) == ERR)
     return ERR;
   r =  x[2];
@@ -5818,7 +6158,7 @@ int32 CALL_CONV swe_get_orbital_elements(
       iflJ2000 |= SEFLG_HELCTR;
     }
   }
-  if (get_gmsm(tjd_et, ipl, iflag, r, &Gmsm, serr))
+  if (get_gmsm(tjd_et, ipl, iflag, r, gmsm, serr))
     return ERR;
   if (swe_calc(tjd_et, ipl, iflJ2000, xpos, serr) == ERR)
     return ERR;
@@ -5829,98 +6169,35 @@ int32 CALL_CONV swe_get_orbital_elements(
     for (j = 0; j <= 5; j++)
       xpos[j] += xposm[j] / (EARTH_MOON_MRAT + 1.0);
   }
-  fac = xpos[2] / xpos[5];
-  sgn = xpos[5] / fabs(xpos[5]);
-  for (j = 0; j <= 2; j++) {
-    xn[j] = (xpos[j] - fac * xpos[j+3]) * sgn;
-    xs[j] = -xn[j];
-  }
-  /* node */
-  rxy =  sqrt(xn[0] * xn[0] + xn[1] * xn[1]);
-  cosnode = xn[0] / rxy;	
-  sinnode = xn[1] / rxy;
-  /* inclination */
-  swi_cross_prod(xpos, xpos+3, xnorm);
-  rxy =  xnorm[0] * xnorm[0] + xnorm[1] * xnorm[1];
-  c2 = (rxy + xnorm[2] * xnorm[2]);
-  rxyz = sqrt(c2);
-  rxy = sqrt(rxy);
-  sinincl = rxy / rxyz;
-  cosincl = sqrt(1 - sinincl * sinincl);
-  if (xnorm[2] < 0) cosincl = -cosincl; /* retrograde asteroid, e.g. 20461 Dioretsa */
-  incl = acos(cosincl) * RADTODEG; // inclination
-  /* argument of latitude */
-  cosu = xpos[0] * cosnode + xpos[1] * sinnode;
-  sinu = xpos[2] / sinincl;	
-  uu = atan2(sinu, cosu);	
-  /* semi-axis */
-  rxyz = sqrt(square_sum(xpos));
-  v2 = square_sum((xpos+3));
-  sema = 1.0 / (2.0 / rxyz - v2 / Gmsm);	
-  /* eccentricity */
-  pp = c2 / Gmsm;
-  ecce = pp / sema;
-  if (ecce > 1)
-    ecce = 1;
-  ecce = sqrt(1 - ecce);	
-  /* eccentric anomaly */
-  ecce2 = ecce;
-  if (ecce2 == 0)
-    ecce2 = 0.0000000001;
-  cosE = 1 / ecce2 * (1 - rxyz / sema);	
-  sinE = 1 / ecce2 / sqrt(sema * Gmsm) * dot_prod(xpos, (xpos+3));
-  eanom = swe_degnorm(atan2(sinE, cosE) * RADTODEG); 
-//  eanom = acos((1 - rxyz / sema) / ecce2);
+  return OK;
+}
+
+/* orbital elements dret[0..SE_NORBEL_VALUES-1] from position and speed, 
+ * see swe_get_orbital_elements() */
+static void orbel_from_state(double tjd_et, int32 ipl, double *xpos, double Gmsm, double *dret)
+{
+  double xn[3];
+  double incl, node, parg, peri, mlon;
+  double csid, ctro, csyn, dmot, pa;
+  double ytrop, ysid, T, T2, T3, T4, T5;
+  double sema, ecce, eanom, tanom, manom;
+  struct osc_orbit orb;
+  osc_orbit_from_state(xpos, Gmsm, FALSE, TRUE, &orb);
+  sema = orb.sema;
+  ecce = orb.ecce;
+  incl = acos(orb.cosincl) * RADTODEG; // inclination
+  eanom = swe_degnorm(atan2(orb.sinE, orb.cosE) * RADTODEG); 
   /* true anomaly */
-  ny = 2 * atan(sqrt((1+ecce)/(1-ecce)) * sinE / (1 + cosE));
-  tanom = swe_degnorm(ny * RADTODEG);
+  tanom = swe_degnorm(orb.ny * RADTODEG);
   if (eanom > 180 && tanom < 180) 
     tanom += 180;
   if (eanom < 180 && tanom > 180) 
     tanom -= 180;
-//  tanom = acos((sema * (1 - ecce * ecce) / rxyz - 1.0) / ecce2);
   /* mean anomaly */
   manom = swe_degnorm(eanom - ecce * RADTODEG * sin(eanom * DEGTORAD)); // mean anomaly
   /* distance of perihelion from ascending node */
-  xq[0] = swi_mod2PI(uu - ny);
-  parg = xq[0] * RADTODEG;
-  xq[1] = 0;			/* latitude */
-  xq[2] = sema * (1 - ecce);	/* distance of perihelion */
-  /* transformation to ecliptic coordinates */
-  swi_polcart(xq, xq);
-  swi_coortrf2(xq, xq, -sinincl, cosincl);
-  swi_cartpol(xq, xq);
-  /* adding node, we get perihelion in ecl. coord. */
-  xq[0] += atan2(sinnode, cosnode);
-  xa[0] = swi_mod2PI(xq[0] + PI);
-  xa[1] = -xq[1];
-//  if (do_focal_point) {
-//    xa[2] = sema * ecce * 2;	/* distance of aphelion */
-//  } else {
-    xa[2] = sema * (1 + ecce);	/* distance of aphelion */
-//  }
-  swi_polcart(xq, xq);
-  swi_polcart(xa, xa);
-  /* new distance of node from orbital ellipse:
-   * true anomaly of node: */
-  ny = swi_mod2PI(ny - uu);
-  ny2 = swi_mod2PI(ny + PI);
-  /* eccentric anomaly */
-  cosE = cos(2 * atan(tan(ny / 2) / sqrt((1+ecce) / (1-ecce))));
-  cosE2 = cos(2 * atan(tan(ny2 / 2) / sqrt((1+ecce) / (1-ecce))));
-  /* new distance */
-  rn = sema * (1 - ecce * cosE);
-  rn2 = sema * (1 - ecce * cosE2);
-  /* old node distance */
-  ro = sqrt(square_sum(xn));
-  ro2 = sqrt(square_sum(xs));
-  /* correct length of position vector */
-  for (j = 0; j <= 2; j++) {
-    xn[j] *= rn / ro;
-    xs[j] *= rn2 / ro2;
-  }
-  swi_cartpol(xn, xn);
-  swi_cartpol(xq, xq);
+  parg = swi_mod2PI(orb.uu - orb.ny) * RADTODEG;
+  swi_cartpol(orb.xn, xn);
   node = xn[0] * RADTODEG;
   peri = swe_degnorm(node + parg);
   mlon = swe_degnorm(manom + peri);
@@ -5964,13 +6241,11 @@ int32 CALL_CONV swe_get_orbital_elements(
   dret[14] = tjd_et - dret[6] / dmot; /* tjd_et of perihelion passage */
   dret[15] = sema * (1 - ecce); /* perihelion distance */
   dret[16] = sema * (1 + ecce); /* aphelion distance */
-//  printf("%d: a=%f, e=%f, in=%f, node=%f, parg=%f, peri=%f\n", ipl, sema, ecce, dret[2], dret[3], dret[4], dret[5]);
-//  printf("tan=%f, ean=%f, man=%f, mlon=%f\n", dret[7], dret[8], dret[6], dret[9]);
-//  printf("cyc=%f, dmot=%f, cyct=%f, cycs=%f\n", dret[10], dret[11], dret[12], dret[13]);
-//  printf("tperi=%f, rperi=%f, raph=%f\n", dret[14], dret[15], dret[16]);
-  return OK;
 }
 
+/* number of steps of the rough search in swe_orbit_max_min_true_distance() */
+#define OSC_NGRID	182
+
 static void osc_get_orbit_constants(double *dp, double *pqr)
 {
   double sema = dp[0];
@@ -6170,17 +6445,9 @@ static int32 orbit_max_min_true_distance_helio(double tjd_et, int ipl, int32 ifl
  */
 int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32 iflag, double *dmax, double *dmin, double *dtrue, char *serr)
 {
-  int i, j, k, retval;
+  int32 retval;
   int32 iflagi = (iflag & (SEFLG_EPHMASK | SEFLG_HELCTR | SEFLG_BARYCTR));
   double dp[50], de[50];
-  double xouter[3], xinner[3], max_xouter[3], max_xinner[3], min_xouter[3], min_xinner[3], pqro[20], pqri[20];
-  double eano, eani;
-  double *douter, *dinner;
-  double r, rtrue, rmax = 0, rmin = 100000000, rminsv = 0, rmaxsv = 0;
-  double min_eanisv = 0, min_eanosv = 0, max_eanisv = 0, max_eanosv = 0;
-  int ncnt;
-  double dstep;
-  double nitermax = 300;
   /* separate handling for the Sun, Moon and heliocentric calculation */
   if (ipl == SE_SUN || ipl == SE_MOON || (iflagi & (SEFLG_HELCTR | SEFLG_BARYCTR))) {
     retval = orbit_max_min_true_distance_helio(tjd_et, ipl, iflagi, dmax, dmin, dtrue, serr);
@@ -6190,6 +6457,117 @@ int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
     return ERR;
   if ((retval = swe_get_orbital_elements(tjd_et, SE_EARTH, iflagi, de, serr)) == ERR)
     return ERR;
+  orbit_max_min_true_distance_elem(dp, de, dmax, dmin, dtrue);
+  return retval;
+}
+
+/* Orbital elements of several bodies at several dates.
+ * tjd_et[ntimes]	dates, TT
+ * ipl[nbodies]		bodies
+ * iflag		as with swe_get_orbital_elements()
+ * dret			return values, 
+ *                      declare as dret[nbodies * ntimes * SE_NORBEL_VALUES];
+ *                      the elements of body ipl[i] at date tjd_et[j] are
+ *                      at dret + (i * ntimes + j) * SE_NORBEL_VALUES, in the
+ *                      order of swe_get_orbital_elements().
+ * The bodies are computed one after the other, each for all dates, so that
+ * the ephemeris data of a body are read only once. If a body cannot be 
+ * computed for a date, its values are 0, serr contains the first error 
+ * message, and the function returns ERR after all other values have been 
+ * computed.
+ */
+int32 CALL_CONV swe_get_orbital_elements_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *dret, char *serr)
+{
+  int32 i, j, retval = OK;
+  double de[50], *dp;
+  char s[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  for (i = 0; i < nbodies; i++) {
+    for (j = 0; j < ntimes; j++) {
+      dp = dret + ((size_t) i * ntimes + j) * SE_NORBEL_VALUES;
+      *s = '\0';
+      if (swe_get_orbital_elements(tjd_et[j], ipl[i], iflag, de, s) == ERR) {
+	memset((void *) dp, 0, SE_NORBEL_VALUES * sizeof(double));
+	if (retval == OK && serr != NULL)
+	  strcpy(serr, s);
+	retval = ERR;
+	continue;
+      }
+      memcpy((void *) dp, (void *) de, SE_NORBEL_VALUES * sizeof(double));
+    }
+  }
+  return retval;
+}
+
+/* Maximum, minimum and true distance of several bodies at several dates,
+ * as with swe_orbit_max_min_true_distance().
+ * dret			return values, declare as dret[nbodies * ntimes * 3];
+ *                      the distances of body ipl[i] at date tjd_et[j] are
+ *                      dret[(i * ntimes + j) * 3 + 0] maximum distance
+ *                      dret[(i * ntimes + j) * 3 + 1] minimum distance
+ *                      dret[(i * ntimes + j) * 3 + 2] true distance
+ * The elements of the EMB, which are needed for geocentric distances, are 
+ * computed only once per date. Errors are handled as with 
+ * swe_get_orbital_elements_array().
+ */
+int32 CALL_CONV swe_orbit_max_min_true_distance_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *dret, char *serr)
+{
+  int32 i, j, retval = OK;
+  int32 iflagi = (iflag & (SEFLG_EPHMASK | SEFLG_HELCTR | SEFLG_BARYCTR));
+  double dp[50], de[50], *dd;
+  AS_BOOL is_helio = (iflagi & (SEFLG_HELCTR | SEFLG_BARYCTR)) != 0;
+  AS_BOOL have_earth;
+  int32 retc;
+  char s[AS_MAXCH], se[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  for (j = 0; j < ntimes; j++) {
+    have_earth = FALSE;
+    for (i = 0; i < nbodies; i++) {
+      dd = dret + ((size_t) i * ntimes + j) * 3;
+      *s = '\0';
+      if (ipl[i] == SE_SUN || ipl[i] == SE_MOON || is_helio) {
+	retc = orbit_max_min_true_distance_helio(tjd_et[j], ipl[i], iflagi, &dd[0], &dd[1], &dd[2], s);
+      } else {
+	if (!have_earth) {
+	  *se = '\0';
+	  if (swe_get_orbital_elements(tjd_et[j], SE_EARTH, iflagi, de, se) == ERR) {
+	    strcpy(s, se);
+	    retc = ERR;
+	    goto next_body;
+	  }
+	  have_earth = TRUE;
+	}
+	retc = swe_get_orbital_elements(tjd_et[j], ipl[i], iflagi, dp, s);
+	if (retc != ERR)
+	  orbit_max_min_true_distance_elem(dp, de, &dd[0], &dd[1], &dd[2]);
+      }
+next_body:
+      if (retc == ERR) {
+	dd[0] = dd[1] = dd[2] = 0;
+	if (retval == OK && serr != NULL)
+	  strcpy(serr, s);
+	retval = ERR;
+      }
+    }
+  }
+  return retval;
+}
+
+/* geocentric maximum, minimum and true distance of a planet from the 
+ * orbital elements dp of the planet and de of the EMB */
+static void orbit_max_min_true_distance_elem(double *dp, double *de, double *dmax, double *dmin, double *dtrue)
+{
+  int i, j, k;
+  double xouter[3], xinner[3], max_xouter[3], max_xinner[3], min_xouter[3], min_xinner[3], pqro[20], pqri[20];
+  double xinner_grid[OSC_NGRID][3];
+  double eano, eani;
+  double *douter, *dinner;
+  double r, rtrue, rmax = 0, rmin = 100000000, rminsv = 0, rmaxsv = 0;
+  double min_eanisv = 0, min_eanosv = 0, max_eanisv = 0, max_eanosv = 0;
+  double dstep;
+  double nitermax = 300;
   if (de[0] > dp[0]) {
     douter = de;
     dinner = dp;
@@ -6216,7 +6594,6 @@ int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
    * performance. A faster algorithm without this problem would require 
    * considerably higher sophistication.
    * */
-  ncnt = 182;
   dstep = 2;
   for (i = 0; i < 3; i++) { /* initialisation */
     max_xouter[i] = 0;
@@ -6224,13 +6601,16 @@ int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
     min_xouter[i] = 0;
     min_xinner[i] = 0;
   }
-  for (j = 0; j < ncnt; j++) {
+  /* the positions of the inner planet are the same for all steps
+   * of the outer one */
+  for (i = 0; i < OSC_NGRID; i++)
+    osc_get_ecl_pos((double) i, pqri, xinner_grid[i]);
+  for (j = 0; j < OSC_NGRID; j++) {
     eano = (double) j * dstep;
     osc_get_ecl_pos(eano, pqro, xouter);
-    for (i = 0; i < ncnt; i++) {
+    for (i = 0; i < OSC_NGRID; i++) {
       eani = (double) i;
-      osc_get_ecl_pos(eani, pqri, xinner);
-      r = get_dist_from_2_vectors(xouter, xinner);
+      r = get_dist_from_2_vectors(xouter, xinner_grid[i]);
       /* maximum/minimum found; save positions and ecc. anomalies */
       if (r > rmax) {
         rmax = r;
@@ -6238,7 +6618,7 @@ int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
         max_eanosv = eano;
 	for (k = 0; k < 3; k++) {
 	  max_xouter[k] = xouter[k];
-	  max_xinner[k] = xinner[k];
+	  max_xinner[k] = xinner_grid[i][k];
 	}
       }
       if (r < rmin) {
@@ -6247,7 +6627,7 @@ int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
         min_eanosv = eano;
 	for (k = 0; k < 3; k++) {
 	  min_xouter[k] = xouter[k];
-	  min_xinner[k] = xinner[k];
+	  min_xinner[k] = xinner_grid[i][k];
 	}
       }
     }
@@ -6284,7 +6664,6 @@ int32 CALL_CONV swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
   *dmax = rmax;
   *dmin = rmin;
   *dtrue = rtrue;
-  return retval;
 }
 
 /* function finds the gauquelin sector position of a planet or fixed star
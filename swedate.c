@@ -85,6 +85,7 @@
 # include "sweph.h"
 
 static TLS AS_BOOL init_leapseconds_done = FALSE;
+static TLS int leap_seconds_tabsiz = 0;
 
 
 int CALL_CONV swe_date_conversion(int y,
@@ -306,6 +307,14 @@ static TLS int leap_seconds[NLEAP_SECONDS_SPACE] = {
 #define J1972 2441317.5
 #define NLEAP_INIT 10
 
+/* TT at the end of the leap second with index ileap, for jdet_to_utc() */
+struct leapsec_cache {
+  int ileap;
+  double tjd_et;
+};
+
+static double jdet_to_utc(double tjd_et, int *second_60, struct leapsec_cache *lc);
+
 /* Read additional leap second dates from external file, if given.
  */
 static int init_leapsec(void)
@@ -313,12 +322,12 @@ static int init_leapsec(void)
   FILE *fp;
   int ndat, ndat_last;
   int tabsiz = 0;
-  int i;
   char s[AS_MAXCH];
   char *sp;
   if (!init_leapseconds_done) {
     init_leapseconds_done = TRUE;
     tabsiz = NLEAP_SECONDS;
+    leap_seconds_tabsiz = tabsiz;
     ndat_last = leap_seconds[NLEAP_SECONDS - 1];
     /* no error message if file is missing */
     if ((fp = swi_fopen(-1, "seleapsec.txt", swed.ephepath, NULL)) == NULL)
@@ -330,27 +339,40 @@ static int init_leapsec(void)
       if (*sp == '#' || *sp == '\n')
         continue;
       ndat = atoi(s);
+      /* the table must stay in ascending order, see leapsec_index() */
       if (ndat <= ndat_last)
         continue;
-      /* table space is limited. no error msg, if exceeded */
-      if (tabsiz >= NLEAP_SECONDS_SPACE)
-        return tabsiz;
+      /* table space is limited. no error msg, if exceeded;
+       * the last entry stays 0 as end mark */
+      if (tabsiz >= NLEAP_SECONDS_SPACE - 1)
+        break;
       leap_seconds[tabsiz] = ndat;
+      ndat_last = ndat;
       tabsiz++;
     }
     if (tabsiz > NLEAP_SECONDS) leap_seconds[tabsiz] = 0; /* end mark */
     fclose(fp);
+    leap_seconds_tabsiz = tabsiz;
     return tabsiz;
   }
-  /* find table size */
-  tabsiz = 0;
-  for (i = 0; i < NLEAP_SECONDS_SPACE; i++) {
-    if (leap_seconds[i] == 0) 
-      break;
+  return leap_seconds_tabsiz;
+}
+
+/* Index of the first leap second on or after the date ndat (yyyymmdd), 
+ * i.e. the number of leap seconds inserted before this date.
+ * Binary search in the ascending table of tabsiz leap seconds.
+ */
+static int leapsec_index(int ndat, int tabsiz)
+{
+  int lo = 0, hi = tabsiz, mid;
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (leap_seconds[mid] < ndat)
+      lo = mid + 1;
     else
-      tabsiz++;
+      hi = mid;
   }
-  return tabsiz;
+  return lo;
 }
 
 /*
@@ -376,7 +398,7 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
 {
   double tjd_ut1, tjd_et, tjd_et_1972, dhour, d;
   int iyear2, imonth2, iday2;
-  int i, j, ndat, nleap, tabsiz_nleap;
+  int i, ndat, nleap, tabsiz_nleap;
   /* 
    * error handling: invalid iyear etc. 
    */
@@ -415,13 +437,10 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
    * number of leap seconds since 1972: 
    */
   tabsiz_nleap = init_leapsec();
-  nleap = NLEAP_INIT; /* initial difference between UTC and TAI in 1972 */
   ndat = iyear * 10000 + imonth * 100 + iday;
-  for (i = 0; i < tabsiz_nleap; i++) {
-    if (ndat <= leap_seconds[i])
-      break;
-    nleap++;
-  }
+  i = leapsec_index(ndat, tabsiz_nleap);
+  /* initial difference between UTC and TAI in 1972 */
+  nleap = NLEAP_INIT + i;
   /*
    * For input dates > today:
    * If leap seconds table is not up to date, we'd better interpret the
@@ -438,14 +457,7 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
    * if input second is 60: is it a valid leap second ? 
    */
   if (dsec >= 60) {
-    j = 0;
-    for (i = 0; i < tabsiz_nleap; i++) {
-      if (ndat == leap_seconds[i]) {
-	j = 1;
-	break;
-      }
-    }
-    if (j != 1) {
+    if (i >= tabsiz_nleap || leap_seconds[i] != ndat) {
       if (serr != NULL)
 	sprintf(serr, "invalid time (no leap second!): %d:%d:%.2f", ihour, imin, dsec);
       return ERR;
@@ -485,19 +497,17 @@ int32 CALL_CONV swe_utc_to_jd(int32 iyear, int32 imonth, int32 iday, int32 ihour
  */
 void CALL_CONV swe_jdet_to_utc(double tjd_et, int32 gregflag, int32 *iyear, int32 *imonth, int32 *iday, int32 *ihour, int32 *imin, double *dsec) 
 {
-  int i;
-  int second_60 = 0;
-  int iyear2, imonth2, iday2, nleap, ndat, tabsiz_nleap;
-  double d, tjd, tjd_et_1972, tjd_ut, dret[10];
+  int second_60;
+  double d, tjd, tjd_et_1972;
+  struct leapsec_cache lc;
+  lc.ileap = -1;
+  tjd = jdet_to_utc(tjd_et, &second_60, &lc);
   /* 
    * if tjd_et is before 1 jan 1972 UTC, return UT1
    */
   tjd_et_1972 = J1972 + (32.184 + NLEAP_INIT) / 86400.0; 
-  d = swe_deltat_ex(tjd_et, -1, NULL);
-  tjd_ut = tjd_et - swe_deltat_ex(tjd_et - d, -1, NULL);
-  tjd_ut = tjd_et - swe_deltat_ex(tjd_ut, -1, NULL);
   if (tjd_et < tjd_et_1972) {
-    swe_revjul(tjd_ut, gregflag, iyear, imonth, iday, &d);
+    swe_revjul(tjd, gregflag, iyear, imonth, iday, &d);
     *ihour = (int32) d;
     d -= (double) *ihour;
     d *= 60;
@@ -505,6 +515,37 @@ void CALL_CONV swe_jdet_to_utc(double tjd_et, int32 gregflag, int32 *iyear, int3
     *dsec = (d - (double) *imin) * 60.0;
     return;
   }
+  swe_revjul(tjd, SE_GREG_CAL, iyear, imonth, iday, &d);
+  *ihour = (int32) d;
+  d -= (double) *ihour;
+  d *= 60;
+  *imin = (int32) d;
+  *dsec = (d - (double) *imin) * 60.0 + second_60;
+  if (gregflag == SE_JUL_CAL) {
+    tjd = swe_julday(*iyear, *imonth, *iday, 0, SE_GREG_CAL);
+    swe_revjul(tjd, gregflag, iyear, imonth, iday, &d);
+  }
+}
+
+/* UTC (or UT1, see swe_jdet_to_utc()) of tjd_et as a Julian day number
+ * of the clock time; during a leap second, the clock time is that of 
+ * second 59, and *second_60 is set to 1.
+ * lc remembers the end of the leap second found last, so that a series 
+ * of dates needs one call of swe_utc_to_jd() per leap second only;
+ * lc->ileap = -1 for the first call.
+ */
+static double jdet_to_utc(double tjd_et, int *second_60, struct leapsec_cache *lc)
+{
+  int i;
+  int iyear2, imonth2, iday2, nleap, ndat, tabsiz_nleap;
+  double d, d2, tjd, tjd_et_1972, tjd_ut, dret[10];
+  *second_60 = 0;
+  tjd_et_1972 = J1972 + (32.184 + NLEAP_INIT) / 86400.0; 
+  d = swe_deltat_ex(tjd_et, -1, NULL);
+  d2 = swe_deltat_ex(tjd_et - d, -1, NULL);
+  tjd_ut = tjd_et - swe_deltat_ex(tjd_et - d2, -1, NULL);
+  if (tjd_et < tjd_et_1972) 
+    return tjd_ut;
   /* 
    * minimum number of leap seconds since 1972; we may be missing one leap
    * second
@@ -512,58 +553,42 @@ void CALL_CONV swe_jdet_to_utc(double tjd_et, int32 gregflag, int32 *iyear, int3
   tabsiz_nleap = init_leapsec();
   swe_revjul(tjd_ut-1, SE_GREG_CAL, &iyear2, &imonth2, &iday2, &d);
   ndat = iyear2 * 10000 + imonth2 * 100 + iday2;
-  nleap = 0; 
-  for (i = 0; i < tabsiz_nleap; i++) {
-    if (ndat <= leap_seconds[i])
-      break;
-    nleap++;
-  }
+  nleap = leapsec_index(ndat, tabsiz_nleap);
   /* date of potentially missing leapsecond */
   if (nleap < tabsiz_nleap) {
-    i = leap_seconds[nleap];
-    iyear2 = i / 10000;
-    imonth2 = (i % 10000) / 100;;
-    iday2 = i % 100;
-    tjd = swe_julday(iyear2, imonth2, iday2, 0, SE_GREG_CAL);
-    swe_revjul(tjd+1, SE_GREG_CAL, &iyear2, &imonth2, &iday2, &d);
-    swe_utc_to_jd(iyear2,imonth2,iday2, 0, 0, 0, SE_GREG_CAL, dret, NULL);
-    d = tjd_et - dret[0];
+    if (lc->ileap != nleap) {
+      i = leap_seconds[nleap];
+      iyear2 = i / 10000;
+      imonth2 = (i % 10000) / 100;;
+      iday2 = i % 100;
+      tjd = swe_julday(iyear2, imonth2, iday2, 0, SE_GREG_CAL);
+      swe_revjul(tjd+1, SE_GREG_CAL, &iyear2, &imonth2, &iday2, &d);
+      swe_utc_to_jd(iyear2,imonth2,iday2, 0, 0, 0, SE_GREG_CAL, dret, NULL);
+      lc->ileap = nleap;
+      lc->tjd_et = dret[0];
+    }
+    d = tjd_et - lc->tjd_et;
     if (d >= 0) {
       nleap++;
     } else if (d < 0 && d > -1.0/86400.0) {
-      second_60 = 1;
+      *second_60 = 1;
     }
   }
-  /*
-   * UTC, still unsure about one leap second
-   */
-  tjd = J1972 + (tjd_et - tjd_et_1972) - ((double) nleap + second_60) / 86400.0;
-  swe_revjul(tjd, SE_GREG_CAL, iyear, imonth, iday, &d);
-  *ihour = (int32) d;
-  d -= (double) *ihour;
-  d *= 60;
-  *imin = (int32) d;
-  *dsec = (d - (double) *imin) * 60.0 + second_60;
   /*
    * For input dates > today:
    * If leap seconds table is not up to date, we'd better interpret the
    * input time as UT1, not as UTC. How do we find out? 
    * Check, if delta_t - nleap - 32.184 > 0.9
+   * (d2 is delta t for tjd_et - delta t)
    */
-  d = swe_deltat_ex(tjd_et, -1, NULL);
-  d = swe_deltat_ex(tjd_et - d, -1, NULL);
-  if (d * 86400.0 - (double) (nleap + NLEAP_INIT) - 32.184 >= 1.0) {
-    swe_revjul(tjd_et - d, SE_GREG_CAL, iyear, imonth, iday, &d);
-    *ihour = (int32) d;
-    d -= (double) *ihour;
-    d *= 60;
-    *imin = (int32) d;
-    *dsec = (d - (double) *imin) * 60.0;
-  }
-  if (gregflag == SE_JUL_CAL) {
-    tjd = swe_julday(*iyear, *imonth, *iday, 0, SE_GREG_CAL);
-    swe_revjul(tjd, gregflag, iyear, imonth, iday, &d);
+  if (d2 * 86400.0 - (double) (nleap + NLEAP_INIT) - 32.184 >= 1.0) {
+    *second_60 = 0;
+    return tjd_et - d2;
   }
+  /*
+   * UTC, still unsure about one leap second
+   */
+  return J1972 + (tjd_et - tjd_et_1972) - ((double) nleap + *second_60) / 86400.0;
 }
 
 /*
@@ -586,3 +611,121 @@ void CALL_CONV swe_jdut1_to_utc(double tjd_ut, int32 gregflag, int32 *iyear, int
   swe_jdet_to_utc(tjd_et, gregflag, iyear, imonth, iday, ihour, imin, dsec);
 }
 
+
+/*
+ * Conversions between UTC and TT/UT1 for arrays of dates.
+ * UTC is given as two arrays of ntimes values:
+ *   tjd_day[i]     Julian day number of the date at 0h UTC (Gregorian
+ *                  or Julian calendar, it makes no difference), 
+ *                  e.g. from swe_julday(y, m, d, 0, gregflag)
+ *   dsec_day[i]    seconds since 0h UTC, 0 <= dsec_day[i] < 86400,
+ *                  or < 86401 on a day that ends with a leap second.
+ * The results are those of swe_utc_to_jd(), swe_jdet_to_utc() and
+ * swe_jdut1_to_utc(), up to rounding errors of the Julian day numbers.
+ * The date of the leap second table and the decision between UTC and 
+ * UT1 are looked up once per day, as long as successive dates are on
+ * the same day.
+ */
+
+/* Input:  tjd_day, dsec_day  UTC, see above
+ * Output: dret[2 * i]        Julian day number TT (ET)
+ *         dret[2 * i + 1]    Julian day number UT1
+ * Returns OK, or ERR if a date is invalid; its values are then 0,
+ * and serr contains the first error message.
+ */
+int32 CALL_CONV swe_utc_to_jd_array(double *tjd_day, double *dsec_day, int32 ntimes, double *dret, char *serr)
+{
+  int32 k, retval = OK;
+  int i, ndat, nleap = 0, tabsiz_nleap, iyear, imonth, iday;
+  AS_BOOL is_ut1 = TRUE, is_leapday = FALSE;
+  double tjd0 = 0, tjd, tjd_et, tjd_et_1972, dsec, d;
+  tjd_et_1972 = J1972 + (32.184 + NLEAP_INIT) / 86400.0;
+  tabsiz_nleap = init_leapsec();
+  if (serr != NULL)
+    *serr = '\0';
+  for (k = 0; k < ntimes; k++) {
+    tjd = tjd_day[k];
+    dsec = dsec_day[k];
+    dret[2 * k] = dret[2 * k + 1] = 0;
+    if (tjd - 0.5 != floor(tjd - 0.5)) {
+      if (retval == OK && serr != NULL)
+	sprintf(serr, "invalid date: %.8f is not at 0h", tjd);
+      retval = ERR;
+      continue;
+    }
+    /* 
+     * leap seconds and the decision between UTC and UT1, once per day
+     */
+    if (k == 0 || tjd != tjd0) {
+      tjd0 = tjd;
+      is_ut1 = TRUE;
+      is_leapday = FALSE;
+      if (tjd >= J1972) {
+	swe_revjul(tjd, SE_GREG_CAL, &iyear, &imonth, &iday, &d);
+	ndat = iyear * 10000 + imonth * 100 + iday;
+	i = leapsec_index(ndat, tabsiz_nleap);
+	nleap = NLEAP_INIT + i;
+	is_leapday = (i < tabsiz_nleap && leap_seconds[i] == ndat);
+	/* as in swe_utc_to_jd() */
+	d = swe_deltat_ex(tjd, -1, NULL) * 86400.0;
+	is_ut1 = (d - (double) nleap - 32.184 >= 1.0);
+      }
+    }
+    /* second 60, as in swe_utc_to_jd() */
+    if (dsec < 0 || dsec >= 86401 
+      || (dsec >= 86400 && (tjd < J1972 || (!is_ut1 && !is_leapday)))) {
+      if (retval == OK && serr != NULL)
+	sprintf(serr, "invalid time: %.2f seconds of day %.1f", dsec, tjd);
+      retval = ERR;
+      continue;
+    }
+    if (is_ut1) {
+      dret[2 * k + 1] = tjd + dsec / 86400.0;
+      dret[2 * k] = dret[2 * k + 1] + swe_deltat_ex(dret[2 * k + 1], -1, NULL);
+      continue;
+    }
+    d = tjd - J1972;
+    d += dsec / 86400.0;
+    tjd_et = tjd_et_1972 + d + ((double) (nleap - NLEAP_INIT)) / 86400.0;
+    d = swe_deltat_ex(tjd_et, -1, NULL);
+    d = tjd_et - swe_deltat_ex(tjd_et - d, -1, NULL);
+    dret[2 * k] = tjd_et;
+    dret[2 * k + 1] = tjd_et - swe_deltat_ex(d, -1, NULL);
+  }
+  return retval;
+}
+
+/* Input:  tjd_et             ntimes Julian day numbers TT (ET)
+ * Output: tjd_day, dsec_day  UTC, see above; UT1 before 1972, and if 
+ *                            the leap second table is outdated
+ */
+void CALL_CONV swe_jdet_to_utc_array(double *tjd_et, int32 ntimes, double *tjd_day, double *dsec_day)
+{
+  int32 k;
+  int second_60;
+  double tjd;
+  struct leapsec_cache lc;
+  lc.ileap = -1;
+  for (k = 0; k < ntimes; k++) {
+    tjd = jdet_to_utc(tjd_et[k], &second_60, &lc);
+    tjd_day[k] = floor(tjd - 0.5) + 0.5;
+    dsec_day[k] = (tjd - tjd_day[k]) * 86400.0 + second_60;
+  }
+}
+
+/* Input:  tjd_ut             ntimes Julian day numbers UT1
+ * Output: tjd_day, dsec_day  UTC, as with swe_jdet_to_utc_array()
+ */
+void CALL_CONV swe_jdut1_to_utc_array(double *tjd_ut, int32 ntimes, double *tjd_day, double *dsec_day)
+{
+  int32 k;
+  int second_60;
+  double tjd;
+  struct leapsec_cache lc;
+  lc.ileap = -1;
+  for (k = 0; k < ntimes; k++) {
+    tjd = jdet_to_utc(tjd_ut[k] + swe_deltat_ex(tjd_ut[k], -1, NULL), &second_60, &lc);
+    tjd_day[k] = floor(tjd - 0.5) + 0.5;
+    dsec_day[k] = (tjd - tjd_day[k]) * 86400.0 + second_60;
+  }
+}
@@ -110,11 +110,38 @@ DllImport int32 CALL_CONV_IMP  swe_calc_pctr(
 	double *xxret, 
 	char *serr);
 
+DllImport int32 CALL_CONV_IMP swe_calc_pctr_bodies( 
+        double tjd, int32 *ipl, int32 nbodies, int32 iplctr, int32 iflag, 
+        double *xx, int32 *iflgret,
+        char *serr);
+
 DllImport int32 CALL_CONV_IMP swe_calc_ut( 
         double tjd_ut, int32 ipl, int32 iflag, 
         double *xx,
         char *serr);
 
+DllImport int32 CALL_CONV_IMP swe_calc_all_frames( 
+        double tjd, int32 ipl, int32 iflag, 
+        double *geopos, double atpress, double attemp, 
+        double *xx,
+        char *serr);
+
+DllImport int32 CALL_CONV_IMP swe_calc_all_frames_ut( 
+        double tjd_ut, int32 ipl, int32 iflag, 
+        double *geopos, double atpress, double attemp, 
+        double *xx,
+        char *serr);
+
+DllImport int32 CALL_CONV_IMP swe_calc_bodies( 
+        double tjd, int32 *ipl, int32 nbodies, int32 iflag, 
+        double *xx, int32 *iflgret,
+        char *serr);
+
+DllImport int32 CALL_CONV_IMP swe_calc_bodies_ut( 
+        double tjd_ut, int32 *ipl, int32 nbodies, int32 iflag, 
+        double *xx, int32 *iflgret,
+        char *serr);
+
 DllImport double CALL_CONV_IMP swe_solcross(
 	double x2cross, double jd_et, int32 flag, char *serr);
 DllImport double CALL_CONV_IMP swe_solcross_ut(
@@ -160,9 +187,11 @@ DllImport int32 CALL_CONV_IMP swe_fixstar2_mag(
 
 DllImport double CALL_CONV_IMP swe_sidtime0(double tjd_ut, double ecl, double nut);
 DllImport double CALL_CONV_IMP swe_sidtime(double tjd_ut);
+DllImport void CALL_CONV_IMP swe_sidtime_array(double *tjd_ut, int32 ntimes, double *tsid);
 
 DllImport double CALL_CONV_IMP swe_deltat_ex(double tjd, int32 iflag, char *serr);
 DllImport double CALL_CONV_IMP swe_deltat(double tjd);
+DllImport void CALL_CONV_IMP swe_deltat_array(double *tjd, int32 ntimes, int32 iflag, double *deltat, char *serr);
 
 DllImport int  CALL_CONV_IMP swe_houses(
         double tjd_ut, double geolat, double geolon, int hsys, 
@@ -203,6 +232,13 @@ DllImport double  CALL_CONV_IMP swe_get_ayanamsa_ut(double tjd_ut);
 
 DllImport char * CALL_CONV_IMP swe_get_ayanamsa_name(int32 isidmode);
 DllImport char * CALL_CONV_IMP swe_get_current_file_data(int ifno, double *tfstart, double *tfend, int *denum);
+DllImport void CALL_CONV_IMP swe_set_calc_cache(int32 nentries);
+DllImport void CALL_CONV_IMP swe_get_calc_cache_stats(double *dret);
+DllImport void CALL_CONV_IMP swe_set_ast_file_pool(int32 nfiles);
+DllImport int32 CALL_CONV_IMP swe_prefetch(double tjd_start, double tjd_end, int32 body_mask, int32 iflag, char *serr);
+DllImport void CALL_CONV_IMP swe_get_prefetch_stats(double *dret);
+DllImport int32 CALL_CONV_IMP swe_set_ephe_preload(double tjd_start, double tjd_end, char *serr);
+DllImport void CALL_CONV_IMP swe_get_ephe_preload_stats(double *dret);
 
 DllImport int  CALL_CONV_IMP swe_date_conversion(
         int y , int m , int d ,         /* year, month, day */
@@ -242,6 +278,10 @@ DllImport void  CALL_CONV_IMP swe_jdut1_to_utc(
 	int32 *iyear, int32 *imonth, int32 *iday, 
 	int32 *ihour, int32 *imin, double *dsec);
 
+DllImport int32  CALL_CONV_IMP swe_utc_to_jd_array(double *tjd_day, double *dsec_day, int32 ntimes, double *dret, char *serr);
+DllImport void  CALL_CONV_IMP swe_jdet_to_utc_array(double *tjd_et, int32 ntimes, double *tjd_day, double *dsec_day);
+DllImport void  CALL_CONV_IMP swe_jdut1_to_utc_array(double *tjd_ut, int32 ntimes, double *tjd_day, double *dsec_day);
+
 DllImport int  CALL_CONV_IMP swe_time_equ(
         double tjd, double *e, char *serr);
 DllImport int  CALL_CONV_IMP swe_lmt_to_lat(double tjd_lmt, double geolon, double *tjd_lat, char *serr);
@@ -300,6 +340,10 @@ DllImport int32  CALL_CONV_IMP swe_pheno(double tjd, int32 ipl, int32 iflag, dou
 
 DllImport int32  CALL_CONV_IMP swe_pheno_ut(double tjd_ut, int32 ipl, int32 iflag, double *attr, char *serr);
 
+DllImport int32 CALL_CONV_IMP swe_pheno_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *attr, char *serr);
+
+DllImport int32 CALL_CONV_IMP swe_pheno_ut_array(double *tjd_ut, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *attr, char *serr);
+
 DllImport double  CALL_CONV_IMP swe_refrac(double inalt, double atpress, double attemp, int32 calc_flag);
 DllImport double  CALL_CONV_IMP swe_refrac_extended(double inalt, double geoalt, double atpress, double attemp, double lapse_rate, int32 calc_flag, double *dret);
 DllImport void  CALL_CONV_IMP swe_set_lapse_rate(double lapse_rate);
@@ -320,6 +364,10 @@ DllImport void  CALL_CONV_IMP swe_azalt_rev(
       double *xin, 
       double *xout); 
 
+DllImport void  CALL_CONV_IMP swe_azalt_array(double *tjd_ut, int32 ntimes, int32 calc_flag, double *geopos, double atpress, double attemp, double *xin, int32 ncoord, double *xaz);
+
+DllImport void  CALL_CONV_IMP swe_azalt_rev_array(double *tjd_ut, int32 ntimes, int32 calc_flag, double *geopos, double *xin, int32 ncoord, double *xout);
+
 DllImport int32  CALL_CONV_IMP swe_rise_trans(
                double tjd_ut, int32 ipl, char *starname, 
 	       int32 epheflag, int32 rsmi,
@@ -353,6 +401,10 @@ DllImport int32 CALL_CONV_IMP swe_get_orbital_elements(double tjd_et, int32 ipl,
 
 DllImport int32 CALL_CONV_IMP swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32 iflag, double *dmax, double *dmin, double *dtrue, char *serr);
 
+DllImport int32 CALL_CONV_IMP swe_get_orbital_elements_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *dret, char *serr);
+
+DllImport int32 CALL_CONV_IMP swe_orbit_max_min_true_distance_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *dret, char *serr);
+
 /******************************************************* 
  * other functions from swephlib.c;
  * they are not needed for Swiss Ephemeris,
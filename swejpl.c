@@ -950,3 +950,26 @@ int32 swi_get_jpl_denum()
   return js->eh_denum;
 }
 
+/* reads the record of et, if it is not in memory, and returns its 
+ * start and end date in ts[0..1] and the coefficient pointers 
+ * eh_ipt[0..38] of the file in ipt. For the tool sweverify. */
+int swi_get_jpl_record(double et, double *ts, int32 *ipt, char *serr)
+{
+  int i, retc;
+  int32 list[12];
+  if (js == NULL || js->jplfptr == NULL) {
+    if (serr != NULL)
+      strcpy(serr, "JPL ephemeris file not open");
+    return NOT_AVAILABLE;
+  }
+  for (i = 0; i < 12; i++)
+    list[i] = 0;
+  if ((retc = state(et, list, FALSE, js->pv, js->pvsun, NULL, serr)) != OK)
+    return retc;
+  ts[0] = js->buf[0];
+  ts[1] = js->buf[1];
+  for (i = 0; i < 39; i++)
+    ipt[i] = js->eh_ipt[i];
+  return OK;
+}
+
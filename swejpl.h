@@ -99,5 +99,11 @@ extern int swi_open_jpl_file(double *ss, char *fname, char *fpath, char *serr);
 
 extern int32 swi_get_jpl_denum(void);
 
+/*
+ * start and end date of the record of et in ts[0..1], 
+ * coefficient pointers of the file in ipt[0..38]
+ */
+extern int swi_get_jpl_record(double et, double *ts, int32 *ipt, char *serr);
+
 extern void swi_IERS_FK5(double *xin, double *xout, int dir);
 
@@ -0,0 +1,310 @@
+/********************************************************************
+swelunfit.c
+
+Create the file selunfit.dat, a Chebyshev pre-fit of the osculating
+lunar node ('true node'), the osculating lunar apogee ('true Lilith')
+and the interpolated lunar apogee and perigee.
+If the file is found in the ephemeris path, swe_calc() takes these
+points from it and need not compute them from three lunar positions
+(true node and osculating apogee) or by iteration (interpolated apsides).
+
+options: -bJD	start date (ET), default 2415020.5 (1 Jan 1900)
+	 -eJD	end date (ET), default 2488070.5 (1 Jan 2100)
+	 -dN	segment length in days, default 8
+	 -nN	Chebyshev coefficients per coordinate, default 12
+	 -eswe	node and osculating apogee from Swiss Ephemeris (default)
+	 -ejpl	... from JPL ephemeris
+	 -emos	... from Moshier ephemeris
+	 -ejplFILE	JPL ephemeris file
+	 -edirPATH	ephemeris path
+	 -oFILE	output file, default selunfit.dat
+	 -v	verbose: print accuracy of every year
+
+The points are fitted in the ecliptic of date, with nutation and,
+for the node and the osculating apogee, with light-time of the moon,
+i.e. as swe_calc() returns them without any flags. swe_calc() uses the
+file for the node and the osculating apogee only if none of the flags
+SEFLG_TRUEPOS, SEFLG_NONUT, SEFLG_ICRS, SEFLG_JPLHOR and
+SEFLG_JPLHOR_APPROX is given and the ephemeris is the one the file has
+been fitted with. The interpolated apsides are always taken from the
+file if it covers the date.
+After the fit, each segment is compared with the direct computation
+at 2 * ncoe points between the fitting nodes. The greatest deviation
+found is printed and written into the file header.
+
+File format: struct lunfit_head (sweph.h), followed by the segments,
+in the byte order of the machine that wrote the file.
+
+*********************************************************************/
+/* Copyright (C) 1997 - 2021 Astrodienst AG, Switzerland.  All rights reserved.
+
+  License conditions
+  ------------------
+
+  This file is part of Swiss Ephemeris.
+
+  Swiss Ephemeris is distributed with NO WARRANTY OF ANY KIND.  No author
+  or distributor accepts any responsibility for the consequences of using it,
+  or for whether it serves any particular purpose or works at all, unless he
+  or she says so in writing.
+
+  Swiss Ephemeris is made available by its authors under a dual licensing
+  system. The software developer, who uses any part of Swiss Ephemeris
+  in his or her software, must choose between one of the two license models,
+  which are
+  a) GNU Affero General Public License (AGPL)
+  b) Swiss Ephemeris Professional License
+
+  The choice must be made before the software developer distributes software
+  containing parts of Swiss Ephemeris to others, and before any public
+  service using the developed software is activated.
+
+  If the developer choses the AGPL software license, he or she must fulfill
+  the conditions of that license, which includes the obligation to place his
+  or her whole software project under the AGPL or a compatible license.
+  See https://www.gnu.org/licenses/agpl-3.0.html
+
+  If the developer choses the Swiss Ephemeris Professional license,
+  he must follow the instructions as found in http://www.astro.com/swisseph/
+  and purchase the Swiss Ephemeris Professional Edition from Astrodienst
+  and sign the corresponding license contract.
+
+  The License grants you the right to use, copy, modify and redistribute
+  Swiss Ephemeris, but only under certain conditions described in the License.
+  Among other things, the License requires that the copyright notices and
+  this notice be preserved on all copies.
+
+  Authors of the Swiss Ephemeris: Dieter Koch and Alois Treindl
+
+  The authors of Swiss Ephemeris have no control or influence over any of
+  the derived works, i.e. over software or services created by other
+  programmers which use Swiss Ephemeris functions.
+
+  The names of the authors or of the copyright holder (Astrodienst) must not
+  be used for promoting any software, product or service which uses or contains
+  the Swiss Ephemeris. This copyright notice is the ONLY place where the
+  names of the authors can legally appear, except in cases where they have
+  given special permission in writing.
+
+  The trademarks 'Swiss Ephemeris' and 'Swiss Ephemeris inside' may be used
+  for promoting such software, products or services.
+*/
+
+# include "swephexp.h"
+# include "sweph.h"
+# include "swephlib.h"
+
+static char *pname[SEI_LUNFIT_NPTS] = {
+  "true node", "osc. apogee", "intp. apogee", "intp. perigee"
+};
+
+static char *arg0;
+static int32 iephe = SEFLG_SWIEPH;
+static int ncoe = SEI_LUNFIT_NCOE;
+static double dseg = SEI_LUNFIT_DSEG;
+static double maxerr[SEI_LUNFIT_NPTS][3];
+static double yearerr[SEI_LUNFIT_NPTS][3];
+
+/* ecliptic polar coordinates of date of point ipt (radians, AU),
+ * computed directly */
+static int direct_pos(double tjd, int ipt, double *xpol, char *serr)
+{
+  int i;
+  int32 iflgret;
+  double x[6];
+  if (ipt <= 1) {
+    iflgret = swe_calc(tjd, ipt == 0 ? SE_TRUE_NODE : SE_OSCU_APOG, iephe, x, serr);
+    if (iflgret == ERR)
+      return ERR;
+    if ((iflgret & (SEFLG_JPLEPH|SEFLG_SWIEPH|SEFLG_MOSEPH)) != iephe) {
+      sprintf(serr, "ephemeris not available for jd %.1f", tjd);
+      return ERR;
+    }
+    for (i = 0; i <= 1; i++)
+      xpol[i] = x[i] * DEGTORAD;
+    xpol[2] = x[2];
+  } else {
+    swi_intp_apsides(tjd, xpol, ipt == 2 ? SEI_INTP_APOG : SEI_INTP_PERG);
+  }
+  return OK;
+}
+
+/* fits the segment beginning at tseg and checks the fit.
+ * coef receives SEI_LUNFIT_NPTS * 3 * ncoe coefficients */
+static int fit_segment(double tseg, double *coef, char *serr)
+{
+  int ipt, i, j, k;
+  double f[3][SEI_LUNFIT_MAXCOE], x[6], t, tmid, sum, d, *cp;
+  tmid = tseg + dseg / 2;
+  for (ipt = 0; ipt < SEI_LUNFIT_NPTS; ipt++) {
+    cp = coef + ipt * 3 * ncoe;
+    /* values at the Chebyshev nodes */
+    for (k = 0; k < ncoe; k++) {
+      t = tmid + cos(PI * (k + 0.5) / ncoe) * dseg / 2;
+      if (direct_pos(t, ipt, x, serr) == ERR)
+	return ERR;
+      for (i = 0; i <= 2; i++)
+	f[i][k] = x[i];
+      /* longitude must be continuous */
+      if (k > 0)
+	f[0][k] = f[0][k-1] + swe_difrad2n(f[0][k], f[0][k-1]);
+    }
+    for (i = 0; i <= 2; i++) {
+      for (j = 0; j < ncoe; j++) {
+	sum = 0;
+	for (k = 0; k < ncoe; k++)
+	  sum += f[i][k] * cos(PI * j * (k + 0.5) / ncoe);
+	cp[i * ncoe + j] = 2.0 * sum / ncoe;
+      }
+    }
+    /* check points between the nodes */
+    for (k = 0; k < 2 * ncoe; k++) {
+      t = tseg + dseg * (k + 0.5) / (2 * ncoe);
+      if (direct_pos(t, ipt, x, serr) == ERR)
+	return ERR;
+      for (i = 0; i <= 2; i++) {
+	d = swi_echeb((t - tseg) / dseg * 2 - 1, cp + i * ncoe, ncoe);
+	if (i == 0)
+	  d = fabs(swe_difrad2n(d, x[0]));
+	else
+	  d = fabs(d - x[i]);
+	if (d > maxerr[ipt][i])
+	  maxerr[ipt][i] = d;
+	if (d > yearerr[ipt][i])
+	  yearerr[ipt][i] = d;
+      }
+    }
+  }
+  return OK;
+}
+
+static void print_err(double (*err)[3])
+{
+  int ipt;
+  for (ipt = 0; ipt < SEI_LUNFIT_NPTS; ipt++) {
+    printf("  %-14s lon %9.6f\"  lat %9.6f\"  dist %.3e AU\n", pname[ipt],
+      err[ipt][0] * RADTODEG * 3600, err[ipt][1] * RADTODEG * 3600, err[ipt][2]);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int i;
+  int32 iseg;
+  char serr[AS_MAXCH], fnam[AS_MAXCH], ephepath[AS_MAXCH] = "", jplfile[AS_MAXCH] = "";
+  double tstart = 2415020.5, tend = 2488070.5, tseg;
+  double coef[SEI_LUNFIT_NPTS * 3 * SEI_LUNFIT_MAXCOE];
+  AS_BOOL verbose = FALSE;
+  int year, year0 = -100000, mon, day;
+  double hour;
+  FILE *fp;
+  struct lunfit_head head;
+  arg0 = argv[0];
+  strcpy(fnam, SE_FILE_LUNFIT);
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-eswe") == 0) {
+      iephe = SEFLG_SWIEPH;
+    } else if (strcmp(argv[i], "-emos") == 0) {
+      iephe = SEFLG_MOSEPH;
+    } else if (strncmp(argv[i], "-ejpl", 5) == 0) {
+      iephe = SEFLG_JPLEPH;
+      if (*(argv[i] + 5) != '\0')
+	strncpy(jplfile, argv[i] + 5, AS_MAXCH - 1);
+    } else if (strncmp(argv[i], "-edir", 5) == 0) {
+      strncpy(ephepath, argv[i] + 5, AS_MAXCH - 1);
+    } else if (strncmp(argv[i], "-b", 2) == 0) {
+      tstart = atof(argv[i] + 2);
+    } else if (strncmp(argv[i], "-e", 2) == 0) {
+      tend = atof(argv[i] + 2);
+    } else if (strncmp(argv[i], "-d", 2) == 0) {
+      dseg = atof(argv[i] + 2);
+    } else if (strncmp(argv[i], "-n", 2) == 0) {
+      ncoe = atoi(argv[i] + 2);
+    } else if (strncmp(argv[i], "-o", 2) == 0) {
+      strncpy(fnam, argv[i] + 2, AS_MAXCH - 1);
+    } else if (strcmp(argv[i], "-v") == 0) {
+      verbose = TRUE;
+    } else {
+      fprintf(stderr, "%s: illegal option %s\n", arg0, argv[i]);
+      exit(1);
+    }
+  }
+  if (ncoe < 2 || ncoe > SEI_LUNFIT_MAXCOE || dseg <= 0 || tend <= tstart) {
+    fprintf(stderr, "%s: illegal -n, -d, -b or -e\n", arg0);
+    exit(1);
+  }
+  if (tstart < MOSHLUEPH_START || tend > MOSHLUEPH_END) {
+    fprintf(stderr, "%s: interpolated apsides are restricted to JD %8.1f - JD %8.1f\n",
+      arg0, MOSHLUEPH_START, MOSHLUEPH_END);
+    exit(1);
+  }
+  swe_set_ephe_path(*ephepath != '\0' ? ephepath : NULL);
+  if (*jplfile != '\0')
+    swe_set_jpl_file(jplfile);
+  /* an old pre-fit in the ephemeris path would be fitted again */
+  if ((fp = swi_fopen(-1, SE_FILE_LUNFIT, swed.ephepath, NULL)) != NULL) {
+    fclose(fp);
+    fprintf(stderr, "%s: remove %s from the ephemeris path %s first\n",
+      arg0, SE_FILE_LUNFIT, swed.ephepath);
+    exit(1);
+  }
+  if ((fp = fopen(fnam, BFILE_W_CREATE)) == NULL) {
+    fprintf(stderr, "%s: can't open %s\n", arg0, fnam);
+    exit(1);
+  }
+  memset((void *) &head, 0, sizeof(struct lunfit_head));
+  /* header is written again at the end, with the accuracy */
+  fwrite((void *) &head, sizeof(struct lunfit_head), 1, fp);
+  head.nseg = (int32) ceil((tend - tstart) / dseg);
+  for (iseg = 0; iseg < head.nseg; iseg++) {
+    tseg = tstart + iseg * dseg;
+    if (verbose) {
+      swe_revjul(tseg, SE_GREG_CAL, &year, &mon, &day, &hour);
+      if (year != year0) {
+	if (year0 != -100000) {
+	  printf("%d\n", year0);
+	  print_err(yearerr);
+	}
+	memset((void *) yearerr, 0, sizeof(yearerr));
+	year0 = year;
+      }
+    }
+    if (fit_segment(tseg, coef, serr) == ERR) {
+      fprintf(stderr, "%s: %s\n", arg0, serr);
+      fclose(fp);
+      remove(fnam);
+      exit(1);
+    }
+    fwrite((void *) coef, sizeof(double), (size_t) (SEI_LUNFIT_NPTS * 3 * ncoe), fp);
+  }
+  if (verbose) {
+    printf("%d\n", year0);
+    print_err(yearerr);
+  }
+  memcpy((void *) head.magic, SEI_LUNFIT_MAGIC, 8);
+  head.version = SEI_LUNFIT_VERSION;
+  head.test_endian = SEI_FILE_TEST_ENDIAN;
+  head.iephe = iephe;
+  head.ncoe = ncoe;
+  head.tfstart = tstart;
+  head.dseg = dseg;
+  head.tfend = tstart + head.nseg * dseg;
+  memcpy((void *) head.astro_models, (void *) swed.astro_models, SEI_NMODELS * sizeof(int32));
+  memcpy((void *) head.maxerr, (void *) maxerr, sizeof(maxerr));
+  fseek(fp, 0L, SEEK_SET);
+  fwrite((void *) &head, sizeof(struct lunfit_head), 1, fp);
+  if (ferror(fp)) {
+    fprintf(stderr, "%s: error writing %s\n", arg0, fnam);
+    fclose(fp);
+    remove(fnam);
+    exit(1);
+  }
+  fclose(fp);
+  printf("%s: JD %.1f - %.1f, %d segments of %.1f days, %d coefficients, %.1f kB\n",
+    fnam, head.tfstart, head.tfend, head.nseg, dseg, ncoe,
+    (sizeof(struct lunfit_head) + (double) head.nseg * SEI_LUNFIT_NPTS * 3 * ncoe * sizeof(double)) / 1024);
+  printf("max. deviation from direct computation:\n");
+  print_err(maxerr);
+  swe_close();
+  return 0;
+}
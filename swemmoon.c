@@ -186,8 +186,12 @@ static void mean_elements(void);
 static void mean_elements_pl(void);
 static double mods3600(double x);
 static void ecldat_equ2000(double tjd, double *xpm);
-static void chewm(const short *pt, int nlines, int nangles, 
-  				     int typflg, double *ans );
+struct pert_term;
+static void init_pert_tables(void);
+static void decode_pert_table(const short *pt, int nlines, int typflg,
+				     struct pert_term *tp);
+static void chewm(const struct pert_term *tp, int nlines, int typflg,
+				     double *ans);
 static void sscc(int k, double arg, int n );
 static void moon1(void);
 static void moon2(void);
@@ -808,8 +812,31 @@ static const double mean_apsis_corr[] = {
  * to the same instant.  The distinction between them
  * is required by altaz().
  */
-static TLS double ss[5][8]; 
-static TLS double cc[5][8];
+/* Sine and cosine of the multiples -NMULT ... NMULT of the arguments
+ * D, l', l, F, prepared by sscc(); index NMULT + multiple.
+ * Multiples that sscc() does not compute remain 0.
+ */
+#define NMULT	8
+#define NSSCC	(2 * NMULT + 1)
+static TLS double ss[4][NSSCC];
+static TLS double cc[4][NSSCC];
+
+/* Perturbation tables LR, MB, etc. decoded for chewm():
+ * the nonzero angle factors of a line as indices into ss[][] and cc[][],
+ * the amplitudes as doubles.
+ */
+struct pert_term {
+  int nang;		/* number of angles */
+  int iang[4];		/* index into ss[][], cc[][] */
+  double ampl[2];
+};
+static TLS struct pert_term lr_terms[NLR];
+static TLS struct pert_term mb_terms[NMB];
+static TLS struct pert_term lrt_terms[NLRT];
+static TLS struct pert_term bt_terms[NBT];
+static TLS struct pert_term lrt2_terms[NLRT2];
+static TLS struct pert_term bt2_terms[NBT2];
+static TLS AS_BOOL pert_tables_ready = FALSE;
 
 static TLS double l;		/* Moon's ecliptic longitude */
 static TLS double B;		/* Ecliptic latitude */
@@ -938,6 +965,8 @@ static void  moon1()
 {
 double a;
 
+if (!pert_tables_ready)
+  init_pert_tables();
 sscc( 0, STR*D, 6 );
 sscc( 1, STR*M,  4 );
 sscc( 2, STR*MP, 4 );
@@ -948,8 +977,8 @@ moonpol[1] = 0.0;
 moonpol[2] = 0.0;
 
 /* terms in T^2, scale 1.0 = 10^-5" */
-chewm( LRT2, NLRT2, 4, 2, moonpol );
-chewm( BT2, NBT2, 4, 4, moonpol );
+chewm( lrt2_terms, NLRT2, 2, moonpol );
+chewm( bt2_terms, NBT2, 4, moonpol );
 
 f = 18 * Ve - 16 * Ea;
 
@@ -1086,8 +1115,8 @@ moonpol[2] *= T;
 
 /* terms in T */
 moonpol[0] = 0.0;
-chewm( BT, NBT, 4, 4, moonpol );
-chewm( LRT, NLRT, 4, 1, moonpol );
+chewm( bt_terms, NBT, 4, moonpol );
+chewm( lrt_terms, NLRT, 1, moonpol );
 g = STR*(f - MP - NF - 2355767.6); /* 18V - 16E - l - F */
 moonpol[1] +=  -1127. * sin(g);
 g = STR*(f - MP + NF - 235353.6); /* 18V - 16E - l + F */
@@ -1182,7 +1211,7 @@ moonpol[2] *= a;
 static void moon1()
 {
 double a;
-/* This code added by Bhanu Pinnamaneni, 17-aug-2009 */
+/* Code added by Bhanu Pinnamaneni, 17-aug-2009, cleared ss and cc here */
 /* Note by Dieter: Bhanu noted that ss and cc are not sufficiently
  * initialised and random values are used for the calculation.
  * However, this may be only part of the bug.
@@ -1190,14 +1219,10 @@ double a;
  * the 116th line of NLR, where the value "5" may be wrong.
  * Still, this will make a maximum difference of only 0.1", while the error
  * of the Moshier lunar ephemeris can reach 7". */
-int i, j;
-for (i = 0; i < 5; i++) {
-  for (j = 0; j < 8; j++) {
-    ss[i][j] = 0;
-    cc[i][j] = 0;
-  }
-}
-/* End of code addition */
+/* The entries of ss and cc that sscc() does not compute are never
+ * written, so they remain 0 and need not be cleared. */
+if (!pert_tables_ready)
+  init_pert_tables();
 sscc( 0, STR*D, 6 );
 sscc( 1, STR*M,  4 );
 sscc( 2, STR*MP, 4 );
@@ -1206,8 +1231,8 @@ moonpol[0] = 0.0;
 moonpol[1] = 0.0;
 moonpol[2] = 0.0;
 /* terms in T^2, scale 1.0 = 10^-5" */
-chewm( LRT2, NLRT2, 4, 2, moonpol );
-chewm( BT2, NBT2, 4, 4, moonpol );
+chewm( lrt2_terms, NLRT2, 2, moonpol );
+chewm( bt2_terms, NBT2, 4, moonpol );
 f = 18 * Ve - 16 * Ea;
 g = STR*(f - MP );  /* 18V - 16E - l */
 cg = cos(g);
@@ -1285,8 +1310,8 @@ moonpol[1] *= T;
 moonpol[2] *= T;
 /* terms in T */
 moonpol[0] = 0.0;
-chewm( BT, NBT, 4, 4, moonpol );
-chewm( LRT, NLRT, 4, 1, moonpol );
+chewm( bt_terms, NBT, 4, moonpol );
+chewm( lrt_terms, NLRT, 1, moonpol );
 g = STR*(f - MP - NF - 2355767.6); /* 18V - 16E - l - F */
 moonpol[1] +=  -1127. * sin(g);
 g = STR*(f - MP + NF - 235353.6); /* 18V - 16E - l + F */
@@ -1445,8 +1470,8 @@ static void moon3()
 {
 /* terms in T^0 */
 moonpol[0] = 0.0;
-chewm( LR, NLR, 4, 1, moonpol );
-chewm( MB, NMB, 4, 3, moonpol );
+chewm( lr_terms, NLR, 1, moonpol );
+chewm( mb_terms, NMB, 3, moonpol );
 l += (((l4 * T + l3) * T + l2) * T + l1) * T * 1.0e-5;
 moonpol[0] = SWELP + l + 1.0e-4 * moonpol[0];
 moonpol[1] = 1.0e-4 * moonpol[1] + B;
@@ -1625,92 +1650,132 @@ int swi_mean_apog(double J, double *pol, char *serr)
 
 /* Program to step through the perturbation table
  */
-static void chewm(const short *pt, int nlines, int nangles, int typflg, double *ans )
+static void init_pert_tables(void)
 {
-  int i, j, k, k1, m;
-  double cu, su, cv, sv, ff;
-  for( i=0; i<nlines; i++ ) {
-    k1 = 0;
-    sv = 0.0;
-    cv = 0.0;
-    for( m=0; m<nangles; m++ ) {
+  decode_pert_table(LR, NLR, 1, lr_terms);
+  decode_pert_table(MB, NMB, 3, mb_terms);
+  decode_pert_table(LRT, NLRT, 1, lrt_terms);
+  decode_pert_table(BT, NBT, 4, bt_terms);
+  decode_pert_table(LRT2, NLRT2, 2, lrt2_terms);
+  decode_pert_table(BT2, NBT2, 4, bt2_terms);
+  pert_tables_ready = TRUE;
+}
+
+/* Decode a perturbation table, so that chewm() need not
+ * interpret the multiple angle factors and amplitudes on every call.
+ * typflg: 1 = large longitude and radius, 2 = longitude and radius,
+ *         3 = large latitude, 4 = latitude
+ */
+static void decode_pert_table(const short *pt, int nlines, int typflg, struct pert_term *tp)
+{
+  int i, m, j;
+  for (i = 0; i < nlines; i++, tp++) {
+    tp->nang = 0;
+    for (m = 0; m < 4; m++) {
       j = *pt++; /* multiple angle factor */
-      if( j ) {
-	k = j;
-	if( j < 0 ) k = -k; /* make angle factor > 0 */
-	/* sin, cos (k*angle) from lookup table */
-	su = ss[m][k-1];
-	cu = cc[m][k-1];
-	if( j < 0 ) su = -su; /* negative angle factor */
-	if( k1 == 0 ) {
-	  /* Set sin, cos of first angle. */
-	  sv = su;
-	  cv = cu;
-	  k1 = 1;
-	}
-	else {
-	  /* Combine angles by trigonometry. */
-	  ff =  su*cv + cu*sv;
-	  cv = cu*cv - su*sv;
-	  sv = ff;
-	}
-      }
+      if (j)
+	tp->iang[tp->nang++] = m * NSSCC + NMULT + j;
+    }
+    /* no angle: sin = cos = 0, from the unused entry of multiple 0 */
+    if (tp->nang == 0) {
+      tp->iang[0] = NMULT;
+      tp->nang = 1;
     }
-    /* Accumulate
-     */
-    switch( typflg ) {
-    /* large longitude and radius */
+    tp->ampl[1] = 0;
+    switch (typflg) {
     case 1:
-      j = *pt++;
-      k = *pt++;
-      ans[0] += (10000.0 * j  + k) * sv;
-      j = *pt++;
-      k = *pt++;
-      if( k ) ans[2] += (10000.0 * j  + k) * cv;
+      tp->ampl[0] = 10000.0 * pt[0] + pt[1];
+      if (pt[3]) tp->ampl[1] = 10000.0 * pt[2] + pt[3];
+      pt += 4;
       break;
-    /* longitude and radius */
     case 2:
-      j = *pt++;
-      k = *pt++;
-      ans[0] += j * sv;
-      ans[2] += k * cv;
+      tp->ampl[0] = pt[0];
+      tp->ampl[1] = pt[1];
+      pt += 2;
       break;
-    /* large latitude */
     case 3:
-      j = *pt++;
-      k = *pt++;
-      ans[1] += ( 10000.0*j + k)*sv;
+      tp->ampl[0] = 10000.0 * pt[0] + pt[1];
+      pt += 2;
       break;
-    /* latitude */
     case 4:
-      j = *pt++;
-      ans[1] += j * sv;
+      tp->ampl[0] = pt[0];
+      pt += 1;
       break;
     }
   }
 }
 
+/* Sum a perturbation table decoded by decode_pert_table().
+ * The sine and cosine of the argument of each line are computed
+ * in a first loop, the amplitudes are applied in a second one,
+ * separate for each table type.
+ */
+static void chewm(const struct pert_term *tp, int nlines, int typflg, double *ans)
+{
+  int i, m;
+  double cu, su, cv, sv, ff;
+  double svs[NLR], cvs[NLR];
+  const double *s = &ss[0][0], *c = &cc[0][0];
+  for (i = 0; i < nlines; i++) {
+    /* sin, cos of first angle */
+    sv = s[tp[i].iang[0]];
+    cv = c[tp[i].iang[0]];
+    for (m = 1; m < tp[i].nang; m++) {
+      /* Combine angles by trigonometry. */
+      su = s[tp[i].iang[m]];
+      cu = c[tp[i].iang[m]];
+      ff =  su*cv + cu*sv;
+      cv = cu*cv - su*sv;
+      sv = ff;
+    }
+    svs[i] = sv;
+    cvs[i] = cv;
+  }
+  /* Accumulate
+   */
+  switch( typflg ) {
+  /* longitude and radius */
+  case 1:
+  case 2:
+    for (i = 0; i < nlines; i++) {
+      ans[0] += tp[i].ampl[0] * svs[i];
+      ans[2] += tp[i].ampl[1] * cvs[i];
+    }
+    break;
+  /* latitude */
+  case 3:
+  case 4:
+    for (i = 0; i < nlines; i++)
+      ans[1] += tp[i].ampl[0] * svs[i];
+    break;
+  }
+}
+
 /* Prepare lookup table of sin and cos ( i*Lj )
- * for required multiple angles
+ * for required multiple angles, positive and negative
  */
 static void sscc(int k, double arg, int n )
 {
   double cu, su, cv, sv, s;
+  double *sp = ss[k] + NMULT, *cp = cc[k] + NMULT;
   int i;
   su = sin(arg);
   cu = cos(arg);
-  ss[k][0] = su;			/* sin(L) */
-  cc[k][0] = cu;			/* cos(L) */
+  sp[1] = su;			/* sin(L) */
+  sp[-1] = -su;
+  cp[1] = cp[-1] = cu;		/* cos(L) */
   sv = 2.0*su*cu;
   cv = cu*cu - su*su;
-  ss[k][1] = sv;			/* sin(2L) */
-  cc[k][1] = cv;
+  sp[2] = sv;			/* sin(2L) */
+  sp[-2] = -sv;
+  cp[2] = cp[-2] = cv;
   for( i=2; i<n; i++ ) {
     s =  su*cv + cu*sv;
     cv = cu*cv - su*sv;
     sv = s;
-    ss[k][i] = sv;		/* sin( i+1 L ) */
-    cc[k][i] = cv;
+    sp[i+1] = sv;		/* sin( i+1 L ) */
+    sp[-i-1] = -sv;
+    cp[i+1] = cp[-i-1] = cv;
   }
 }
 
@@ -126,30 +126,43 @@ static const struct plantbl *planets[] =
   &plu404
 };
 
-static TLS double ss[9][24];
-static TLS double cc[9][24];
+/* Sine and cosine of the multiples -NMULT ... NMULT of the mean
+ * longitudes of the planets, for one time T; index NMULT + multiple.
+ * They are the same for all planets. Two sets are kept, for a time
+ * and the time of the second position for speed, and the multiples of
+ * a mean longitude are computed up to the highest harmonic required so
+ * far (nmult[]).
+ */
+#define NMULT	24
+#define NSSCC	(2 * NMULT + 1)
+struct mosh_args {
+  double T;
+  int nmult[9];
+  double ss[9][NSSCC];
+  double cc[9][NSSCC];
+};
+static TLS struct mosh_args margs[2];
+static TLS int margs_last = 0;
 
-static void sscc (int k, double arg, int n);
+static struct mosh_args *get_mosh_args(double T, const struct plantbl *plan);
+static void sscc (struct mosh_args *ap, int k, double arg, int n);
 
 int swi_moshplan2 (double J, int iplm, double *pobj)
 {
-  int i, j, k, m, k1, ip, np, nt;
+  int j, ip, np, nt;
   signed char *p;
   double *pl, *pb, *pr;
   double su, cu, sv, cv, T;
   double t, sl, sb, sr;
+  const double *sp, *cp;
   const struct plantbl *plan = planets[iplm];
+  struct mosh_args *ap;
 
   T = (J - J2000) / TIMESCALE;
-  /* Calculate sin( i*MM ), etc. for needed multiple angles.  */
-  for (i = 0; i < 9; i++)
-    {
-      if ((j = plan->max_harmonic[i]) > 0)
-	{
-	  sr = (mods3600 (freqs[i] * T) + phases[i]) * STR;
-	  sscc (i, sr, j);
-	}
-    }
+  /* sin( i*MM ), etc. for needed multiple angles.  */
+  ap = get_mosh_args(T, plan);
+  sp = &ap->ss[0][NMULT];
+  cp = &ap->cc[0][NMULT];
 
   /* Point to start of table of arguments. */
   p = plan->arg_tbl;
@@ -194,38 +207,23 @@ int swi_moshplan2 (double J, int iplm, double *pobj)
 	  sr += cu;
 	  continue;
 	}
-      k1 = 0;
-      cv = 0.0;
-      sv = 0.0;
-      for (ip = 0; ip < np; ip++)
+      /* Harmonic and planet of each argument; the tables have no
+       * zero harmonics. sin(k*angle) and cos(k*angle) are taken from
+       * the lookup tables, negative k included. */
+      j = (p[1] - 1) * NSSCC + p[0];
+      p += 2;
+      sv = sp[j];	/* set first angle */
+      cv = cp[j];
+      for (ip = 1; ip < np; ip++)
 	{
-	  /* What harmonic.  */
-	  j = *p++;
-	  /* Which planet.  */
-	  m = *p++ - 1;
-	  if (j)
-	    {
-	      k = j;
-	      if (j < 0)
-		k = -k;
-	      k -= 1;
-	      su = ss[m][k];	/* sin(k*angle) */
-	      if (j < 0)
-		su = -su;
-	      cu = cc[m][k];
-	      if (k1 == 0)
-		{		/* set first angle */
-		  sv = su;
-		  cv = cu;
-		  k1 = 1;
-		}
-	      else
-		{		/* combine angles */
-		  t = su * cv + cu * sv;
-		  cv = cu * cv - su * sv;
-		  sv = t;
-		}
-	    }
+	  j = (p[1] - 1) * NSSCC + p[0];
+	  p += 2;
+	  su = sp[j];
+	  cu = cp[j];
+	  /* combine angles */
+	  t = su * cv + cu * sv;
+	  cv = cu * cv - su * sv;
+	  sv = t;
 	}
       /* Highest power of T.  */
       nt = *p++;
@@ -263,6 +261,34 @@ int swi_moshplan2 (double J, int iplm, double *pobj)
   return OK;
 }
 
+/* Lookup tables of sin and cos of the multiple angles for time T,
+ * computed up to the harmonics required by plan.
+ * The set for T is reused if it is one of the two last ones.
+ */
+static struct mosh_args *get_mosh_args(double T, const struct plantbl *plan)
+{
+  int i, n;
+  struct mosh_args *ap = &margs[margs_last];
+  if (ap->T != T) {
+    margs_last = 1 - margs_last;
+    ap = &margs[margs_last];
+    if (ap->T != T) {
+      ap->T = T;
+      for (i = 0; i < 9; i++)
+	ap->nmult[i] = 0;
+    }
+  }
+  for (i = 0; i < 9; i++)
+    {
+      if ((n = plan->max_harmonic[i]) > ap->nmult[i])
+	{
+	  sscc (ap, i, (mods3600 (freqs[i] * T) + phases[i]) * STR, n);
+	  ap->nmult[i] = n;
+	}
+    }
+  return ap;
+}
+
 /* Moshier ephemeris.
  * computes heliocentric cartesian equatorial coordinates of
  * equinox 2000
@@ -382,28 +408,32 @@ int swi_moshplan(double tjd, int ipli, AS_BOOL do_save, double *xpret, double *x
 
 
 /* Prepare lookup table of sin and cos ( i*Lj )
- * for required multiple angles
+ * for required multiple angles, positive and negative
  */
-static void sscc (int k, double arg, int n)
+static void sscc (struct mosh_args *ap, int k, double arg, int n)
 {
   double cu, su, cv, sv, s;
+  double *sp = &ap->ss[k][NMULT], *cp = &ap->cc[k][NMULT];
   int i;
 
   su = sin (arg);
   cu = cos (arg);
-  ss[k][0] = su;		/* sin(L) */
-  cc[k][0] = cu;		/* cos(L) */
+  sp[1] = su;			/* sin(L) */
+  sp[-1] = -su;
+  cp[1] = cp[-1] = cu;		/* cos(L) */
   sv = 2.0 * su * cu;
   cv = cu * cu - su * su;
-  ss[k][1] = sv;		/* sin(2L) */
-  cc[k][1] = cv;
+  sp[2] = sv;			/* sin(2L) */
+  sp[-2] = -sv;
+  cp[2] = cp[-2] = cv;
   for (i = 2; i < n; i++)
     {
       s = su * cv + cu * sv;
       cv = cu * cv - su * sv;
       sv = s;
-      ss[k][i] = sv;		/* sin( i+1 L ) */
-      cc[k][i] = cv;
+      sp[i+1] = sv;		/* sin( i+1 L ) */
+      sp[-i-1] = -sv;
+      cp[i+1] = cp[-i-1] = cv;
     }
 }
 
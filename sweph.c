@@ -61,6 +61,7 @@
 
 
 #include <string.h>
+#include <stddef.h>
 #include <ctype.h>
 #if MSDOS
 #include <tchar.h>
@@ -187,6 +188,12 @@ static const int pnoint2jpl[]   = PNOINT2JPL;
 static const int pnoext2int[] = {SEI_SUN, SEI_MOON, SEI_MERCURY, SEI_VENUS, SEI_MARS, SEI_JUPITER, SEI_SATURN, SEI_URANUS, SEI_NEPTUNE, SEI_PLUTO, 0, 0, 0, 0, SEI_EARTH, SEI_CHIRON, SEI_PHOLUS, SEI_CERES, SEI_PALLAS, SEI_JUNO, SEI_VESTA, };
 
 static int32 swecalc(double tjd, int ipl, int iplmoon, int32 iflag, double *x, char *serr);
+static int32 swe_calc_intern(double tjd, int ipl, int32 iflag, 
+		double *xx, double *xframes, char *serr);
+static void moshier_planets_one_pass(double tjd, int32 *ipl, int32 nbodies, int32 iflag);
+static int32 calc_all_frames(double tjd, double tjd_ut, int32 ipl, int32 iflag, 
+		double *geopos, double atpress, double attemp, 
+		double *xx, char *serr);
 static int do_fread(void *targ, int size, int count, int corrsize, 
 		    FILE *fp, int32 fpos, int freord, int fendian, int ifno, 
 		    char *serr);
@@ -220,14 +227,35 @@ static void nut_matrix(struct nut *nu, struct epsilon *oec);
 static void calc_epsilon(double tjd, int32 iflag, struct epsilon *e);
 static int lunar_osc_elem(double tjd, int ipl, int32 iflag, char *serr);
 static int intp_apsides(double tjd, int ipl, int32 iflag, char *serr); 
+static int lunfit_pos(double tjd, int ipl, int32 epheflag, double *xpol);
+static int open_lunfit_file(void);
+static void close_lunfit_file(void);
 static double meff(double r);
 static void denormalize_positions(double *x0, double *x1, double *x2);
 static void calc_speed(double *x0, double *x1, double *x2, double dt);
 static int32 plaus_iflag(int32 iflag, int32 ipl, double tjd, char *serr);
+static int32 calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag, double *xxctr, double *xxipl, double *xxret, char *serr);
+static void ast_pool_swap(int ipli);
+static void close_ast_pool(AS_BOOL do_free);
+static void file_park_swap(int ifno, int ipli, double tjd);
+static void close_file_park(void);
+static void free_plan_file_data(struct plan_data *pdp);
+static int preload_segments(int ifno, char *serr);
 static int app_pos_rest(struct plan_data *pdp, int32 iflag, 
     double *xx, double *x2000, struct epsilon *oe, char *serr);
 static int open_jpl_file(double *ss, char *fname, char *fpath, char *serr);
 static void free_planets(void);
+static void close_sweph_files(void);
+static void free_positions(void);
+static struct save_positions *get_save_positions(double tjd, int ipl, int32 iflgkey);
+static void save_positions(double tjd, int ipl, int32 iflgkey, int32 iflgret, double *xsaves);
+static void clear_save_positions(void);
+static void force_app_pos(void);
+static AS_BOOL is_star_ayanamsa(int sid_mode);
+static int32 get_ayanamsa_star(double tjd_et, int sid_mode, int32 iflag, double *daya, char *serr);
+static int32 get_ayanamsa_star_cached(double tjd_et, int sid_mode, int32 iflag, double *daya, char *serr);
+static void fit_aya_segment(struct aya_segment *ap);
+static void chebyshev_fit(double *f, int n, double *coef);
 
 #ifdef TRACE
 static void trace_swe_calc(int param, double tjd, int ipl, int32 iflag, double *xx, char *serr);
@@ -313,13 +341,22 @@ char *CALL_CONV swe_get_library_path(char *s)
  */
 int32 CALL_CONV swe_calc(double tjd, int ipl, int32 iflag, 
 	double *xx, char *serr) 
+{
+  return swe_calc_intern(tjd, ipl, iflag, xx, NULL, serr);
+}
+
+/* swe_calc(); if xframes != NULL, the complete save area with all
+ * coordinate frames (24 doubles, see struct save_positions) is 
+ * copied into it */
+static int32 swe_calc_intern(double tjd, int ipl, int32 iflag, 
+	double *xx, double *xframes, char *serr) 
 {
   int i, j;
-  int32 iplmoon = 0, iflgsave = iflag;
+  int32 iplmoon = 0, iflgsave = iflag, iflgkey, iflgret;
   int32 epheflag;
   AS_BOOL use_speed3 = FALSE;
   struct save_positions *sd;
-  double x[6], *xs, x0[24], x2[24];
+  double x[6], *xs, x0[24], x2[24], xsaves[24], *xsv;
   double dt;
   if (serr != NULL) 
     *serr = '\0';
@@ -388,20 +425,9 @@ int32 CALL_CONV swe_calc(double tjd, int ipl, int32 iflag,
     strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_calc() or swe_calc_ut()");
   }
   if (swed.last_epheflag != epheflag) {
-    free_planets();
-    /* close and free ephemeris files */
-    if (ipl != SE_ECL_NUT) {  /* because file will not be reopened with this ipl */
-      if (swed.jpl_file_is_open) {
-	swi_close_jpl_file();
-	swed.jpl_file_is_open = FALSE;
-      }
-      for (i = 0; i < SEI_NEPHFILES; i ++) {
-	if (swed.fidat[i].fptr != NULL) 
-	  fclose(swed.fidat[i].fptr);
-	memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
-      }
-      swed.last_epheflag = epheflag;
-    }
+    /* ephemeris files remain open, see free_positions() */
+    free_positions();
+    swed.last_epheflag = epheflag;
   }
   /* high precision speed prevails fast speed */
   if ((iflag & SEFLG_SPEED3) && (iflag & SEFLG_SPEED))
@@ -439,47 +465,41 @@ int32 CALL_CONV swe_calc(double tjd, int ipl, int32 iflag,
   }
   if ((iflag & SEFLG_CENTER_BODY) || iplmoon > 0)
     swi_force_app_pos_etc();
-  /* pointer to save area */
-  if (ipl < SE_NPLANETS && ipl >= SE_SUN) {
-    sd = &swed.savedat[ipl];
-//    if (iflag & SEFLG_CENTER_BODY)
-//      sd = &swed.savedat[SE_NPLANETS];
-  } else {
-    /* other bodies, e.g. asteroids called with ipl = SE_AST_OFFSET + MPC# */
-    sd = &swed.savedat[SE_NPLANETS];
-  }
   /* 
-   * if position is available in save area, it is returned.
-   * this is the case, if tjd = tsave and iflag = iflgsave.
+   * if position is available in the position cache, it is returned.
+   * this is the case, if tjd, ipl and the requested flags are the 
+   * same as with an earlier call.
    * coordinate flags can be neglected, because save area 
    * provides all coordinate types.
-   * if ipl > SE_AST(EROID)_OFFSET, ipl must be checked, 
-   * because all asteroids called by MPC number share the same
-   * save area.
+   * planetary moons are not saved.
+   * obliquity and nutation of date are updated as with a new
+   * computation, because some callers use them after swe_calc().
    */ 
-  if (sd->tsave == tjd && tjd != 0 && ipl == sd->ipl && iplmoon == 0) {
-    if ((sd->iflgsave & ~SEFLG_COORDSYS) == (iflag & ~SEFLG_COORDSYS)) 
-      goto end_swe_calc;
+  iflgkey = (iflag & ~(SEFLG_COORDSYS | SEFLG_EPHMASK)) | epheflag;
+  if (iplmoon == 0 
+    && (sd = get_save_positions(tjd, ipl, iflgkey)) != NULL) {
+    xsv = sd->xsaves;
+    iflgret = sd->iflgsave;
+    swi_check_ecliptic(tjd, iflgret);
+    swi_check_nutation(tjd, iflgret);
+    goto end_swe_calc;
   }
   /* 
    * otherwise, new position must be computed 
    */
+  xsv = xsaves;
   if (!use_speed3) {
     /* 
      * with high precision speed from one call of swecalc() 
      * (FAST speed)
      */
-    sd->tsave = tjd;
-    sd->ipl = ipl;
-    if ((sd->iflgsave = swecalc(tjd, ipl, iplmoon, iflag, sd->xsaves, serr)) == ERR) 
+    if ((iflgret = swecalc(tjd, ipl, iplmoon, iflag, xsv, serr)) == ERR) 
       goto return_error;
   } else {
     /* 
      * with speed from three calls of swecalc(), slower and less accurate.
      * (SLOW speed, for test only)
      */
-    sd->tsave = tjd;
-    sd->ipl = ipl;
     switch(ipl) {
       case SE_MOON:
 	dt = MOON_SPEED_INTV;
@@ -498,20 +518,24 @@ int32 CALL_CONV swe_calc(double tjd, int ipl, int32 iflag,
 	dt = PLAN_SPEED_INTV;
 	break;
     } 
-    if ((sd->iflgsave = swecalc(tjd-dt, ipl, iplmoon, iflag, x0, serr)) == ERR)
+    if ((iflgret = swecalc(tjd-dt, ipl, iplmoon, iflag, x0, serr)) == ERR)
       goto return_error; 
-    if ((sd->iflgsave = swecalc(tjd+dt, ipl, iplmoon, iflag, x2, serr)) == ERR)
+    if ((iflgret = swecalc(tjd+dt, ipl, iplmoon, iflag, x2, serr)) == ERR)
       goto return_error; 
-    if ((sd->iflgsave = swecalc(tjd, ipl, iplmoon, iflag, sd->xsaves, serr)) == ERR)
+    if ((iflgret = swecalc(tjd, ipl, iplmoon, iflag, xsv, serr)) == ERR)
       goto return_error; 
-    denormalize_positions(x0, sd->xsaves, x2);
-    calc_speed(x0, sd->xsaves, x2, dt);
+    denormalize_positions(x0, xsv, x2);
+    calc_speed(x0, xsv, x2, dt);
   }
+  /* positions are not saved, if the ephemeris requested was not 
+   * available, so that the next call tries again */
+  if (iplmoon == 0 && (iflgret & SEFLG_EPHMASK) == epheflag)
+    save_positions(tjd, ipl, iflgkey, iflgret, xsv);
   end_swe_calc:
   if (iflag & SEFLG_EQUATORIAL) {
-    xs = sd->xsaves+12;	/* equatorial coordinates */
+    xs = xsv+12;	/* equatorial coordinates */
   } else {
-    xs = sd->xsaves;	/* ecliptic coordinates */
+    xs = xsv;	/* ecliptic coordinates */
   }
   if (iflag & SEFLG_XYZ)
     xs = xs+6;		/* cartesian coordinates */
@@ -544,9 +568,13 @@ int32 CALL_CONV swe_calc(double tjd, int ipl, int32 iflag,
 #endif
   for (i = 0; i <= 5; i++)
     xx[i] = x[i];
+  if (xframes != NULL) {
+    for (i = 0; i < 24; i++)
+      xframes[i] = xsv[i];
+  }
   //iflag = sd->iflgsave | (iflag & SEFLG_COORDSYS);
   // iflag from previous call of swe_calc(), without coordinate system flags
-  iflag = sd->iflgsave & ~SEFLG_COORDSYS; 
+  iflag = iflgret & ~SEFLG_COORDSYS; 
   // add correct coordinate system flags
   iflag |= (iflgsave & SEFLG_COORDSYS); 
   /* if no ephemeris has been specified, do not return chosen ephemeris */
@@ -559,6 +587,10 @@ int32 CALL_CONV swe_calc(double tjd, int ipl, int32 iflag,
 return_error:
   for (i = 0; i <= 5; i++)
     xx[i] = 0;
+  if (xframes != NULL) {
+    for (i = 0; i < 24; i++)
+      xframes[i] = 0;
+  }
 #ifdef TRACE
   trace_swe_calc(2, tjd, ipl, iflag, xx, serr);
 #endif
@@ -587,6 +619,244 @@ int32 CALL_CONV swe_calc_ut(double tjd_ut, int32 ipl, int32 iflag,
   return retval;
 }
 
+/* computes several bodies for the same time with one call.
+ * xx must have room for 6 * nbodies doubles; the position and speed
+ * of body i are in xx[6*i] ... xx[6*i+5], as swe_calc() returns them.
+ * iflgret, if not NULL, receives the return flag of each body.
+ * With the Moshier ephemeris, the geometric positions of the earth
+ * and the planets are computed first, in one pass, so that they share
+ * the tables of the mean longitudes (see swemplan.c). The results are
+ * the same as with a call of swe_calc() for each body.
+ * If a body fails, its values are 0, the other bodies are computed,
+ * and ERR is returned with the first error message; otherwise OK.
+ */
+int32 CALL_CONV swe_calc_bodies(double tjd, int32 *ipl, int32 nbodies, int32 iflag, 
+	double *xx, int32 *iflgret, char *serr)
+{
+  int i, j;
+  int32 retflag, retval = OK;
+  char serr1[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  moshier_planets_one_pass(tjd, ipl, nbodies, iflag);
+  for (i = 0; i < nbodies; i++) {
+    *serr1 = '\0';
+    retflag = swe_calc(tjd, ipl[i], iflag, xx + 6 * i, serr1);
+    if (retflag == ERR) {
+      for (j = 0; j < 6; j++)
+	xx[6 * i + j] = 0;
+      if (retval != ERR && serr != NULL)
+	strcpy(serr, serr1);
+      retval = ERR;
+    }
+    if (iflgret != NULL)
+      iflgret[i] = retflag;
+  }
+  return retval;
+}
+
+int32 CALL_CONV swe_calc_bodies_ut(double tjd_ut, int32 *ipl, int32 nbodies, int32 iflag, 
+	double *xx, int32 *iflgret, char *serr)
+{
+  int i, j;
+  int32 retflag, retval = OK;
+  char serr1[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  if (iflag & SEFLG_MOSEPH)
+    moshier_planets_one_pass(tjd_ut + swe_deltat_ex(tjd_ut, SEFLG_MOSEPH, NULL), ipl, nbodies, iflag);
+  for (i = 0; i < nbodies; i++) {
+    *serr1 = '\0';
+    retflag = swe_calc_ut(tjd_ut, ipl[i], iflag, xx + 6 * i, serr1);
+    if (retflag == ERR) {
+      for (j = 0; j < 6; j++)
+	xx[6 * i + j] = 0;
+      if (retval != ERR && serr != NULL)
+	strcpy(serr, serr1);
+      retval = ERR;
+    }
+    if (iflgret != NULL)
+      iflgret[i] = retflag;
+  }
+  return retval;
+}
+
+/* Moshier ephemeris: geometric positions of the earth and of the
+ * planets in ipl[] for tjd, computed into the save area as
+ * main_planet() would do it. Consecutive calls of swi_moshplan2()
+ * for the same time share the sine and cosine tables of the mean
+ * longitudes, while the apparent positions, which need other times
+ * (light-time), would use them up in between.
+ */
+static void moshier_planets_one_pass(double tjd, int32 *ipl, int32 nbodies, int32 iflag)
+{
+  int i, ipli;
+  iflag = plaus_iflag(iflag, SE_SUN, tjd, NULL);
+  if (!(iflag & SEFLG_MOSEPH) || (iflag & SEFLG_BARYCTR))
+    return;
+  if (tjd < MOSHPLEPH_START || tjd > MOSHPLEPH_END)
+    return;
+  swi_check_ecliptic(tjd, iflag);
+  if (swi_moshplan(tjd, SEI_EARTH, DO_SAVE, NULL, NULL, NULL) != OK)
+    return;
+  for (i = 0; i < nbodies; i++) {
+    if (ipl[i] < SE_MERCURY || ipl[i] > SE_PLUTO)
+      continue;
+    ipli = pnoext2int[ipl[i]];
+    swi_moshplan(tjd, ipli, DO_SAVE, NULL, NULL, NULL);
+  }
+}
+
+/* computes a body in all coordinate frames with one call.
+ * xx must have room for SE_NFRAME_VALUES doubles; each frame consists
+ * of 6 values, position and speed:
+ * xx + SE_FRAME_ECL      ecliptic, polar
+ * xx + SE_FRAME_ECL_XYZ  ecliptic, cartesian
+ * xx + SE_FRAME_EQU      equatorial, polar
+ * xx + SE_FRAME_EQU_XYZ  equatorial, cartesian
+ * xx + SE_FRAME_SID      sidereal ecliptic, polar, if SEFLG_SIDEREAL
+ * xx + SE_FRAME_HOR      azimuth, true altitude, apparent altitude,
+ *                        and their speeds, if geopos != NULL
+ * The first four frames are tropical and are returned as one 
+ * computation of swe_calc() provides them. Frames that are not 
+ * requested are 0. SEFLG_EQUATORIAL and SEFLG_XYZ are ignored. 
+ * For the horizontal frame, geopos, atpress and attemp are used 
+ * as with swe_azalt(); it requires the equator of date, i.e. 
+ * no SEFLG_J2000 or SEFLG_NONUT.
+ * The return value is the same as with swe_calc().
+ */
+int32 CALL_CONV swe_calc_all_frames(double tjd, int32 ipl, int32 iflag, 
+	double *geopos, double atpress, double attemp, 
+	double *xx, char *serr)
+{
+  double tjd_ut;
+  tjd_ut = tjd - swe_deltat_ex(tjd - swe_deltat_ex(tjd, iflag, NULL), iflag, NULL);
+  return calc_all_frames(tjd, tjd_ut, ipl, iflag, geopos, atpress, attemp, xx, serr);
+}
+
+int32 CALL_CONV swe_calc_all_frames_ut(double tjd_ut, int32 ipl, int32 iflag, 
+	double *geopos, double atpress, double attemp, 
+	double *xx, char *serr)
+{
+  double deltat;
+  int32 retval = OK;
+  int32 epheflag = 0;
+  int32 iflgsid = iflag & SEFLG_SIDEREAL;
+  /* SEFLG_SIDEREAL would imply SEFLG_NONUT for the tropical frames */
+  iflag = plaus_iflag(iflag & ~SEFLG_SIDEREAL, ipl, tjd_ut, serr) | iflgsid;
+  epheflag = iflag & SEFLG_EPHMASK;
+  if (epheflag == 0) {
+    epheflag = SEFLG_SWIEPH;
+    iflag |= SEFLG_SWIEPH;
+  }
+  deltat = swe_deltat_ex(tjd_ut, iflag, serr);
+  retval = calc_all_frames(tjd_ut + deltat, tjd_ut, ipl, iflag, geopos, atpress, attemp, xx, serr);
+  /* if ephe required is not ephe returned, adjust delta t: */
+  if (retval != ERR && (retval & SEFLG_EPHMASK) != epheflag) {
+    deltat = swe_deltat_ex(tjd_ut, retval, NULL);
+    retval = calc_all_frames(tjd_ut + deltat, tjd_ut, ipl, iflag, geopos, atpress, attemp, xx, NULL);
+  }
+  return retval;
+}
+
+static int32 calc_all_frames(double tjd, double tjd_ut, int32 ipl, int32 iflag, 
+	double *geopos, double atpress, double attemp, 
+	double *xx, char *serr)
+{
+  int i, j;
+  int32 retflag, iflgsid;
+  AS_BOOL do_radians;
+  double x[6], daya[2], xin[3], xaz[3], xaz1[3], xaz2[3];
+  double *xp, armc, dt = HOR_SPEED_INTV;
+  struct epsilon *oe;
+  for (i = 0; i < SE_NFRAME_VALUES; i++)
+    xx[i] = 0;
+  do_radians = (iflag & SEFLG_RADIANS) != 0;
+  iflgsid = iflag & SEFLG_SIDEREAL;
+  iflag &= ~(SEFLG_COORDSYS | SEFLG_RADIANS | SEFLG_SIDEREAL);
+  /* the four frames of the save area of swe_calc() */
+  retflag = swe_calc_intern(tjd, ipl, iflag, x, xx, serr);
+  if (retflag == ERR || ipl == SE_ECL_NUT)
+    return retflag;
+  /* sidereal ecliptic */
+  if (iflgsid) {
+    if (!swed.ayana_is_set)
+      swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY, 0, 0);
+    xp = xx + SE_FRAME_SID;
+    if (swed.sidd.sid_mode & (SE_SIDBIT_ECL_T0 | SE_SIDBIT_SSY_PLANE)) {
+      /* projection onto another plane, a complete computation */
+      if (swe_calc_intern(tjd, ipl, iflag | SEFLG_SIDEREAL, xp, NULL, serr) == ERR)
+        return ERR;
+    } else {
+      /* traditional algorithm, as in app_pos_rest(): mean ecliptic 
+       * of date (sidereal positions are without nutation) minus ayanamsa */
+      for (i = 0; i <= 5; i++)
+        x[i] = xx[SE_FRAME_EQU_XYZ + i];
+      if (!(iflag & SEFLG_NONUT))
+        swi_nutate(x, retflag, TRUE);
+      if (iflag & SEFLG_J2000)
+        oe = &swed.oec2000;
+      else
+        oe = &swed.oec;
+      swi_coortrf2(x, x, oe->seps, oe->ceps);
+      if (iflag & SEFLG_SPEED)
+        swi_coortrf2(x+3, x+3, oe->seps, oe->ceps);
+      swi_cartpol_sp(x, xp);
+      /* the ayanamsa may disturb the nutation of date, therefore now */
+      if (swi_get_ayanamsa_with_speed(tjd, retflag, daya, serr) == ERR)
+        return ERR;
+      xp[0] = swe_degnorm(xp[0] * RADTODEG - daya[0]);
+      xp[1] *= RADTODEG;
+      if (iflag & SEFLG_SPEED) {
+        xp[3] = xp[3] * RADTODEG - daya[1];
+        xp[4] *= RADTODEG;
+      }
+      /* the true node has no latitude, see swecalc() */
+      if (ipl == SE_TRUE_NODE) 
+        xp[1] = xp[4] = 0;
+    }
+    retflag |= SEFLG_SIDEREAL;
+  }
+  /* horizontal coordinates as with swe_azalt(); speeds from positions 
+   * at t - dt and t + dt, with sidereal time at t */
+  if (geopos != NULL) {
+    xp = xx + SE_FRAME_HOR;
+    armc = swe_degnorm(swe_sidtime(tjd_ut) * 15 + geopos[0]);
+    for (i = 0; i <= 2; i++)
+      xin[i] = xx[SE_FRAME_EQU + i];
+    swi_equ2hor_armc(armc, geopos, atpress, attemp, xin, xaz);
+    for (i = 0; i <= 2; i++)
+      xp[i] = xaz[i];
+    if (iflag & SEFLG_SPEED) {
+      for (i = 0; i <= 2; i++)
+        xin[i] = xx[SE_FRAME_EQU + i] - dt * xx[SE_FRAME_EQU + 3 + i];
+      swi_equ2hor_armc(armc - dt * ARMC_SPEED, geopos, atpress, attemp, xin, xaz1);
+      for (i = 0; i <= 2; i++)
+        xin[i] = xx[SE_FRAME_EQU + i] + dt * xx[SE_FRAME_EQU + 3 + i];
+      swi_equ2hor_armc(armc + dt * ARMC_SPEED, geopos, atpress, attemp, xin, xaz2);
+      xp[3] = swe_difdeg2n(xaz2[0], xaz1[0]) / dt / 2;
+      xp[4] = (xaz2[1] - xaz1[1]) / dt / 2;
+      xp[5] = (xaz2[2] - xaz1[2]) / dt / 2;
+    }
+  }
+  if (do_radians) {
+    /* longitudes and latitudes of the polar frames */
+    for (j = SE_FRAME_ECL; j <= SE_FRAME_SID; j += 6) {
+      if (j == SE_FRAME_ECL_XYZ || j == SE_FRAME_EQU_XYZ)
+        continue;
+      xx[j] *= DEGTORAD;
+      xx[j+1] *= DEGTORAD;
+      xx[j+3] *= DEGTORAD;
+      xx[j+4] *= DEGTORAD;
+    }
+    /* all values of the horizontal frame are angles */
+    for (i = 0; i <= 5; i++)
+      xx[SE_FRAME_HOR + i] *= DEGTORAD;
+    retflag |= SEFLG_RADIANS;
+  }
+  return retflag;
+}
+
 static int32 swecalc(double tjd, int ipl, int32 iplmoon, int32 iflag, double *x, char *serr) 
 {
   int i;
@@ -668,6 +938,8 @@ static int32 swecalc(double tjd, int ipl, int32 iplmoon, int32 iflag, double *x,
     /*if ((iflag & SEFLG_RADIANS) == 0)*/
       for (i = 0; i <= 3; i++)
 	x[i] *= RADTODEG;
+    for (i = 4; i < 24; i++)
+      x[i] = 0;
     return(iflag);
   /****************************************** 
    * moon                                   * 
@@ -1199,16 +1471,10 @@ static void free_planets(void)
   int i;
   /* free planets data space */
   for (i = 0; i < SEI_NPLANETS; i++) {
-    if (swed.pldat[i].segp != NULL) {
-      free((void *) swed.pldat[i].segp);
-    }
-    if (swed.pldat[i].refep != NULL) {
-      free((void *) swed.pldat[i].refep);
-    }
+    free_plan_file_data(&swed.pldat[i]);
     memset((void *) &swed.pldat[i], 0, sizeof(struct plan_data));
   }
-  for (i = 0; i <= SE_NPLANETS; i++) /* "<=" is correct! see decl. */
-    memset((void *) &swed.savedat[i], 0, sizeof(struct save_positions));
+  clear_save_positions();
   /* clear node data space */
   for (i = 0; i < SEI_NNODE_ETC; i++) {
 #if 0
@@ -1219,6 +1485,38 @@ static void free_planets(void)
   }
 }
 
+/* Discards the computed positions of all bodies, but not the ephemeris
+ * data (open files, constants and unpacked segments of the Swiss
+ * Ephemeris, the JPL file). 
+ * This is done when the ephemeris flag changes from one call to the next.
+ * The SWIEPH, JPLEPH and MOSEPH data do not overlap, so each ephemeris 
+ * keeps its files and segments, and switching between them costs only 
+ * the recomputation of the positions. Some of the saved positions (e.g. 
+ * those of the JPL earth and sun) are reused without testing iephe, 
+ * and Moshier uses the barycentric sun as left by free_planets(),
+ * therefore they must be discarded the same way. */
+static void free_positions(void)
+{
+  int i;
+  struct plan_data *pdp;
+  for (i = 0; i < SEI_NPLANETS; i++) {
+    pdp = &swed.pldat[i];
+    pdp->teval = 0;
+    pdp->iephe = 0;
+    pdp->xflgs = 0;
+    memset((void *) pdp->x, 0, sizeof(pdp->x));
+    memset((void *) pdp->xreturn, 0, sizeof(pdp->xreturn));
+  }
+  clear_save_positions();
+  for (i = 0; i < SEI_NNODE_ETC; i++)
+    memset((void *) &swed.nddat[i], 0, sizeof(struct plan_data));
+  /* sweph() deletes messages at the next use of a file, as when the
+   * files were closed at a change of the ephemeris flag and opened again */
+  for (i = 0; i < SEI_NEPHFILES; i++)
+    if (swed.fidat[i].fptr != NULL)
+      swed.fidat[i].kept_open = TRUE;
+}
+
 /* Function initialises swed structure. 
  * Returns 1 if initialisation is done, otherwise 0 */
 int32 swi_init_swed_if_start(void)
@@ -1235,19 +1533,30 @@ int32 swi_init_swed_if_start(void)
   return 0;
 }
 
-/* closes all open files, frees space of planetary data, 
+/* closes the Swiss Ephemeris files, also those of the file park
+ * and of the asteroid pool, frees space of planetary data, 
  * deletes memory of all computed positions 
  */
-static void swi_close_keep_topo_etc(void) 
+static void close_sweph_files(void) 
 {
   int i;
-  /* close SWISSEPH files */
   for (i = 0; i < SEI_NEPHFILES; i ++) {
     if (swed.fidat[i].fptr != NULL) 
       fclose(swed.fidat[i].fptr);
     memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
   }
+  close_file_park();
+  close_ast_pool(FALSE);
   free_planets();
+}
+
+/* closes all open files, frees space of planetary data, 
+ * deletes memory of all computed positions 
+ */
+static void swi_close_keep_topo_etc(void) 
+{
+  /* close SWISSEPH files */
+  close_sweph_files();
   memset((void *) &swed.oec, 0, sizeof(struct epsilon));
   memset((void *) &swed.oec2000, 0, sizeof(struct epsilon));
   memset((void *) &swed.nut, 0, sizeof(struct nut));
@@ -1263,6 +1572,7 @@ static void swi_close_keep_topo_etc(void)
     fclose(swed.fixfp);
     swed.fixfp = NULL;
   }
+  close_lunfit_file();
   swe_set_tid_acc(SE_TIDAL_AUTOMATIC);
   swed.is_old_starfile = FALSE;
   swed.i_saved_planet_name = 0;
@@ -1282,6 +1592,8 @@ void CALL_CONV swe_close(void)
       fclose(swed.fidat[i].fptr);
     memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
   }
+  close_file_park();
+  close_ast_pool(TRUE);
   free_planets();
   memset((void *) &swed.oec, 0, sizeof(struct epsilon));
   memset((void *) &swed.oec2000, 0, sizeof(struct epsilon));
@@ -1298,6 +1610,7 @@ void CALL_CONV swe_close(void)
     fclose(swed.fixfp);
     swed.fixfp = NULL;
   }
+  close_lunfit_file();
   swe_set_tid_acc(SE_TIDAL_AUTOMATIC);
   swed.geopos_is_set = FALSE;
   swed.ayana_is_set = FALSE;
@@ -1316,6 +1629,11 @@ void CALL_CONV swe_close(void)
     free(swed.deps);
     swed.deps = NULL;
   }
+  if (swed.savedat != NULL) {
+    free(swed.savedat);
+    swed.savedat = NULL;
+    swed.nsavedat = 0;
+  }
   if (swed.n_fixstars_records > 0) {
     free(swed.fixed_stars);
     swed.fixed_stars = NULL;
@@ -2210,9 +2528,18 @@ static int sweph(double tjd, int ipli, int ifno, int32 iflag, double *xsunb, AS_
 	xpret[i] = pdp->x[i];
     return(OK);
   }
+  /* another asteroid than the one in the file slot: park that one
+   * and take the wanted one from the pool, if it is there */
+  if (ipl == SEI_ANYBODY && ifno == SEI_FILE_ANY_AST && ipli != pdp->ibdy)
+    ast_pool_swap(ipli);
   /****************************** 
    * get correct ephemeris file * 
    ******************************/
+  /* tjd beyond file range: keep the file open for later and take the 
+   * file of tjd, if it was open before */
+  if (ipl != SEI_ANYBODY 
+    && (fdp->fptr == NULL || tjd < fdp->tfstart || tjd > fdp->tfend))
+    file_park_swap(ifno, ipli, tjd);
   if (fdp->fptr != NULL) {
     /* if tjd is beyond file range, close old file.
      * if new asteroid, close old file. */
@@ -2280,7 +2607,17 @@ again:
     retc = read_const(ifno, serr);
     if (retc != OK)
       return(retc);
+    if (swed.preload_tjd1 > swed.preload_tjd0 && ipl != SEI_ANYBODY) {
+      retc = preload_segments(ifno, serr);
+      if (retc != OK)
+	return(retc);
+    }
+  } else if (fdp->kept_open) {
+    /* first use after a change of the ephemeris flag: messages, e.g. 
+     * of a missing JPL file, are deleted as when the file is opened */
+    if (serr != NULL) *serr = '\0';
   }
+  fdp->kept_open = FALSE;
   /* if first ephemeris file (J-3000), it might start a mars period
    * after -3000. if last ephemeris file (J3000), it might end a
    * 4000-day-period before 3000. */
@@ -2321,15 +2658,26 @@ again:
    ******************************/
   /* get new segment, if necessary */
   if (pdp->segp == NULL || tjd < pdp->tseg0 || tjd > pdp->tseg1) {
-    retc = get_new_segment(tjd, ipl, ifno, serr);
-    if (retc != OK)
-      return(retc);
-    /* rotate cheby coeffs back to equatorial system.
-     * if necessary, add reference orbit. */
-    if (pdp->iflg & SEI_FLG_ROTATE)
-      rot_back(ipl); /**/
-    else
-      pdp->neval = pdp->ncoe;
+    int32 iseg = (int32) ((tjd - pdp->tfstart) / pdp->dseg) - pdp->preiseg0;
+    if (pdp->preseg != NULL && iseg >= 0 && iseg < pdp->npreseg
+      && (pdp->segp != NULL 
+	|| (pdp->segp = (double *) malloc((size_t) pdp->ncoe * 3 * 8)) != NULL)) {
+      /* segment was preloaded */
+      memcpy((void *) pdp->segp, (void *) (pdp->preseg + iseg * 3 * pdp->ncoe), (size_t) pdp->ncoe * 3 * 8);
+      pdp->tseg0 = pdp->tfstart + (iseg + pdp->preiseg0) * pdp->dseg;
+      pdp->tseg1 = pdp->tseg0 + pdp->dseg;
+      pdp->neval = pdp->preneval[iseg];
+    } else {
+      retc = get_new_segment(tjd, ipl, ifno, serr);
+      if (retc != OK)
+	return(retc);
+      /* rotate cheby coeffs back to equatorial system.
+       * if necessary, add reference orbit. */
+      if (pdp->iflg & SEI_FLG_ROTATE)
+	rot_back(ipl); /**/
+      else
+	pdp->neval = pdp->ncoe;
+    }
   }
   /* evaluate chebyshew polynomial for tjd */
   t = (tjd - pdp->tseg0) / pdp->dseg;
@@ -2992,8 +3340,12 @@ void CALL_CONV swe_set_sid_mode(int32 sid_mode, double t0, double ayan_t0)
       default:
         break;
     }
+    /* all positions depend on precession and nutation models */
+    clear_save_positions();
   }
-  swi_force_app_pos_etc();
+  /* sidereal positions in the position cache of swe_calc() are saved 
+   * with the sidereal mode */
+  force_app_pos();
 }
 
 int32 CALL_CONV swe_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
@@ -3066,56 +3418,39 @@ static int get_aya_correction(int iflag, double *corr, char *serr) {
   return OK;
 }
 
-int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
+/* ayanamshas that are derived from the position of a star or of the
+ * galactic pole or centre */
+static AS_BOOL is_star_ayanamsa(int sid_mode)
 {
-  double x[6], eps, t0, corr;
-  struct sid_data *sip = &swed.sidd;
-  char star[AS_MAXCH];
-  int32 epheflag, otherflag, retflag, iflag_true, iflag_galequ;
-  int sid_mode = sip->sid_mode;
-  iflag = plaus_iflag(iflag, -1, tjd_et, serr);
-  epheflag = iflag & SEFLG_EPHMASK;
-  otherflag = iflag & ~SEFLG_EPHMASK;
-  *daya = 0.0;
-  iflag &= SEFLG_EPHMASK;
-  iflag |= SEFLG_NONUT;
-  sid_mode %= SE_SIDBITS;
-  /* ayanamshas based on the intersection point of galactic equator and
-   * ecliptic always need SEFLG_TRUEPOS, because position of galactic
-   * pole is required without aberration or light deflection */
-  iflag_galequ = iflag | SEFLG_TRUEPOS;
-#if 1
-  /* _TRUE_ ayanamshas can have the following SEFLG_s;
-   * The star will have the intended fixed position even if these flags are 
-   * provided */
-  iflag_true = iflag;
-  if (otherflag & SEFLG_TRUEPOS) iflag_true |= SEFLG_TRUEPOS;
-  if (otherflag & SEFLG_NOABERR) iflag_true |= SEFLG_NOABERR;
-  if (otherflag & SEFLG_NOGDEFL) iflag_true |= SEFLG_NOGDEFL;
-#endif
-  /* warning, if swe_set_ephe_path() or swe_set_jplfile() was not called yet,
-   * although ephemeris files are required */
-  if (swi_init_swed_if_start() == 1 && !(epheflag & SEFLG_MOSEPH) 
-     && (sid_mode ==  SE_SIDM_TRUE_CITRA 
-      || sid_mode == SE_SIDM_TRUE_REVATI 
-      || sid_mode == SE_SIDM_TRUE_PUSHYA 
-      || sip->sid_mode == SE_SIDM_TRUE_SHEORAN 
-      || sid_mode == SE_SIDM_TRUE_MULA 
-      || sid_mode == SE_SIDM_GALCENT_0SAG
-      || sid_mode == SE_SIDM_GALCENT_COCHRANE
-      || sid_mode == SE_SIDM_GALCENT_RGILBRAND 
-      || sid_mode == SE_SIDM_GALCENT_MULA_WILHELM
-      || sid_mode == SE_SIDM_GALEQU_IAU1958 
-      || sid_mode == SE_SIDM_GALEQU_TRUE
-      || sid_mode == SE_SIDM_GALEQU_MULA) 
-      && serr != NULL) {
-    strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_get_ayanamsa_ex()");
+  switch (sid_mode) {
+    case SE_SIDM_TRUE_CITRA:
+    case SE_SIDM_TRUE_REVATI:
+    case SE_SIDM_TRUE_PUSHYA:
+    case SE_SIDM_TRUE_SHEORAN:
+    case SE_SIDM_TRUE_MULA:
+    case SE_SIDM_GALCENT_0SAG:
+    case SE_SIDM_GALCENT_COCHRANE:
+    case SE_SIDM_GALCENT_RGILBRAND:
+    case SE_SIDM_GALCENT_MULA_WILHELM:
+    case SE_SIDM_GALEQU_IAU1958:
+    case SE_SIDM_GALEQU_TRUE:
+    case SE_SIDM_GALEQU_MULA:
+      return TRUE;
+    default:
+      return FALSE;
   }
-  if (!swed.ayana_is_set)
-    swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY, 0, 0);
+}
+
+/* computes an ayanamsha that is derived from a star or from the galactic
+ * pole or centre; iflag = flags for swe_fixstar() */
+static int32 get_ayanamsa_star(double tjd_et, int sid_mode, int32 iflag, double *daya, char *serr)
+{
+  double x[6], eps;
+  char star[AS_MAXCH];
+  int32 retflag;
   if (sid_mode == SE_SIDM_TRUE_CITRA) {
     strcpy(star, "Spica"); /* Citra */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR) {
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR) {
       return ERR; 
     }
     /*fprintf(stderr, "serr=%s\n", serr);*/
@@ -3124,35 +3459,35 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode == SE_SIDM_TRUE_REVATI) {
     strcpy(star, ",zePsc"); /* Revati */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 359.8333333333);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_TRUE_PUSHYA) {
     strcpy(star, ",deCnc"); /* Pushya = Asellus Australis */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 106);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_TRUE_SHEORAN) {
     strcpy(star, ",deCnc"); /* Asellus Australis */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 103.49264221625);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_TRUE_MULA) {
     strcpy(star, ",laSco"); /* Mula = lambda Scorpionis */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 240);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode ==  SE_SIDM_GALCENT_0SAG) {
     strcpy(star, ",SgrA*"); /* Galactic Centre */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 240.0);
     return (retflag & SEFLG_EPHMASK);
@@ -3160,7 +3495,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode ==  SE_SIDM_GALCENT_COCHRANE) {
     strcpy(star, ",SgrA*"); /* Galactic Centre */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 270.0);
     return (retflag & SEFLG_EPHMASK);
@@ -3168,7 +3503,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode ==  SE_SIDM_GALCENT_RGILBRAND) {
     strcpy(star, ",SgrA*"); /* Galactic Centre */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 210.0 - 90.0 * 0.3819660113);
     return (retflag & SEFLG_EPHMASK);
@@ -3178,7 +3513,7 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
     strcpy(star, ",SgrA*"); /* Galactic Centre */
     /* right ascension in polar projection onto the ecliptic, 
      * and that point is put in the middle of Mula */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_true | SEFLG_EQUATORIAL, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag | SEFLG_EQUATORIAL, x, serr)) == ERR)
       return ERR;
     eps = swi_epsiln(tjd_et, iflag) * RADTODEG;
     *daya = swi_armc_to_mc(x[0], eps);
@@ -3188,25 +3523,160 @@ int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
   }
   if (sid_mode == SE_SIDM_GALEQU_IAU1958) {
     strcpy(star, ",GP1958"); /* Galactic Pole IAU 1958 */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 150);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_GALEQU_TRUE) {
     strcpy(star, ",GPol"); /* Galactic Pole modern, true */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 150);
     return (retflag & SEFLG_EPHMASK);
   }
   if (sid_mode == SE_SIDM_GALEQU_MULA) {
     strcpy(star, ",GPol"); /* Galactic Pole modern, true */
-    if ((retflag = swe_fixstar(star, tjd_et, iflag_galequ, x, serr)) == ERR)
+    if ((retflag = swe_fixstar(star, tjd_et, iflag, x, serr)) == ERR)
       return ERR;
     *daya = swe_degnorm(x[0] - 150 - 6.6666666667);
     return (retflag & SEFLG_EPHMASK);
   }
+  return ERR;
+}
+
+/* Ayanamshas that are derived from a star or from the galactic pole or
+ * centre require a fixed star calculation with each call. To avoid this,
+ * they are approximated by Chebyshev polynomials over segments of 
+ * SEI_AYASEG_LEN days. A segment is fitted only when SEI_AYASEG_NHITS 
+ * calls have fallen into it, so that calls for scattered dates do not 
+ * pay for fits they never use. 
+ * The fit is rejected, and the ayanamsha is computed directly, if the
+ * last Chebyshev coefficients are not negligible (this happens when the
+ * star is close to the sun and light deflection changes quickly), if
+ * the fit deviates from the direct computation in the middle of the 
+ * segment, or if the ephemeris is not available for the whole segment.
+ * The segments are discarded whenever the position cache of swe_calc()
+ * is cleared, i.e. if the ephemeris or the astronomical models change.
+ */
+static int32 get_ayanamsa_star_cached(double tjd_et, int sid_mode, int32 iflag, double *daya, char *serr)
+{
+  double t;
+  int32 iseg;
+  struct aya_segment *ap;
+  t = floor((tjd_et - J2000) / SEI_AYASEG_LEN);
+  if (fabs(t) > 1e9)
+    return get_ayanamsa_star(tjd_et, sid_mode, iflag, daya, serr);
+  iseg = (int32) t;
+  if (swed.savepos_gen == 0)
+    swed.savepos_gen = 1;
+  ap = &swed.ayaseg[((uint32) iseg + (uint32) sid_mode * 7) % SEI_NAYASEG];
+  if (ap->igen != swed.savepos_gen || ap->iseg != iseg 
+    || ap->sid_mode != sid_mode || ap->iflag != iflag) {
+    ap->igen = swed.savepos_gen;
+    ap->iseg = iseg;
+    ap->sid_mode = sid_mode;
+    ap->iflag = iflag;
+    ap->state = SEI_AYASEG_COUNT;
+    ap->nhits = 0;
+  }
+  if (ap->state == SEI_AYASEG_COUNT && ++ap->nhits >= SEI_AYASEG_NHITS)
+    fit_aya_segment(ap);
+  if (ap->state != SEI_AYASEG_FITTED)
+    return get_ayanamsa_star(tjd_et, sid_mode, iflag, daya, serr);
+  t = (tjd_et - J2000) / SEI_AYASEG_LEN - iseg;
+  *daya = swe_degnorm(swi_echeb(2 * t - 1, ap->coef, SEI_AYASEG_NCF));
+  if (serr != NULL)
+    *serr = '\0';
+  return ap->retflag;
+}
+
+static void fit_aya_segment(struct aya_segment *ap)
+{
+  int k, n = SEI_AYASEG_NCF;
+  double f[SEI_AYASEG_NCF], tstart, tmid, t, daya;
+  int32 retflag;
+  char serr[AS_MAXCH];
+  ap->state = SEI_AYASEG_DIRECT;
+  tstart = J2000 + ap->iseg * SEI_AYASEG_LEN;
+  tmid = tstart + SEI_AYASEG_LEN / 2;
+  for (k = 0; k < n; k++) {
+    t = tmid + cos(PI * (k + 0.5) / n) * SEI_AYASEG_LEN / 2;
+    retflag = get_ayanamsa_star(t, ap->sid_mode, ap->iflag, &f[k], serr);
+    /* also if the ephemeris has changed, e.g. to Moshier */
+    if (retflag == ERR || retflag != (ap->iflag & SEFLG_EPHMASK))
+      return;
+    if (k > 0)
+      f[k] = f[0] + swe_difdeg2n(f[k], f[0]);
+  }
+  chebyshev_fit(f, n, ap->coef);
+  if (fabs(ap->coef[n-1]) + fabs(ap->coef[n-2]) > SEI_AYASEG_TAIL)
+    return;
+  /* check in the middle of the segment, which is not a node */
+  if (get_ayanamsa_star(tmid, ap->sid_mode, ap->iflag, &daya, serr) == ERR)
+    return;
+  if (fabs(swe_difdeg2n(swi_echeb(0, ap->coef, n), daya)) > SEI_AYASEG_TOL)
+    return;
+  ap->retflag = retflag;
+  ap->state = SEI_AYASEG_FITTED;
+}
+
+/* Chebyshev coefficients of a function given by its values f[k] at 
+ * the n nodes x = cos(PI * (k + 0.5) / n), k = 0 ... n-1, 
+ * in the form evaluated by swi_echeb() */
+static void chebyshev_fit(double *f, int n, double *coef)
+{
+  int j, k;
+  double sum;
+  for (j = 0; j < n; j++) {
+    sum = 0;
+    for (k = 0; k < n; k++)
+      sum += f[k] * cos(PI * j * (k + 0.5) / n);
+    coef[j] = 2.0 * sum / n;
+  }
+}
+
+int32 swi_get_ayanamsa_ex(double tjd_et, int32 iflag, double *daya, char *serr)
+{
+  double x[6], eps, t0, corr;
+  struct sid_data *sip = &swed.sidd;
+  int32 epheflag, otherflag, iflag_true, iflag_galequ;
+  int sid_mode = sip->sid_mode;
+  iflag = plaus_iflag(iflag, -1, tjd_et, serr);
+  epheflag = iflag & SEFLG_EPHMASK;
+  otherflag = iflag & ~SEFLG_EPHMASK;
+  *daya = 0.0;
+  iflag &= SEFLG_EPHMASK;
+  iflag |= SEFLG_NONUT;
+  sid_mode %= SE_SIDBITS;
+  /* ayanamshas based on the intersection point of galactic equator and
+   * ecliptic always need SEFLG_TRUEPOS, because position of galactic
+   * pole is required without aberration or light deflection */
+  iflag_galequ = iflag | SEFLG_TRUEPOS;
+#if 1
+  /* _TRUE_ ayanamshas can have the following SEFLG_s;
+   * The star will have the intended fixed position even if these flags are 
+   * provided */
+  iflag_true = iflag;
+  if (otherflag & SEFLG_TRUEPOS) iflag_true |= SEFLG_TRUEPOS;
+  if (otherflag & SEFLG_NOABERR) iflag_true |= SEFLG_NOABERR;
+  if (otherflag & SEFLG_NOGDEFL) iflag_true |= SEFLG_NOGDEFL;
+#endif
+  /* warning, if swe_set_ephe_path() or swe_set_jplfile() was not called yet,
+   * although ephemeris files are required */
+  if (swi_init_swed_if_start() == 1 && !(epheflag & SEFLG_MOSEPH) 
+     && is_star_ayanamsa(sid_mode)
+      && serr != NULL) {
+    strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_get_ayanamsa_ex()");
+  }
+  if (!swed.ayana_is_set)
+    swe_set_sid_mode(SE_SIDM_FAGAN_BRADLEY, 0, 0);
+  if (is_star_ayanamsa(sid_mode)) {
+    if (sid_mode == SE_SIDM_GALEQU_IAU1958 || sid_mode == SE_SIDM_GALEQU_TRUE
+     || sid_mode == SE_SIDM_GALEQU_MULA)
+      return get_ayanamsa_star_cached(tjd_et, sid_mode, iflag_galequ, daya, serr);
+    return get_ayanamsa_star_cached(tjd_et, sid_mode, iflag_true, daya, serr);
+  }
   if (!(sip->sid_mode & SE_SIDBIT_ECL_DATE)) {
     // Now calculate precession for ayanamsha. 
     // The following is the original method implemented in 1999 and
@@ -4457,11 +4927,15 @@ static int get_new_segment(double tjd, int ipli, int ifno, char *serr)
       return(NOT_AVAILABLE);*/
   pdp->tseg0 = pdp->tfstart + iseg * pdp->dseg;
   pdp->tseg1 = pdp->tseg0 + pdp->dseg;
-  /* get file position of coefficients from file */
-  fpos = pdp->lndx0 + iseg * 3;
-  retc = do_fread((void *) &fpos, 3, 1, 4, fp, fpos, freord, fendian, ifno, serr);
-  if (retc != OK)
-    goto return_error_gns;
+  /* get file position of coefficients from index in memory or file */
+  if (pdp->segidx != NULL && iseg >= 0 && iseg < pdp->nndx) {
+    fpos = pdp->segidx[iseg];
+  } else {
+    fpos = pdp->lndx0 + iseg * 3;
+    retc = do_fread((void *) &fpos, 3, 1, 4, fp, fpos, freord, fendian, ifno, serr);
+    if (retc != OK)
+      goto return_error_gns;
+  }
   fseek(fp, fpos, SEEK_SET);
   /* clear space of chebyshew coefficients */
   if (pdp->segp == NULL)
@@ -4899,6 +5373,18 @@ fendian, ifno, serr);
     else
       pdp = &swed.pldat[ipli];
     pdp->ibdy = ipli;
+    /* index and preloaded segments of previous file */
+    if (pdp->segidx != NULL) {
+      free((void *) pdp->segidx);
+      pdp->segidx = NULL;
+    }
+    if (pdp->preseg != NULL) {
+      free((void *) pdp->preseg);
+      free((void *) pdp->preneval);
+      pdp->preseg = NULL;
+      pdp->preneval = NULL;
+      pdp->npreseg = 0;
+    }
     /* file position of planet's index */
     retc = do_fread((void *) &pdp->lndx0, 4, 1, 4, fp, SEI_CURR_FPOS,
 freord, fendian, ifno, serr);
@@ -5339,6 +5825,23 @@ static int lunar_osc_elem(double tjd, int ipl, int32 iflag, char *serr)
     istart = 2;
   if (serr != NULL)
     *serr = '\0';
+  /* Chebyshev pre-fit of node and apogee, if there is one for this
+   * ephemeris */
+  if (!(iflag & SEI_LUNFIT_DIRECT_FLAGS)
+    && lunfit_pos(tjd, SEI_TRUE_NODE, epheflag, xpos[0]) == OK
+    && lunfit_pos(tjd, SEI_OSCU_APOG, epheflag, xpos[1]) == OK) {
+    ndnp = &swed.nddat[SEI_TRUE_NODE];
+    ndap = &swed.nddat[SEI_OSCU_APOG];
+    swi_polcart_sp(xpos[0], ndnp->x);
+    swi_polcart_sp(xpos[1], ndap->x);
+    if (!(iflag & SEFLG_SPEED)) {
+      for (i = 3; i <= 5; i++)
+	ndnp->x[i] = ndap->x[i] = 0;
+    }
+    ndnp->teval = ndap->teval = tjd;
+    ndnp->iephe = ndap->iephe = epheflag;
+    goto polar_and_equatorial;
+  }
   three_positions:
   switch(epheflag) {
     case SEFLG_JPLEPH:
@@ -5570,6 +6073,7 @@ static int lunar_osc_elem(double tjd, int ipl, int32 iflag, char *serr)
     else
       ndnp->x[i+3] = 0;
   }
+  polar_and_equatorial:
   /**********************************************************************
    * precession and nutation have already been taken into account
    * because the computation is on the basis of lunar positions
@@ -5725,21 +6229,27 @@ static int intp_apsides(double tjd, int ipl, int32 iflag, char *serr)
   /*********************************************
    * now three apsides * 
    *********************************************/
-  for (t = tjd - speed_intv, i = 0; i < 3; t += speed_intv, i++) {
-    if (! (iflag & SEFLG_SPEED) && i != 1) continue;
-    swi_intp_apsides(t, xpos[i], ipl);
-  }
-  /************************************************************
-   * apsis with speed                                         * 
-   ************************************************************/
-  for (i = 0; i < 3; i++) {
-    xx[i] = xpos[1][i];
-    xx[i+3] = 0;
-  }
-  if (iflag & SEFLG_SPEED) {
-    xx[3] = swe_difrad2n(xpos[2][0], xpos[0][0]) / speed_intv / 2.0;
-    xx[4] = (xpos[2][1] - xpos[0][1]) / speed_intv / 2.0;
-    xx[5] = (xpos[2][2] - xpos[0][2]) / speed_intv / 2.0;
+  /* Chebyshev pre-fit, if available */
+  if (lunfit_pos(tjd, ipl, 0, xx) == OK) {
+    if (!(iflag & SEFLG_SPEED))
+      xx[3] = xx[4] = xx[5] = 0;
+  } else {
+    for (t = tjd - speed_intv, i = 0; i < 3; t += speed_intv, i++) {
+      if (! (iflag & SEFLG_SPEED) && i != 1) continue;
+      swi_intp_apsides(t, xpos[i], ipl);
+    }
+    /************************************************************
+     * apsis with speed                                         * 
+     ************************************************************/
+    for (i = 0; i < 3; i++) {
+      xx[i] = xpos[1][i];
+      xx[i+3] = 0;
+    }
+    if (iflag & SEFLG_SPEED) {
+      xx[3] = swe_difrad2n(xpos[2][0], xpos[0][0]) / speed_intv / 2.0;
+      xx[4] = (xpos[2][1] - xpos[0][1]) / speed_intv / 2.0;
+      xx[5] = (xpos[2][2] - xpos[0][2]) / speed_intv / 2.0;
+    }
   }
   memset((void *) ndp->xreturn, 0, 24 * sizeof(double));
   /* ecliptic polar to cartesian */
@@ -5842,22 +6352,112 @@ static int intp_apsides(double tjd, int ipl, int32 iflag, char *serr)
   return OK;
 }
 
-/* transforms the position of the moon in a way we can use it
- * for calculation of osculating node and apogee:
- * precession and nutation (attention to speed vector!)
- * according to flags
- * iflag	flags
- * tjd          time for which the element is computed
- *              i.e. date of ecliptic
- * xx           array equatorial cartesian position and speed
- * serr         error string
+/* Chebyshev pre-fit of the true node, the osculating apogee and the
+ * interpolated apsides (file SE_FILE_LUNFIT, written by swelunfit.c).
+ * ipl is SEI_TRUE_NODE, SEI_OSCU_APOG, SEI_INTP_APOG, or SEI_INTP_PERG.
+ * Node and osculating apogee depend on the ephemeris; they are taken
+ * from the file only if it has been fitted with epheflag and with the
+ * current astronomical models. The interpolated apsides do not depend
+ * on the ephemeris.
+ * Returns OK and in xpol ecliptic polar coordinates of date with speed
+ * (radians, AU), or ERR, if the file is missing or does not cover tjd.
+ * The segment last read is kept in memory.
  */
-int swi_plan_for_osc_elem(int32 iflag, double tjd, double *xx)
+static int lunfit_pos(double tjd, int ipl, int32 epheflag, double *xpol)
 {
-  int i;
-  double x[6];
-  struct nut nuttmp;
-  struct nut *nutp = &nuttmp;	/* dummy assign, to silence gcc warning */
+  int i, ipt;
+  int32 iseg, nval;
+  double t, *cp;
+  struct lunfit_data *lfp = &swed.lunfit;
+  struct lunfit_head *hp = &lfp->head;
+  if (lfp->fptr == NULL) {
+    if (lfp->is_tried)
+      return ERR;
+    lfp->is_tried = TRUE;
+    if (open_lunfit_file() != OK)
+      return ERR;
+  }
+  switch (ipl) {
+    case SEI_TRUE_NODE: ipt = 0; break;
+    case SEI_OSCU_APOG: ipt = 1; break;
+    case SEI_INTP_APOG: ipt = 2; break;
+    case SEI_INTP_PERG: ipt = 3; break;
+    default: return ERR;
+  }
+  if (ipt <= 1 && (epheflag != hp->iephe 
+    || memcmp(hp->astro_models, swed.astro_models, SEI_NMODELS * sizeof(int32)) != 0))
+    return ERR;
+  if (tjd < hp->tfstart || tjd >= hp->tfend)
+    return ERR;
+  iseg = (int32) ((tjd - hp->tfstart) / hp->dseg);
+  if (iseg >= hp->nseg)
+    iseg = hp->nseg - 1;
+  nval = SEI_LUNFIT_NPTS * 3 * hp->ncoe;
+  if (iseg != lfp->iseg) {
+    lfp->iseg = -1;
+    if (fseek(lfp->fptr, (long) sizeof(struct lunfit_head) + (long) iseg * nval * (long) sizeof(double), SEEK_SET) != 0
+      || fread((void *) lfp->coef, sizeof(double), (size_t) nval, lfp->fptr) != (size_t) nval)
+      return ERR;
+    lfp->iseg = iseg;
+  }
+  t = (tjd - hp->tfstart - iseg * hp->dseg) / hp->dseg * 2 - 1;
+  cp = lfp->coef + ipt * 3 * hp->ncoe;
+  for (i = 0; i <= 2; i++) {
+    xpol[i] = swi_echeb(t, cp + i * hp->ncoe, hp->ncoe);
+    xpol[i+3] = swi_edcheb(t, cp + i * hp->ncoe, hp->ncoe) / hp->dseg * 2;
+  }
+  xpol[0] = swi_mod2PI(xpol[0]);
+  return OK;
+}
+
+/* opens the pre-fit file and reads its header.
+ * A file with wrong header is ignored. */
+static int open_lunfit_file(void)
+{
+  struct lunfit_data *lfp = &swed.lunfit;
+  struct lunfit_head *hp = &lfp->head;
+  lfp->fptr = swi_fopen(-1, SE_FILE_LUNFIT, swed.ephepath, NULL);
+  if (lfp->fptr == NULL)
+    return ERR;
+  if (fread((void *) hp, sizeof(struct lunfit_head), 1, lfp->fptr) != 1
+    || strncmp(hp->magic, SEI_LUNFIT_MAGIC, 8) != 0
+    || hp->version != SEI_LUNFIT_VERSION
+    || hp->test_endian != SEI_FILE_TEST_ENDIAN
+    || hp->ncoe < 1 || hp->ncoe > SEI_LUNFIT_MAXCOE
+    || hp->nseg < 1 || hp->dseg <= 0) {
+    fclose(lfp->fptr);
+    lfp->fptr = NULL;
+    return ERR;
+  }
+  lfp->iseg = -1;
+  return OK;
+}
+
+static void close_lunfit_file(void)
+{
+  if (swed.lunfit.fptr != NULL)
+    fclose(swed.lunfit.fptr);
+  swed.lunfit.fptr = NULL;
+  swed.lunfit.is_tried = FALSE;
+  swed.lunfit.iseg = -1;
+}
+
+/* transforms the position of the moon in a way we can use it
+ * for calculation of osculating node and apogee:
+ * precession and nutation (attention to speed vector!)
+ * according to flags
+ * iflag	flags
+ * tjd          time for which the element is computed
+ *              i.e. date of ecliptic
+ * xx           array equatorial cartesian position and speed
+ * serr         error string
+ */
+int swi_plan_for_osc_elem(int32 iflag, double tjd, double *xx)
+{
+  int i;
+  double x[6];
+  struct nut nuttmp;
+  struct nut *nutp = &nuttmp;	/* dummy assign, to silence gcc warning */
   struct epsilon *oe = &swed.oec;
   struct epsilon oectmp;
   /* ICRS to J2000 */
@@ -6520,17 +7120,8 @@ static int32 fixstar_calc_from_struct(struct fixed_star *stardata, double tjd, i
     strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_fixstar() or swe_fixstar_ut()");
   }
   if (swed.last_epheflag != epheflag) {
-    free_planets();
-    /* close and free ephemeris files */
-    if (swed.jpl_file_is_open) {
-      swi_close_jpl_file();
-      swed.jpl_file_is_open = FALSE;
-    }
-    for (i = 0; i < SEI_NEPHFILES; i ++) {
-      if (swed.fidat[i].fptr != NULL) 
-	fclose(swed.fidat[i].fptr);
-      memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
-    }
+    /* ephemeris files remain open, see free_positions() */
+    free_positions();
     swed.last_epheflag = epheflag;
   }
   /* high precision speed prevails fast speed */
@@ -7360,21 +7951,705 @@ void CALL_CONV swe_set_topo(double geolon, double geolat, double geoalt)
   /* to force new calculation of observer position vector */
   swed.topd.teval = 0;
   /* to force new calculation of light-time etc. 
-   */
-  swi_force_app_pos_etc();
+   * (the position cache of swe_calc() is kept, because its topocentric
+   * positions are saved with the observer position) */
+  force_app_pos();
 }
 
 void swi_force_app_pos_etc()
+{
+  force_app_pos();
+  clear_save_positions();
+}
+
+/* forces new calculation of light-time etc., but keeps the position
+ * cache of swe_calc() */
+static void force_app_pos(void)
 {
   int i;
   for (i = 0; i < SEI_NPLANETS; i++)
     swed.pldat[i].xflgs = -1;
   for (i = 0; i < SEI_NNODE_ETC; i++)
     swed.nddat[i].xflgs = -1;
-  for (i = 0; i <= SE_NPLANETS; i++) { // "=" because save area for asteroids > SE_AST_OFFSET is at i == SE_NPLANETS
-    swed.savedat[i].tsave = 0;
-    swed.savedat[i].iflgsave = -1;
+}
+
+/* Position cache of swe_calc().
+ * Positions are saved with date, body and the requested flags (without
+ * coordinate system flags, because each entry contains all coordinate 
+ * systems), with the geographic position of the observer if topocentric, 
+ * and with the sidereal mode if sidereal.
+ * The cache is set-associative: the date and the body select a set of 
+ * SEI_NSAVEPOS_WAYS entries, so that calls for the same body and date 
+ * with different flags (e.g. ecliptic and equatorial positions, with and 
+ * without SEFLG_TOPOCTR or SEFLG_SIDEREAL) do not replace each other. 
+ * Within a set, the least recently used entry is replaced.
+ * All entries are invalidated by incrementing swed.savepos_gen.
+ */
+static int32 alloc_save_positions(void)
+{
+  int32 n = swed.nsavedat_req;
+  if (n <= 0) 
+    n = SEI_NSAVEPOS_DFT;
+  if (n > SEI_NSAVEPOS_WAYS)
+    n -= n % SEI_NSAVEPOS_WAYS;
+  swed.savedat = (struct save_positions *) calloc((size_t) n, sizeof(struct save_positions));
+  if (swed.savedat == NULL)
+    return ERR;
+  swed.nsavedat = n;
+  /* calloc() has set all igen = 0, which never is a valid generation */
+  if (swed.savepos_gen == 0)
+    swed.savepos_gen = 1;
+  return OK;
+}
+
+/* returns the first entry of the set of tjd and ipl, *nways = its size */
+static struct save_positions *save_positions_set(double tjd, int ipl, int *nways)
+{
+  unsigned char c[sizeof(double)];
+  uint32 h = 2166136261u;	/* FNV-1a hash of date and body */
+  size_t i;
+  int nw = SEI_NSAVEPOS_WAYS;
+  if (swed.savedat == NULL && alloc_save_positions() != OK)
+    return NULL;
+  if (swed.nsavedat < nw)
+    nw = swed.nsavedat;
+  memcpy(c, &tjd, sizeof(double));
+  for (i = 0; i < sizeof(double); i++)
+    h = (h ^ c[i]) * 16777619u;
+  h = (h ^ (uint32) ipl) * 16777619u;
+  *nways = nw;
+  return swed.savedat + (h % (uint32) (swed.nsavedat / nw)) * nw;
+}
+
+static struct save_positions *get_save_positions(double tjd, int ipl, int32 iflgkey)
+{
+  int i, nw;
+  struct save_positions *sd;
+  if (tjd == 0)
+    return NULL;
+  if ((sd = save_positions_set(tjd, ipl, &nw)) == NULL)
+    return NULL;
+  for (i = 0; i < nw; i++, sd++) {
+    if (sd->igen != swed.savepos_gen || sd->tsave != tjd 
+      || sd->ipl != ipl || sd->iflgreq != iflgkey)
+      continue;
+    if ((iflgkey & SEFLG_TOPOCTR) 
+      && (sd->geopos[0] != swed.topd.geolon
+      || sd->geopos[1] != swed.topd.geolat
+      || sd->geopos[2] != swed.topd.geoalt))
+      continue;
+    if ((iflgkey & SEFLG_SIDEREAL) 
+      && (sd->sid_mode != swed.sidd.sid_mode
+      || sd->sid_t0 != swed.sidd.t0
+      || sd->sid_ayan_t0 != swed.sidd.ayan_t0))
+      continue;
+    sd->iuse = ++swed.savepos_clock;
+    swed.savepos_hits++;
+    return sd;
   }
+  swed.savepos_misses++;
+  return NULL;
+}
+
+static void save_positions(double tjd, int ipl, int32 iflgkey, int32 iflgret, double *xsaves)
+{
+  int i, nw;
+  struct save_positions *sd, *sdset;
+  if (tjd == 0)
+    return;
+  if ((sdset = save_positions_set(tjd, ipl, &nw)) == NULL)
+    return;
+  /* an invalid entry or the least recently used one */
+  sd = sdset;
+  for (i = 0; i < nw; i++) {
+    if (sdset[i].igen != swed.savepos_gen) {
+      sd = &sdset[i];
+      break;
+    }
+    if (sdset[i].iuse < sd->iuse)
+      sd = &sdset[i];
+  }
+  sd->tsave = tjd;
+  sd->ipl = ipl;
+  sd->iflgreq = iflgkey;
+  sd->iflgsave = iflgret;
+  sd->geopos[0] = swed.topd.geolon;
+  sd->geopos[1] = swed.topd.geolat;
+  sd->geopos[2] = swed.topd.geoalt;
+  sd->sid_mode = swed.sidd.sid_mode;
+  sd->sid_t0 = swed.sidd.t0;
+  sd->sid_ayan_t0 = swed.sidd.ayan_t0;
+  for (i = 0; i < 24; i++)
+    sd->xsaves[i] = xsaves[i];
+  sd->igen = swed.savepos_gen;
+  sd->iuse = ++swed.savepos_clock;
+}
+
+static void clear_save_positions(void)
+{
+  swed.savepos_gen++;
+  /* after overflow, old entries could become valid again */
+  if (swed.savepos_gen == 0) {
+    if (swed.savedat != NULL)
+      memset((void *) swed.savedat, 0, swed.nsavedat * sizeof(struct save_positions));
+    memset((void *) swed.ayaseg, 0, sizeof(swed.ayaseg));
+    memset((void *) &swed.sidtsave, 0, sizeof(swed.sidtsave));
+    swed.savepos_gen = 1;
+  }
+}
+
+/* sets the number of entries of the position cache of swe_calc();
+ * nentries <= 0 sets the default size SEI_NSAVEPOS_DFT.
+ * The cache is emptied and the statistics are reset. */
+void CALL_CONV swe_set_calc_cache(int32 nentries)
+{
+  swi_init_swed_if_start();
+  if (swed.savedat != NULL) {
+    free(swed.savedat);
+    swed.savedat = NULL;
+    swed.nsavedat = 0;
+  }
+  swed.nsavedat_req = nentries;
+  swed.savepos_hits = 0;
+  swed.savepos_misses = 0;
+  clear_save_positions();
+}
+
+/* statistics of the position cache of swe_calc():
+ * dret[0]	number of entries
+ * dret[1]	number of hits
+ * dret[2]	number of misses
+ * dret[3]	hit rate in percent
+ */
+void CALL_CONV swe_get_calc_cache_stats(double *dret)
+{
+  double n = swed.savepos_hits + swed.savepos_misses;
+  dret[0] = (double) swed.nsavedat;
+  if (swed.nsavedat == 0) 
+    dret[0] = (double) (swed.nsavedat_req > 0 ? swed.nsavedat_req : SEI_NSAVEPOS_DFT);
+  dret[1] = swed.savepos_hits;
+  dret[2] = swed.savepos_misses;
+  dret[3] = (n > 0) ? swed.savepos_hits / n * 100.0 : 0;
+}
+
+/* Pool of asteroid files.
+ * All numbered asteroids and planetary moons are computed in the file
+ * slot fidat[SEI_FILE_ANY_AST] with the plan data pldat[SEI_ANYBODY].
+ * When another body is wanted, the file, the constants and the current
+ * segment of the body in the slot (and the elements read from the
+ * file header) are parked in the pool instead of being closed and 
+ * freed, and the wanted body is moved into the slot, if it is in the 
+ * pool. So read_const() and the segment are not redone when a program
+ * switches between several asteroids. If the pool is full, the least 
+ * recently parked body is closed.
+ */
+static void ast_pool_swap(int ipli)
+{
+  int i;
+  struct file_data *fdp = &swed.fidat[SEI_FILE_ANY_AST];
+  struct plan_data *pdp = &swed.pldat[SEI_ANYBODY];
+  struct ast_pool_entry *ap, *apfree = NULL, want;
+  if (swed.astpool == NULL) {
+    int32 n = swed.nastpool_req;
+    if (n < 0)
+      return;	/* no pool, sweph() closes the file */
+    if (n == 0)
+      n = SEI_NASTPOOL_DFT;
+    swed.astpool = (struct ast_pool_entry *) calloc((size_t) n, sizeof(struct ast_pool_entry));
+    if (swed.astpool == NULL)
+      return;	/* sweph() closes the file as without pool */
+    swed.nastpool = n;
+  }
+  /* take the wanted body out of the pool */
+  want.ipli = 0;
+  for (i = 0, ap = swed.astpool; i < swed.nastpool; i++, ap++) {
+    if (ap->ipli == ipli) {
+      want = *ap;
+      memset((void *) ap, 0, sizeof(struct ast_pool_entry));
+      break;
+    }
+  }
+  /* park the body of the slot in a free entry or in place of the 
+   * least recently parked one */
+  if (fdp->fptr != NULL) {
+    for (i = 0, ap = swed.astpool; i < swed.nastpool; i++, ap++) {
+      if (apfree == NULL || ap->ipli == 0
+	|| (apfree->ipli != 0 && ap->iuse < apfree->iuse))
+	apfree = ap;
+    }
+    if (apfree->ipli != 0) {
+      fclose(apfree->fidat.fptr);
+      free_plan_file_data(&apfree->pldat);
+    }
+    apfree->ipli = pdp->ibdy;
+    apfree->iuse = ++swed.astpool_clock;
+    apfree->fidat = *fdp;
+    apfree->pldat = *pdp;
+    apfree->ast_G = swed.ast_G;
+    apfree->ast_H = swed.ast_H;
+    apfree->ast_diam = swed.ast_diam;
+    strcpy(apfree->astelem, swed.astelem);
+  } else {
+    free_plan_file_data(pdp);
+  }
+  memset((void *) fdp, 0, sizeof(struct file_data));
+  memset((void *) pdp, 0, sizeof(struct plan_data));
+  /* the wanted body goes into the slot; its position must be 
+   * computed again */
+  if (want.ipli != 0) {
+    *fdp = want.fidat;
+    *pdp = want.pldat;
+    pdp->teval = 0;
+    pdp->iephe = 0;
+    pdp->xflgs = 0;
+    swed.ast_G = want.ast_G;
+    swed.ast_H = want.ast_H;
+    swed.ast_diam = want.ast_diam;
+    strcpy(swed.astelem, want.astelem);
+  }
+}
+
+/* closes the files of the pool; do_free also frees the pool */
+static void close_ast_pool(AS_BOOL do_free)
+{
+  int i;
+  struct ast_pool_entry *ap;
+  if (swed.astpool == NULL)
+    return;
+  for (i = 0, ap = swed.astpool; i < swed.nastpool; i++, ap++) {
+    if (ap->ipli == 0)
+      continue;
+    fclose(ap->fidat.fptr);
+    free_plan_file_data(&ap->pldat);
+    memset((void *) ap, 0, sizeof(struct ast_pool_entry));
+  }
+  if (do_free) {
+    free((void *) swed.astpool);
+    swed.astpool = NULL;
+    swed.nastpool = 0;
+  }
+}
+
+/* frees the memory of the part of the plan data that is read 
+ * from the ephemeris file; the pointers are not reset */
+static void free_plan_file_data(struct plan_data *pdp)
+{
+  if (pdp->refep != NULL)
+    free((void *) pdp->refep);
+  if (pdp->segp != NULL)
+    free((void *) pdp->segp);
+  if (pdp->segidx != NULL)
+    free((void *) pdp->segidx);
+  if (pdp->preseg != NULL)
+    free((void *) pdp->preseg);
+  if (pdp->preneval != NULL)
+    free((void *) pdp->preneval);
+}
+
+/* exchanges the part of the plan data that is read from the 
+ * ephemeris file (ibdy through neval, see struct plan_data) */
+static void swap_plan_file_data(struct plan_data *pdp1, struct plan_data *pdp2)
+{
+  struct plan_data tmp;
+  size_t n = offsetof(struct plan_data, teval);
+  memcpy((void *) &tmp, (void *) pdp1, n);
+  memcpy((void *) pdp1, (void *) pdp2, n);
+  memcpy((void *) pdp2, (void *) &tmp, n);
+}
+
+static void free_park_entry(struct file_park_entry *fpp)
+{
+  int i;
+  if (fpp->fidat.fptr != NULL)
+    fclose(fpp->fidat.fptr);
+  for (i = 0; i < SEI_NPLANETS; i++)
+    free_plan_file_data(&fpp->pldat[i]);
+  memset((void *) fpp, 0, sizeof(struct file_park_entry));
+}
+
+/* Files of other time ranges.
+ * The planet, moon and main asteroid files cover 600 years each. When 
+ * tjd is beyond the range of the open file, sweph() used to close it 
+ * and to open the file of tjd. For time scans that go back and forth 
+ * across the boundary, the file in fidat[ifno] is now parked with the 
+ * file data of its bodies instead, and the file of tjd is taken from
+ * the parked ones, if it is there. If all entries are in use, the least
+ * recently parked file is closed.
+ */
+static void file_park_swap(int ifno, int ipli, double tjd)
+{
+  int i;
+  size_t lfnam, lfname;
+  char fname[AS_MAXCH];
+  AS_BOOL infile[SEI_NPLANETS];
+  struct file_data *fdp = &swed.fidat[ifno];
+  struct file_data ftmp;
+  struct file_park_entry *fpp, *fpwant = NULL, *fpfree = NULL;
+  if (swed.filepark == NULL) {
+    if (fdp->fptr == NULL)
+      return;
+    swed.filepark = (struct file_park_entry *) calloc((size_t) SEI_NFILEPARK, sizeof(struct file_park_entry));
+    if (swed.filepark == NULL)
+      return;	/* sweph() closes the file as before */
+  }
+  /* the file of tjd is the one that sweph() would open; where files 
+   * overlap, another one would give slightly different positions */
+  swi_gen_filename(tjd, ipli, fname);
+  lfname = strlen(fname);
+  for (i = 0, fpp = swed.filepark; i < SEI_NFILEPARK; i++, fpp++) {
+    lfnam = strlen(fpp->fidat.fnam);
+    if (fpp->fidat.fptr != NULL && fpp->ifno == ifno 
+      && tjd >= fpp->fidat.tfstart && tjd <= fpp->fidat.tfend
+      && lfnam >= lfname && strcmp(fpp->fidat.fnam + lfnam - lfname, fname) == 0) {
+      fpwant = fpp;
+      break;
+    }
+    if (fpfree == NULL || fpp->fidat.fptr == NULL 
+      || (fpfree->fidat.fptr != NULL && fpp->iuse < fpfree->iuse))
+      fpfree = fpp;
+  }
+  if (fpwant == NULL) {
+    if (fdp->fptr == NULL)
+      return;
+    fpwant = fpfree;
+    free_park_entry(fpwant);
+  }
+  /* exchange the file in the slot with the entry; an empty entry takes
+   * the file, and sweph() then opens the file of tjd */
+  memset((void *) infile, 0, sizeof(infile));
+  for (i = 0; i < fdp->npl; i++)
+    if (fdp->ipl[i] < SEI_NPLANETS)
+      infile[fdp->ipl[i]] = TRUE;
+  for (i = 0; i < fpwant->fidat.npl; i++)
+    if (fpwant->fidat.ipl[i] < SEI_NPLANETS)
+      infile[fpwant->fidat.ipl[i]] = TRUE;
+  for (i = 0; i < SEI_NPLANETS; i++)
+    if (infile[i])
+      swap_plan_file_data(&swed.pldat[i], &fpwant->pldat[i]);
+  ftmp = *fdp;
+  *fdp = fpwant->fidat;
+  fpwant->fidat = ftmp;
+  fpwant->ifno = ifno;
+  fpwant->iuse = ++swed.filepark_clock;
+}
+
+static void close_file_park(void)
+{
+  int i;
+  if (swed.filepark == NULL)
+    return;
+  for (i = 0; i < SEI_NFILEPARK; i++)
+    free_park_entry(&swed.filepark[i]);
+  free((void *) swed.filepark);
+  swed.filepark = NULL;
+}
+
+/* reads the segment index of all bodies of the open file ifno into 
+ * memory, so that get_new_segment() needs not read it from the file */
+int swi_read_segment_index(int ifno, char *serr)
+{
+  int i, kpl, ipli, n, retc;
+  struct file_data *fdp = &swed.fidat[ifno];
+  struct plan_data *pdp;
+  int freord  = (int) fdp->iflg & SEI_FILE_REORD;
+  int fendian = (int) fdp->iflg & SEI_FILE_LITENDIAN;
+  if (fdp->fptr == NULL)
+    return OK;
+  for (kpl = 0; kpl < fdp->npl; kpl++) {
+    ipli = fdp->ipl[kpl];
+    if (ipli >= SE_PLMOON_OFFSET)	/* single asteroid or planetary moon */
+      ipli = SEI_ANYBODY;
+    else if (ipli >= SEI_NPLANETS)
+      continue;
+    pdp = &swed.pldat[ipli];
+    if (pdp->segidx != NULL || pdp->nndx <= 0)
+      continue;
+    pdp->segidx = (int32 *) malloc((size_t) pdp->nndx * sizeof(int32));
+    if (pdp->segidx == NULL) {
+      if (serr != NULL)
+	strcpy(serr, "error in malloc() of segment index");
+      return ERR;
+    }
+    /* do_fread() reads at most 1000 bytes at once */
+    for (i = 0; i < pdp->nndx; i += n) {
+      n = pdp->nndx - i;
+      if (n > 300)
+	n = 300;
+      retc = do_fread((void *) (pdp->segidx + i), 3, n, 4, fdp->fptr, pdp->lndx0 + i * 3, freord, fendian, ifno, serr);
+      if (retc != OK) {
+	free((void *) pdp->segidx);
+	pdp->segidx = NULL;
+	return ERR;
+      }
+    }
+  }
+  return OK;
+}
+
+/* opens the Swiss Ephemeris file fname (with path) as file ifno, 
+ * independently of the ephemeris path and of the date, and reads 
+ * its constants. For the tools sweverify and swerepack. */
+int swi_open_ephe_file(int ifno, char *fname, char *serr)
+{
+  struct file_data *fdp = &swed.fidat[ifno];
+  swi_init_swed_if_start();
+  if (fdp->fptr != NULL) {
+    fclose(fdp->fptr);
+    fdp->fptr = NULL;
+  }
+  if (strlen(fname) >= AS_MAXCH) {
+    if (serr != NULL)
+      sprintf(serr, "error: file path and name must be shorter than %d.", AS_MAXCH);
+    return ERR;
+  }
+  strcpy(fdp->fnam, fname);
+  fdp->fptr = fopen(fdp->fnam, BFILE_R_ACCESS);
+  if (fdp->fptr == NULL) {
+    if (serr != NULL)
+      sprintf(serr, "SwissEph file '%s' not found", fname);
+    return ERR;
+  }
+  return read_const(ifno, serr);
+}
+
+/* reads segment iseg of body ipli from the open file ifno into 
+ * pdp->segp and sets tseg0, tseg1 and neval.
+ * rotate = TRUE: the coefficients are rotated back to the equator 
+ * of J2000 (and the reference orbit added), as sweph() uses them; 
+ * rotate = FALSE: they remain as stored in the file. */
+int swi_get_ephe_segment(int ifno, int ipli, int32 iseg, AS_BOOL rotate, char *serr)
+{
+  int retc;
+  struct plan_data *pdp = &swed.pldat[ipli];
+  if (swed.fidat[ifno].fptr == NULL || iseg < 0 || iseg >= pdp->nndx) {
+    if (serr != NULL)
+      sprintf(serr, "segment %d of body %d not in ephemeris file", iseg, ipli);
+    return ERR;
+  }
+  retc = get_new_segment(pdp->tfstart + (iseg + 0.5) * pdp->dseg, ipli, ifno, serr);
+  if (retc != OK)
+    return retc;
+  if (rotate && (pdp->iflg & SEI_FLG_ROTATE))
+    rot_back(ipli);
+  else
+    pdp->neval = pdp->ncoe;
+  return OK;
+}
+
+/* Prepares the ephemeris for calculations between tjd_start and tjd_end
+ * (ET), so that the first calls of swe_calc() in this range need not 
+ * open files and read their constants: the files of the bodies of 
+ * body_mask (bit 1 << SE_SUN etc., up to SE_VESTA) are opened and the
+ * segment indices of Swiss Ephemeris files are read into memory.
+ * Files of up to SEI_NFILEPARK other time ranges remain open. 
+ * The ephemeris state is per thread; the function must be called in
+ * the thread that will do the calculations. */
+int32 CALL_CONV swe_prefetch(double tjd_start, double tjd_end, int32 body_mask, int32 iflag, char *serr)
+{
+  int32 ipl, epheflag, retc;
+  int ifno;
+  double t, tfend, xx[6];
+  epheflag = iflag & SEFLG_EPHMASK;
+  if (epheflag & SEFLG_MOSEPH)
+    return OK;		/* no files */
+  if (!(epheflag & SEFLG_JPLEPH))
+    epheflag = SEFLG_SWIEPH;
+  if (tjd_end < tjd_start) {
+    t = tjd_start; tjd_start = tjd_end; tjd_end = t;
+  }
+  for (ipl = SE_SUN; ipl <= SE_VESTA; ipl++) {
+    if (!(body_mask & (1 << ipl)))
+      continue;
+    if (ipl >= SE_MEAN_NODE && ipl <= SE_OSCU_APOG)
+      continue;		/* computed from moon and earth */
+    if (ipl == SE_MOON)
+      ifno = SEI_FILE_MOON;
+    else if (ipl >= SE_CHIRON)
+      ifno = SEI_FILE_MAIN_AST;
+    else 
+      ifno = SEI_FILE_PLANET;
+    for (t = tjd_start; ; t = tfend + 1) {
+      retc = swe_calc(t, ipl, epheflag, xx, serr);
+      if (retc == ERR)
+	return ERR;
+      if ((retc & SEFLG_EPHMASK) != epheflag) {
+	if (serr != NULL && *serr == '\0')
+	  sprintf(serr, "ephemeris file of body %d for jd %f not found", ipl, t);
+	return ERR;
+      }
+      /* JPL file: one file for the whole range */
+      if (epheflag == SEFLG_JPLEPH)
+	break;
+      /* the planet file is also needed for the sun and the earth */
+      if (swi_read_segment_index(ifno, serr) != OK
+	|| swi_read_segment_index(SEI_FILE_PLANET, serr) != OK)
+	return ERR;
+      tfend = swed.fidat[ifno].tfend;
+      if (tfend >= tjd_end || tfend < t)
+	break;
+    }
+  }
+  return OK;
+}
+
+/* files and segment indices in memory, see swe_prefetch():
+ * dret[0] = open planet, moon and asteroid files, also of other
+ * time ranges, dret[1] = bodies with segment index, dret[2] = bytes
+ * of the segment indices */
+void CALL_CONV swe_get_prefetch_stats(double *dret)
+{
+  int i, j;
+  struct file_data *fdp;
+  struct plan_data *pdp;
+  dret[0] = dret[1] = dret[2] = 0;
+  for (j = -1; j < SEI_NFILEPARK; j++) {
+    if (j >= 0 && (swed.filepark == NULL || swed.filepark[j].fidat.fptr == NULL))
+      continue;
+    if (j < 0) {
+      for (i = SEI_FILE_PLANET; i <= SEI_FILE_ANY_AST; i++) {
+	fdp = &swed.fidat[i];
+	if (fdp->fptr != NULL)
+	  dret[0] += 1;
+      }
+    } else {
+      dret[0] += 1;
+    }
+    for (i = 0; i < SEI_NPLANETS; i++) {
+      pdp = (j < 0) ? &swed.pldat[i] : &swed.filepark[j].pldat[i];
+      if (pdp->segidx == NULL)
+	continue;
+      dret[1] += 1;
+      dret[2] += (double) pdp->nndx * sizeof(int32);
+    }
+  }
+}
+
+/* decodes all segments of the preload range of the bodies of the
+ * open file ifno, see swe_set_ephe_preload() */
+static int preload_segments(int ifno, char *serr)
+{
+  int kpl, ipli, retc;
+  int32 i, iseg0, iseg1, nseg;
+  size_t nsegsize;
+  double t0, t1, *preseg;
+  int *preneval;
+  struct file_data *fdp = &swed.fidat[ifno];
+  struct plan_data *pdp;
+  for (kpl = 0; kpl < fdp->npl; kpl++) {
+    ipli = fdp->ipl[kpl];
+    if (ipli >= SEI_NPLANETS || ipli == SEI_ANYBODY)
+      continue;
+    pdp = &swed.pldat[ipli];
+    if (pdp->preseg != NULL || pdp->nndx <= 0)
+      continue;
+    t0 = (swed.preload_tjd0 > pdp->tfstart) ? swed.preload_tjd0 : pdp->tfstart;
+    t1 = (swed.preload_tjd1 < pdp->tfend) ? swed.preload_tjd1 : pdp->tfend;
+    if (t0 > t1)
+      continue;
+    iseg0 = (int32) ((t0 - pdp->tfstart) / pdp->dseg);
+    iseg1 = (int32) ((t1 - pdp->tfstart) / pdp->dseg);
+    if (iseg1 >= pdp->nndx)
+      iseg1 = pdp->nndx - 1;
+    nseg = iseg1 - iseg0 + 1;
+    nsegsize = (size_t) pdp->ncoe * 3;
+    preseg = (double *) malloc((size_t) nseg * nsegsize * sizeof(double));
+    preneval = (int *) malloc((size_t) nseg * sizeof(int));
+    if (preseg == NULL || preneval == NULL) {
+      if (preseg != NULL) free((void *) preseg);
+      if (preneval != NULL) free((void *) preneval);
+      if (serr != NULL)
+	strcpy(serr, "error in malloc() of preloaded segments");
+      return ERR;
+    }
+    for (i = 0; i < nseg; i++) {
+      retc = get_new_segment(pdp->tfstart + (iseg0 + i + 0.5) * pdp->dseg, ipli, ifno, serr);
+      if (retc != OK) {
+	free((void *) preseg);
+	free((void *) preneval);
+	return retc;
+      }
+      if (pdp->iflg & SEI_FLG_ROTATE)
+	rot_back(ipli);
+      else
+	pdp->neval = pdp->ncoe;
+      memcpy((void *) (preseg + i * nsegsize), (void *) pdp->segp, nsegsize * sizeof(double));
+      preneval[i] = pdp->neval;
+    }
+    pdp->preseg = preseg;
+    pdp->preneval = preneval;
+    pdp->preiseg0 = iseg0;
+    pdp->npreseg = nseg;
+  }
+  return OK;
+}
+
+/* Preloaded ephemeris.
+ * All segments of the planet, moon and main asteroid files between 
+ * tjd_start and tjd_end (ET) are decoded when a file is opened, and 
+ * sweph() copies them instead of reading them from the file. The range
+ * remains set after swe_close(); tjd_end <= tjd_start switches 
+ * preloading off. The files of the range are opened at once, as far 
+ * as they are kept open (see file_park_swap()).
+ */
+int32 CALL_CONV swe_set_ephe_preload(double tjd_start, double tjd_end, char *serr)
+{
+  int32 ipl, body_mask = 0, retc = OK;
+  swi_init_swed_if_start();
+  /* close the Swiss Ephemeris files, so that they are opened again 
+   * and preloaded; other settings are kept */
+  close_sweph_files();
+  swed.preload_tjd0 = tjd_start;
+  swed.preload_tjd1 = tjd_end;
+  if (tjd_end <= tjd_start)
+    return OK;
+  for (ipl = SE_SUN; ipl <= SE_PLUTO; ipl++)
+    body_mask |= 1 << ipl;
+  retc = swe_prefetch(tjd_start, tjd_end, body_mask, SEFLG_SWIEPH, serr);
+  if (retc != OK)
+    return retc;
+  /* main asteroid files are optional, a missing one is no error */
+  body_mask = 0;
+  for (ipl = SE_CHIRON; ipl <= SE_VESTA; ipl++)
+    body_mask |= 1 << ipl;
+  swe_prefetch(tjd_start, tjd_end, body_mask, SEFLG_SWIEPH, NULL);
+  return OK;
+}
+
+/* memory of preloaded segments: 
+ * dret[0] = bytes, dret[1] = segments, dret[2] = bodies and files */
+void CALL_CONV swe_get_ephe_preload_stats(double *dret)
+{
+  int i, j;
+  struct plan_data *pdp;
+  dret[0] = dret[1] = dret[2] = 0;
+  for (j = -1; j < SEI_NFILEPARK; j++) {
+    if (j >= 0 && (swed.filepark == NULL || swed.filepark[j].fidat.fptr == NULL))
+      continue;
+    for (i = 0; i < SEI_NPLANETS; i++) {
+      pdp = (j < 0) ? &swed.pldat[i] : &swed.filepark[j].pldat[i];
+      if (pdp->preseg == NULL)
+	continue;
+      dret[0] += (double) pdp->npreseg * (pdp->ncoe * 3 * sizeof(double) + sizeof(int));
+      dret[1] += pdp->npreseg;
+      dret[2] += 1;
+    }
+  }
+}
+
+/* sets the number of asteroid files that are kept open besides the one
+ * in use; nfiles = 0 switches the pool off, nfiles < 0 sets the 
+ * default SEI_NASTPOOL_DFT. 
+ * Files in the pool are closed. */
+void CALL_CONV swe_set_ast_file_pool(int32 nfiles)
+{
+  swi_init_swed_if_start();
+  close_ast_pool(TRUE);
+  if (nfiles < 0)
+    swed.nastpool_req = 0;
+  else if (nfiles == 0)
+    swed.nastpool_req = -1;
+  else
+    swed.nastpool_req = nfiles;
 }
 
 int swi_get_observer(double tjd, int32 iflag, 
@@ -7729,17 +9004,8 @@ static int32 swi_fixstar_calc_from_record(char *srecord, double tjd, int32 iflag
     strcpy(serr, "Please call swe_set_ephe_path() or swe_set_jplfile() before calling swe_fixstar() or swe_fixstar_ut()");
   }
   if (swed.last_epheflag != epheflag) {
-    free_planets();
-    /* close and free ephemeris files */
-    if (swed.jpl_file_is_open) {
-      swi_close_jpl_file();
-      swed.jpl_file_is_open = FALSE;
-    }
-    for (i = 0; i < SEI_NEPHFILES; i ++) {
-      if (swed.fidat[i].fptr != NULL) 
-	fclose(swed.fidat[i].fptr);
-      memset((void *) &swed.fidat[i], 0, sizeof(struct file_data));
-    }
+    /* ephemeris files remain open, see free_positions() */
+    free_positions();
     swed.last_epheflag = epheflag;
   }
   /* high precision speed prevails fast speed */
@@ -8133,14 +9399,17 @@ int32 CALL_CONV swe_fixstar_mag(char *star, double *mag, char *serr)
 
 #endif
 
+#define PCTR_NBATCH	32	/* bodies per pass of swe_calc_pctr_bodies() */
+/* flags for the barycentric positions of swe_calc_pctr() */
+#define PCTR_IFLAG2(epheflag) ((epheflag) \
+	| SEFLG_BARYCTR | SEFLG_J2000 | SEFLG_ICRS | SEFLG_TRUEPOS \
+	| SEFLG_EQUATORIAL | SEFLG_XYZ | SEFLG_SPEED \
+	| SEFLG_NOABERR | SEFLG_NOGDEFL)
+
 int32 CALL_CONV swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag, double *xxret, char *serr) 
 {
-  double t = 0, dt, daya[2], dtsave_for_defl = 0;
-  double xx[6], xxctr[6], xxctr2[6], xx0[6], xxsv[24], xxsp[6], dx[6], xreturn[24];
-  double *xs;
-  int i, j, niter;
-  int32 iflag2, epheflag, retc;
-  struct epsilon *oe;
+  double xx[6], xxctr[6];
+  int32 epheflag;
   if (ipl == iplctr) {
     if (serr != NULL) 
 	  sprintf(serr, "ipl and iplctr (= %d) must not be identical\n", ipl);
@@ -8151,13 +9420,102 @@ int32 CALL_CONV swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag,
   // this fills in obliquity and nutation values in swed
   swe_calc(tjd + swe_deltat_ex(tjd, epheflag, serr), SE_ECL_NUT, iflag, xx, serr);
   iflag &= ~(SEFLG_HELCTR|SEFLG_BARYCTR);
-  iflag2 = epheflag;
-  iflag2 |= (SEFLG_BARYCTR|SEFLG_J2000|SEFLG_ICRS|SEFLG_TRUEPOS|SEFLG_EQUATORIAL|SEFLG_XYZ|SEFLG_SPEED);
-  iflag2 |= (SEFLG_NOABERR|SEFLG_NOGDEFL);
-  retc = swe_calc(tjd, iplctr, iflag2, xxctr, serr);
-  if (retc == ERR) 
+  if (swe_calc(tjd, iplctr, PCTR_IFLAG2(epheflag), xxctr, serr) == ERR) 
     return ERR;
-  retc = swe_calc(tjd, ipl, iflag2, xx, serr);
+  return calc_pctr(tjd, ipl, iplctr, iflag, xxctr, NULL, xxret, serr);
+}
+
+/* Planetocentric positions of several bodies, as seen from the same
+ * center iplctr, for one date. The results and return flags are the 
+ * same as with one call of swe_calc_pctr() for each body; xx must have
+ * room for 6 * nbodies doubles, iflgret (or NULL) for nbodies flags. 
+ * Nutation and the barycentric position of the center at tjd are 
+ * computed only once, and the barycentric positions of all bodies at
+ * tjd before their light-time corrections. The light-time and the 
+ * positions at the time of emission remain per body.
+ * The function returns OK or, if a body fails, ERR with the first 
+ * error message; the values of that body are 0.
+ */
+int32 CALL_CONV swe_calc_pctr_bodies(double tjd, int32 *ipl, int32 nbodies, int32 iplctr, int32 iflag, 
+	double *xx, int32 *iflgret, char *serr)
+{
+  double xxctr[6], x[6], xxipl[PCTR_NBATCH * 6];
+  int i, j, k, n;
+  int32 iflagi, epheflag, retflag, retval = OK;
+  AS_BOOL ctr_ok, ipl_ok[PCTR_NBATCH];
+  char serr1[AS_MAXCH], serrctr[AS_MAXCH];
+  if (serr != NULL)
+    *serr = '\0';
+  *serrctr = '\0';
+  iflagi = plaus_iflag(iflag, iplctr, tjd, NULL);
+  epheflag = iflagi & SEFLG_EPHMASK;
+  /* as in swe_calc_pctr(); the barycentric positions with 
+   * SEFLG_J2000 do not change the nutation, so it serves all bodies */
+  swe_calc(tjd + swe_deltat_ex(tjd, epheflag, NULL), SE_ECL_NUT, iflagi, x, NULL);
+  ctr_ok = (swe_calc(tjd, iplctr, PCTR_IFLAG2(epheflag), xxctr, serrctr) != ERR);
+  for (k = 0; k < nbodies; k += PCTR_NBATCH) {
+    n = nbodies - k;
+    if (n > PCTR_NBATCH)
+      n = PCTR_NBATCH;
+    /* first all bodies at tjd, which share the earth and sun of tjd;
+     * if one fails, calc_pctr() computes it again for the message */
+    for (i = 0; i < n && ctr_ok; i++) {
+      ipl_ok[i] = FALSE;
+      if (ipl[k + i] == iplctr)
+	continue;
+      iflagi = plaus_iflag(iflag, ipl[k + i], tjd, NULL);
+      ipl_ok[i] = (swe_calc(tjd, ipl[k + i], PCTR_IFLAG2(iflagi & SEFLG_EPHMASK), xxipl + 6 * i, NULL) != ERR);
+    }
+    for (i = 0; i < n; i++) {
+      *serr1 = '\0';
+      if (ipl[k + i] == iplctr) {
+	sprintf(serr1, "ipl and iplctr (= %d) must not be identical\n", ipl[k + i]);
+	retflag = ERR;
+      } else if (!ctr_ok) {
+	strcpy(serr1, serrctr);
+	retflag = ERR;
+      } else {
+	iflagi = plaus_iflag(iflag, ipl[k + i], tjd, serr1);
+	iflagi &= ~(SEFLG_HELCTR|SEFLG_BARYCTR);
+	retflag = calc_pctr(tjd, ipl[k + i], iplctr, iflagi, xxctr, 
+			    ipl_ok[i] ? xxipl + 6 * i : NULL, xx + 6 * (k + i), serr1);
+      }
+      if (retflag == ERR) {
+	for (j = 0; j < 6; j++)
+	  xx[6 * (k + i) + j] = 0;
+	if (retval != ERR && serr != NULL)
+	  strcpy(serr, serr1);
+	retval = ERR;
+      }
+      if (iflgret != NULL)
+	iflgret[k + i] = retflag;
+    }
+  }
+  return retval;
+}
+
+/* planetocentric position of ipl for swe_calc_pctr(), 
+ * iflag from plaus_iflag() without SEFLG_HELCTR|SEFLG_BARYCTR, 
+ * xxctr the barycentric position and speed of the center at tjd
+ * with flags PCTR_IFLAG2(); xxipl the same for ipl, or NULL.
+ */
+static int32 calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag, double *xxctr, double *xxipl, double *xxret, char *serr) 
+{
+  double t = 0, dt, daya[2], dtsave_for_defl = 0;
+  double xx[6], xxctr2[6], xx0[6], xxsv[24], xxsp[6], dx[6], xreturn[24];
+  double *xs;
+  int i, j, niter;
+  int32 iflag2, epheflag, retc;
+  struct epsilon *oe;
+  epheflag = iflag & SEFLG_EPHMASK;
+  iflag2 = PCTR_IFLAG2(epheflag);
+  if (xxipl != NULL) {
+    for (i = 0; i <= 5; i++)
+      xx[i] = xxipl[i];
+    retc = OK;
+  } else {
+    retc = swe_calc(tjd, ipl, iflag2, xx, serr);
+  }
   if (retc == ERR) 
     return ERR;
   for (i = 0; i <= 5; i++) {
@@ -8214,7 +9572,9 @@ int32 CALL_CONV swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag,
       for (i = 0; i <= 2; i++) 
         xxsp[i] = xx0[i] - xx[i] - xxsp[i];
     }
-    retc = swe_calc(t, iplctr, iflag2, xxctr2, serr);
+    /* the center at t is needed only for the speed of aberration */
+    if ((iflag & SEFLG_SPEED) && !(iflag & SEFLG_NOABERR))
+      retc = swe_calc(t, iplctr, iflag2, xxctr2, serr);
     retc = swe_calc(t, ipl, iflag2, xx, serr);
   }
   /*******************************
@@ -297,6 +297,8 @@
 #define KM_S_TO_AU_CTY	 21.095			/* km/s to AU/century */
 #define MOON_SPEED_INTV  0.00005 		/* 4.32 seconds (in days) */
 #define PLAN_SPEED_INTV  0.0001 	        /* 8.64 seconds (in days) */
+#define HOR_SPEED_INTV   0.0001 	        /* speed of azimuth and altitude */
+#define ARMC_SPEED       360.985647366	/* daily motion of sidereal time, in degrees */
 #define MEAN_NODE_SPEED_INTV  0.001		
 #define NODE_CALC_INTV  0.0001		
 #define NODE_CALC_INTV_MOSH   0.1		
@@ -645,7 +647,16 @@ struct plan_data {
 			 * the size is 3 x ncoe */
   int neval;		/* how many coefficients to evaluate. this may
 			 * be less than ncoe */
-  /* result of most recent data evaluation for this body: */
+  int32 *segidx;	/* file positions of the segments (nndx entries),
+			 * if the index was read by swe_prefetch() */
+  /* all segments of a time range, decoded and rotated back, 
+   * see swe_set_ephe_preload() */
+  double *preseg;	/* npreseg x 3 x ncoe coefficients */
+  int *preneval;	/* neval of each segment */
+  int32 preiseg0;	/* number of the first segment in the file */
+  int32 npreseg;	/* number of segments */
+  /* result of most recent data evaluation for this body 
+   * (teval must remain the first of these, see swap_plan_file_data()): */
   double teval;		/* time for which previous computation was made */
   int32 iephe;            /* which ephemeris was used */
   double x[6];		/* position and speed vectors equatorial J2000 */
@@ -677,6 +688,9 @@ extern int swi_moshplan(double tjd, int ipli, AS_BOOL do_save, double *xpret, do
 extern int swi_moshplan2(double J, int iplm, double *pobj);
 extern int swi_osc_el_plan(double tjd, double *xp, int ipl, int ipli, double *xearth, double *xsun, char *serr);
 extern FILE *swi_fopen(int ifno, char *fname, char *ephepath, char *serr);
+extern int swi_open_ephe_file(int ifno, char *fname, char *serr);
+extern int swi_read_segment_index(int ifno, char *serr);
+extern int swi_get_ephe_segment(int ifno, int ipli, int32 iseg, AS_BOOL rotate, char *serr);
 extern int32 swi_init_swed_if_start(void);
 extern int32 swi_set_tid_acc(double tjd_ut, int32 iflag, int32 denum, char *serr);
 extern int32 swi_get_tid_acc(double tjd_ut, int32 iflag, int32 denum, int32 *denumret, double *tid_acc, char *serr);
@@ -686,6 +700,7 @@ extern int32 swi_get_ayanamsa_ex_ut(double tjd_ut, int32 iflag, double *daya, ch
 extern int32 swi_get_ayanamsa_with_speed(double tjd_et, int32 iflag, double *daya, char *serr);
 
 extern double swi_armc_to_mc(double armc, double eps);
+extern void swi_equ2hor_armc(double armc, double *geopos, double atpress, double attemp, double *xin, double *xaz);
 
 extern int32 swi_get_denum(int32 ipli, int32 iflag);
 
@@ -720,6 +735,8 @@ struct file_data {
   int32 iflg; 		/* byte reorder flag and little/bigendian flag */
   short npl;		/* how many planets in file */
   int ipl[SEI_FILE_NMAXPLAN];	/* planet numbers */
+  AS_BOOL kept_open;	/* kept open across a change of the ephemeris
+			 * flag and not used since, see free_positions() */
 };
  
 struct gen_const {
@@ -730,10 +747,48 @@ struct gen_const {
 	sunradius;
 };
 
+/* open files of numbered asteroids and planetary moons besides the one
+ * in fidat[SEI_FILE_ANY_AST], see swe_set_ast_file_pool() */
+#define SEI_NASTPOOL_DFT	16	/* default number of parked files */
+
+struct ast_pool_entry {
+  int ipli;		/* body number, 0 if the entry is free */
+  uint32 iuse;		/* time of last use, for replacement */
+  struct file_data fidat;	/* the open file, as in fidat[SEI_FILE_ANY_AST] */
+  struct plan_data pldat;	/* constants and current segment of the body, 
+				 * as in pldat[SEI_ANYBODY] */
+  double ast_G, ast_H, ast_diam;	/* as in swed, from the file header */
+  char astelem[AS_MAXCH * 10];
+};
+
+/* files of other time ranges than the open ones, kept open for
+ * time scans that go back and forth across file boundaries */
+#define SEI_NFILEPARK	12
+
+struct file_park_entry {
+  int ifno;		/* file number SEI_FILE_PLANET etc. */
+  uint32 iuse;		/* time of last use, for replacement */
+  struct file_data fidat;	/* the open file, fptr == NULL if free */
+  struct plan_data pldat[SEI_NPLANETS];	/* data of the bodies in the 
+				 * file, as far as read from the file */
+};
+
+/* position cache of swe_calc(), see swe_set_calc_cache() */
+#define SEI_NSAVEPOS_DFT	64	/* default number of entries */
+#define SEI_NSAVEPOS_WAYS	4	/* entries per set; flag variants of the
+					 * same body and date share a set */
+
 struct save_positions {
   int ipl;
   double tsave;
-  int32 iflgsave;
+  int32 iflgsave;	/* flags returned by swecalc() */
+  int32 iflgreq;	/* flags requested, without coordinate system flags */
+  uint32 igen;		/* entry is valid if igen == swed.savepos_gen */
+  uint32 iuse;		/* time of last use, for replacement */
+  double geopos[3];	/* observer position, if SEFLG_TOPOCTR */
+  int32 sid_mode;	/* sidereal mode, if SEFLG_SIDEREAL */
+  double sid_t0;
+  double sid_ayan_t0;
   /* position at t = tsave,
    * in ecliptic polar (offset 0),
    *    ecliptic cartesian (offset 6), 
@@ -744,6 +799,86 @@ struct save_positions {
   double xsaves[24];    
 };
 
+/* cache of the ayanamshas that are derived from a star or from the 
+ * galactic pole or centre (SE_SIDM_TRUE_*, SE_SIDM_GALCENT_*, 
+ * SE_SIDM_GALEQU_*), see get_ayanamsa_star_cached() */
+#define SEI_NAYASEG		32	/* number of segments kept */
+#define SEI_AYASEG_LEN		16.0	/* length of a segment in days */
+#define SEI_AYASEG_NCF		16	/* Chebyshev coefficients per segment */
+#define SEI_AYASEG_NHITS	4	/* a segment is fitted with the 4th call */
+#define SEI_AYASEG_TAIL		1e-9	/* max. size of the last coefficients */
+#define SEI_AYASEG_TOL		1e-8	/* max. error at check point, degrees */
+
+#define SEI_AYASEG_COUNT	0	/* calls are counted, not fitted yet */
+#define SEI_AYASEG_FITTED	1	/* ayanamsha is taken from coefficients */
+#define SEI_AYASEG_DIRECT	2	/* fit failed, ayanamsha is computed */
+
+struct aya_segment {
+  uint32 igen;		/* segment is valid if igen == swed.savepos_gen */
+  int32 sid_mode;
+  int32 iflag;		/* flags of the star or galactic pole */
+  int32 iseg;		/* segment starts at J2000 + iseg * SEI_AYASEG_LEN */
+  int32 state;		/* SEI_AYASEG_COUNT, _FITTED, or _DIRECT */
+  int32 nhits;		/* number of calls in state SEI_AYASEG_COUNT */
+  int32 retflag;	/* return flag of swi_get_ayanamsa_ex() */
+  double coef[SEI_AYASEG_NCF];
+};
+
+/* last sidereal time, see swe_sidtime0() and swe_sidtime() */
+struct sidt_save {
+  uint32 igen;		/* valid if igen == swed.savepos_gen */
+  double tjd;		/* UT */
+  double gmst;		/* mean sidereal time, seconds */
+  double xlt[3];	/* long-term model: longitude of mean earth of date,
+			 * true obliquity, nutation in longitude, degrees */
+  uint32 igen_gast;	/* the same for swe_sidtime() */
+  double tjd_gast;
+  double gast;		/* apparent sidereal time, hours */
+};
+
+/* Chebyshev pre-fit of the true node, the osculating apogee and the
+ * interpolated apogee and perigee, written by swelunfit.c.
+ * The file starts with struct lunfit_head. It is followed by nseg
+ * segments of dseg days, each with SEI_LUNFIT_NPTS * 3 * ncoe doubles:
+ * for each point (in the order of SEI_TRUE_NODE, SEI_OSCU_APOG,
+ * SEI_INTP_APOG, SEI_INTP_PERG) the coefficients of longitude (radians,
+ * not normalized), latitude (radians) and distance (AU), ecliptic
+ * of date. The file is written in the byte order of the machine. */
+#define SE_FILE_LUNFIT		"selunfit.dat"
+#define SEI_LUNFIT_MAGIC	"SELUNFIT"
+#define SEI_LUNFIT_VERSION	1
+#define SEI_LUNFIT_NPTS		4
+#define SEI_LUNFIT_MAXCOE	32
+#define SEI_LUNFIT_DSEG		8.0	/* default segment length in days */
+#define SEI_LUNFIT_NCOE		12	/* default number of coefficients */
+/* node and osculating apogee depend on these flags; they are taken
+ * from the file only if none of them is set */
+#define SEI_LUNFIT_DIRECT_FLAGS	(SEFLG_TRUEPOS|SEFLG_NONUT|SEFLG_ICRS|SEFLG_JPLHOR|SEFLG_JPLHOR_APPROX)
+
+struct lunfit_head {
+  char magic[8];	/* SEI_LUNFIT_MAGIC, without terminating 0 */
+  int32 version;	/* SEI_LUNFIT_VERSION */
+  int32 test_endian;	/* SEI_FILE_TEST_ENDIAN */
+  int32 iephe;		/* ephemeris of node and osculating apogee */
+  int32 ncoe;		/* coefficients per coordinate */
+  int32 nseg;		/* number of segments */
+  int32 astro_models[SEI_NMODELS];	/* models the file was fitted with */
+  double tfstart;	/* start of first segment, ET */
+  double tfend;		/* tfstart + nseg * dseg */
+  double dseg;		/* segment length in days */
+  double maxerr[SEI_LUNFIT_NPTS][3];	/* max. deviation of the fit from
+			 * the direct computation, longitude and latitude
+			 * in radians, distance in AU */
+};
+
+struct lunfit_data {
+  FILE *fptr;
+  AS_BOOL is_tried;	/* file has been looked for */
+  struct lunfit_head head;
+  int32 iseg;		/* segment in coef, -1 if none */
+  double coef[SEI_LUNFIT_NPTS * 3 * SEI_LUNFIT_MAXCOE];
+};
+
 struct node_data {
   /* result of most recent data evaluation for this body: */
   double teval;		/* time for which last computation was made */
@@ -835,7 +970,23 @@ struct swe_data {
 #else
   struct plan_data nddat[SEI_NNODE_ETC];
 #endif
-  struct save_positions savedat[SE_NPLANETS+1];
+  struct save_positions *savedat;	/* position cache of swe_calc() */
+  int32 nsavedat;	/* number of entries allocated */
+  int32 nsavedat_req;	/* number of entries requested, 0 = default */
+  uint32 savepos_gen;	/* generation of valid entries */
+  uint32 savepos_clock;	/* counter of cache accesses */
+  double savepos_hits;
+  double savepos_misses;
+  double preload_tjd0, preload_tjd1;	/* see swe_set_ephe_preload() */
+  struct file_park_entry *filepark;	/* parked files of other time ranges */
+  uint32 filepark_clock;	/* counter of file changes */
+  struct ast_pool_entry *astpool;	/* parked asteroid files */
+  int32 nastpool;	/* number of entries allocated */
+  int32 nastpool_req;	/* entries requested, 0 = default, -1 = no pool */
+  uint32 astpool_clock;	/* counter of pool accesses */
+  struct aya_segment ayaseg[SEI_NAYASEG];	/* ayanamsha cache */
+  struct sidt_save sidtsave;	/* last sidereal time */
+  struct lunfit_data lunfit;	/* pre-fit of true node and apsides */
   struct epsilon oec;
   struct epsilon oec2000;
   struct nut nut;
@@ -366,6 +366,21 @@ extern "C" {
 #define SE_HOR2ECL		0
 #define SE_HOR2EQU		1
 
+/* for swe_calc_all_frames(): offsets of the coordinate frames in xx */
+#define SE_FRAME_ECL		0	/* ecliptic, polar */
+#define SE_FRAME_ECL_XYZ	6	/* ecliptic, cartesian */
+#define SE_FRAME_EQU		12	/* equatorial, polar */
+#define SE_FRAME_EQU_XYZ	18	/* equatorial, cartesian */
+#define SE_FRAME_SID		24	/* sidereal ecliptic, polar */
+#define SE_FRAME_HOR		30	/* azimuth, true and apparent altitude */
+#define SE_NFRAME_VALUES	36	/* size of xx */
+
+/* for swe_get_orbital_elements_array(): number of elements per body and date */
+#define SE_NORBEL_VALUES	17
+
+/* for swe_pheno_array(): number of values per body and date */
+#define SE_NPHENO_VALUES	6
+
 /* for swe_refrac() */
 #define SE_TRUE_TO_APP	0
 #define SE_APP_TO_TRUE	1
@@ -709,6 +724,23 @@ ext_def(int32) swe_calc_ut(double tjd_ut, int32 ipl, int32 iflag,
 
 ext_def(int32) swe_calc_pctr(double tjd, int32 ipl, int32 iplctr, int32 iflag, double *xxret, char *serr);
 
+ext_def(int32) swe_calc_pctr_bodies(double tjd, int32 *ipl, int32 nbodies, int32 iplctr, int32 iflag, 
+	double *xx, int32 *iflgret, char *serr);
+
+ext_def(int32) swe_calc_all_frames(double tjd, int32 ipl, int32 iflag, 
+	double *geopos, double atpress, double attemp, 
+	double *xx, char *serr);
+
+ext_def(int32) swe_calc_all_frames_ut(double tjd_ut, int32 ipl, int32 iflag, 
+	double *geopos, double atpress, double attemp, 
+	double *xx, char *serr);
+
+ext_def(int32) swe_calc_bodies(double tjd, int32 *ipl, int32 nbodies, int32 iflag, 
+	double *xx, int32 *iflgret, char *serr);
+
+ext_def(int32) swe_calc_bodies_ut(double tjd_ut, int32 *ipl, int32 nbodies, int32 iflag, 
+	double *xx, int32 *iflgret, char *serr);
+
 ext_def(double) swe_solcross(double x2cross, double jd_et, int32 flag, char *serr);
 ext_def(double) swe_solcross_ut(double x2cross, double jd_ut, int32 flag, char *serr);
 ext_def(double) swe_mooncross(double x2cross, double jd_et, int32 flag, char *serr);
@@ -767,6 +799,15 @@ ext_def(double) swe_get_ayanamsa_ut(double tjd_ut);
 ext_def(const char *) swe_get_ayanamsa_name(int32 isidmode);
 ext_def(const char *) swe_get_current_file_data(int ifno, double *tfstart, double *tfend, int *denum);
 
+/* size and statistics of the position cache of swe_calc() */
+ext_def(void) swe_set_calc_cache(int32 nentries);
+ext_def(void) swe_get_calc_cache_stats(double *dret);
+ext_def(void) swe_set_ast_file_pool(int32 nfiles);
+ext_def(int32) swe_prefetch(double tjd_start, double tjd_end, int32 body_mask, int32 iflag, char *serr);
+ext_def(void) swe_get_prefetch_stats(double *dret);
+ext_def(int32) swe_set_ephe_preload(double tjd_start, double tjd_end, char *serr);
+ext_def(void) swe_get_ephe_preload_stats(double *dret);
+
 /*ext_def(void) swe_set_timeout(int32 tsec);*/
 
 /**************************** 
@@ -803,6 +844,12 @@ ext_def(void) swe_jdut1_to_utc(
 	int32 *iyear, int32 *imonth, int32 *iday, 
 	int32 *ihour, int32 *imin, double *dsec);
 
+ext_def(int32) swe_utc_to_jd_array(double *tjd_day, double *dsec_day, int32 ntimes, double *dret, char *serr);
+
+ext_def(void) swe_jdet_to_utc_array(double *tjd_et, int32 ntimes, double *tjd_day, double *dsec_day);
+
+ext_def(void) swe_jdut1_to_utc_array(double *tjd_ut, int32 ntimes, double *tjd_day, double *dsec_day);
+
 ext_def(void) swe_utc_time_zone(
         int32 iyear, int32 imonth, int32 iday,
 	int32 ihour, int32 imin, double dsec,
@@ -889,6 +936,10 @@ ext_def (int32) swe_pheno(double tjd, int32 ipl, int32 iflag, double *attr, char
  
 ext_def(int32) swe_pheno_ut(double tjd_ut, int32 ipl, int32 iflag, double *attr, char *serr);
 
+ext_def (int32) swe_pheno_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *attr, char *serr);
+
+ext_def (int32) swe_pheno_ut_array(double *tjd_ut, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *attr, char *serr);
+
 ext_def (double) swe_refrac(double inalt, double atpress, double attemp, int32 calc_flag);
 
 ext_def (double) swe_refrac_extended(double inalt, double geoalt, double atpress, double attemp, double lapse_rate, int32 calc_flag, double *dret);
@@ -911,6 +962,10 @@ ext_def (void) swe_azalt_rev(
       double *xin, 
       double *xout); 
 
+ext_def (void) swe_azalt_array(double *tjd_ut, int32 ntimes, int32 calc_flag, double *geopos, double atpress, double attemp, double *xin, int32 ncoord, double *xaz);
+
+ext_def (void) swe_azalt_rev_array(double *tjd_ut, int32 ntimes, int32 calc_flag, double *geopos, double *xin, int32 ncoord, double *xout);
+
 ext_def (int32) swe_rise_trans_true_hor(
                double tjd_ut, int32 ipl, char *starname, 
 	       int32 epheflag, int32 rsmi,
@@ -944,6 +999,10 @@ ext_def (int32) swe_get_orbital_elements(
 
 ext_def (int32) swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32 iflag, double *dmax, double *dmin, double *dtrue, char *serr);
 
+ext_def (int32) swe_get_orbital_elements_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *dret, char *serr);
+
+ext_def (int32) swe_orbit_max_min_true_distance_array(double *tjd_et, int32 ntimes, int32 *ipl, int32 nbodies, int32 iflag, double *dret, char *serr);
+
 /**************************** 
  * exports from swephlib.c 
  ****************************/
@@ -951,6 +1010,7 @@ ext_def (int32) swe_orbit_max_min_true_distance(double tjd_et, int32 ipl, int32
 /* delta t */
 ext_def( double ) swe_deltat(double tjd);
 ext_def(double) swe_deltat_ex(double tjd, int32 iflag, char *serr);
+ext_def(void) swe_deltat_array(double *tjd, int32 ntimes, int32 iflag, double *deltat, char *serr);
 
 /* equation of time */
 ext_def(int32) swe_time_equ(double tjd, double *te, char *serr);
@@ -960,6 +1020,7 @@ ext_def(int32) swe_lat_to_lmt(double tjd_lat, double geolon, double *tjd_lmt, ch
 /* sidereal time */
 ext_def( double ) swe_sidtime0(double tjd_ut, double eps, double nut);
 ext_def( double ) swe_sidtime(double tjd_ut);
+ext_def( void ) swe_sidtime_array(double *tjd_ut, int32 ntimes, double *tsid);
 ext_def( void ) swe_set_interpolate_nut(AS_BOOL do_interpolate);
 
 /* coordinate transformation polar -> polar */
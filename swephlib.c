@@ -91,6 +91,9 @@ TLS int32 swi_trace_count = 0;
 
 static void init_crc32(void);
 static int init_dt(void);
+static void init_dt_polynomials(int tabsiz);
+static int32 deltat_tid_acc(double tjd, int32 iflag, double *tid_acc, char *serr);
+static double deltat_by_model(double tjd, double tid_acc);
 static double adjust_for_tidacc(double ans, double Y, double tid_acc, double tid_acc0, AS_BOOL adjust_after_1955);
 static double deltat_espenak_meeus_1620(double tjd, double tid_acc);
 static double deltat_stephenson_etc_2016(double tjd, double tid_acc);
@@ -2493,6 +2496,12 @@ static TLS double dt[TABSIZ_SPACE] = {
  * 2021 - 2028 */
                   69.2581,   69.50,   70.00,   70.50,   71.00,   71.50,   72.00,
 };
+/* Bessel interpolation of dt[] within year iy of the table, as polynomial
+ * of degree 4 in the fraction p of the year:
+ * dtcf[iy][0] + dtcf[iy][1] * p + ... + dtcf[iy][4] * p^4;
+ * computed by init_dt() from dt[], see deltat_aa() */
+static TLS double dtcf[TABSIZ_SPACE][5];
+static TLS int dt_tabsiz = 0;
 
 #define TAB2_SIZ	27
 #define TAB2_START	(-1000)
@@ -2544,21 +2553,44 @@ static const short dt97[TAB97_SIZ] = {
 #define DEMO 0
 static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
 {
-  double ans = 0;
-  double B, Y, Ygreg, dd;
-  int iy;
-  int32 retc;
-  int deltat_model = swed.astro_models[SE_MODEL_DELTAT];
   double tid_acc;
+  int32 retc;
+  int32 otherflag = iflag & ~SEFLG_EPHMASK;
+  retc = deltat_tid_acc(tjd, iflag, &tid_acc, serr);
+  *deltat = deltat_by_model(tjd, tid_acc);
+#ifdef TRACE
+  swi_open_trace(NULL);
+  if (swi_trace_count < TRACE_COUNT_MAX) {
+    if (swi_fp_trace_c != NULL) {
+      fputs("\n/*SWE_DELTAT*/\n", swi_fp_trace_c);
+      fprintf(swi_fp_trace_c, "  tjd = %.9f;", tjd);
+      fprintf(swi_fp_trace_c, "  iflag = %d;", iflag);
+      fprintf(swi_fp_trace_c, " t = swe_deltat_ex(tjd, iflag, NULL);\n");
+      fputs("  printf(\"swe_deltat: %f\\t%f\\t\\n\", ", swi_fp_trace_c);
+      fputs("tjd, t);\n", swi_fp_trace_c);
+      fflush(swi_fp_trace_c);
+    }
+    if (swi_fp_trace_out != NULL) {
+      fprintf(swi_fp_trace_out, "swe_deltat: %f\t%f\t\n", tjd, *deltat * 86400.0);
+      fflush(swi_fp_trace_out);
+    }
+  }
+#endif
+  return otherflag | retc;
+}
+
+/* tidal acceleration for delta t, see calc_deltat(); 
+ * it does not depend on tjd. Returns the ephemeris flag that 
+ * tid_acc is consistent with. */
+static int32 deltat_tid_acc(double tjd, int32 iflag, double *tid_acc, char *serr)
+{
+  int32 retc;
   int32 denum, denumret;
-  int32 epheflag, otherflag;
-//fprintf(stderr, "dmod=%f, %.f\n", (double) deltat_model, (double) SEMOD_DELTAT_DEFAULT);
-  if (deltat_model == 0) deltat_model = SEMOD_DELTAT_DEFAULT;
+  int32 epheflag;
   epheflag = iflag & SEFLG_EPHMASK;
-  otherflag = iflag & ~SEFLG_EPHMASK;
   /* with iflag == -1, we use default tid_acc */
   if (iflag == -1) {
-    retc = swi_get_tid_acc(tjd, 0, 9999, &denumret, &tid_acc, serr); /* for default tid_acc */
+    retc = swi_get_tid_acc(tjd, 0, 9999, &denumret, tid_acc, serr); /* for default tid_acc */
   /* otherwise we use tid_acc consistent with epheflag */
   } else {
     denum = swed.jpldenum;
@@ -2570,9 +2602,21 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
     } else {
       retc = swi_set_tid_acc(tjd, epheflag, denum, serr);  /* _set_ saves tid_acc in swed */
     }
-    tid_acc = swed.tid_acc;
+    *tid_acc = swed.tid_acc;
   }
-  iflag = otherflag | retc;
+  return retc;
+}
+
+/* delta t in days for tjd (UT) with the current delta t model 
+ * and the tidal acceleration tid_acc */
+static double deltat_by_model(double tjd, double tid_acc)
+{
+  double ans = 0;
+  double B, Y, Ygreg, dd;
+  int iy;
+  double deltat;
+  int deltat_model = swed.astro_models[SE_MODEL_DELTAT];
+  if (deltat_model == 0) deltat_model = SEMOD_DELTAT_DEFAULT;
   Y = 2000.0 + (tjd - J2000)/365.25;
   Ygreg = 2000.0 + (tjd - J2000)/365.2425;
   /* Model for epochs before 1955, currently default in Swiss Ephemeris:
@@ -2587,11 +2631,11 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
    * (or Astronomical Almanac K8-K9).
    */
   if (deltat_model == SEMOD_DELTAT_STEPHENSON_ETC_2016 && tjd < 2435108.5) { // tjd < 2432521.453645833) {
-    *deltat = deltat_stephenson_etc_2016(tjd, tid_acc);
+    deltat = deltat_stephenson_etc_2016(tjd, tid_acc);
     if (tjd >= 2434108.5) {
-      *deltat += (1.0 - (2435108.5 - tjd) / 1000.0) * 0.6610218 / 86400.0;
+      deltat += (1.0 - (2435108.5 - tjd) / 1000.0) * 0.6610218 / 86400.0;
     }
-    return iflag;
+    return deltat;
   }
   /* Model used SE 1.77 - 2.05.01, for epochs before 1633:
    * Polynomials by Espenak & Meeus 2006, 
@@ -2601,8 +2645,7 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
    * epochs, we use the data provided by Astronomical Almanac K8-K9.)
    */
   if (deltat_model == SEMOD_DELTAT_ESPENAK_MEEUS_2006 && tjd < 2317746.13090277789) {
-    *deltat = deltat_espenak_meeus_1620(tjd, tid_acc);
-    return iflag;
+    return deltat_espenak_meeus_1620(tjd, tid_acc);
   }
   /* delta t model used in SE 1.72 - 1.76:
    * Stephenson & Morrison 2004;
@@ -2610,8 +2653,7 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
   if (deltat_model == SEMOD_DELTAT_STEPHENSON_MORRISON_2004 && Y < TABSTART) {
     // before 1600: 
     if (Y < TAB2_END) {
-      *deltat = deltat_stephenson_morrison_2004_1600(tjd, tid_acc);
-      return iflag;
+      return deltat_stephenson_morrison_2004_1600(tjd, tid_acc);
     } else {
       /* between 1600 and 1620:
        * linear interpolation between 
@@ -2622,8 +2664,7 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
 	dd = (Y - TAB2_END) / B;
 	ans = dt2[iy] + dd * (dt[0] - dt2[iy]);
 	ans = adjust_for_tidacc(ans, Ygreg, tid_acc, SE_TIDAL_26, FALSE);
-	*deltat = ans / 86400.0;
-	return iflag;
+	return ans / 86400.0;
       }
     }
   }
@@ -2633,8 +2674,7 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
   if (deltat_model == SEMOD_DELTAT_STEPHENSON_1997 && Y < TABSTART) {
     // before 1600: 
     if (Y < TAB97_END) {
-      *deltat = deltat_stephenson_morrison_1997_1600(tjd, tid_acc);
-      return iflag;
+      return deltat_stephenson_morrison_1997_1600(tjd, tid_acc);
     } else {
       /* between 1600 and 1620:
        * linear interpolation between 
@@ -2645,8 +2685,7 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
 	dd = (Y - TAB97_END) / B;
 	ans = dt97[iy] + dd * (dt[0] - dt97[iy]);
 	ans = adjust_for_tidacc(ans, Ygreg, tid_acc, SE_TIDAL_26, FALSE);
-	*deltat = ans / 86400.0;
-	return iflag;
+	return ans / 86400.0;
       }
     }
   }
@@ -2664,8 +2703,7 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
       B = 0.01 * (Y - 2000.0)  +  3.75;
       ans = 35.0 * B * B  +  40.;
     }
-    *deltat = ans / 86400.0;
-    return iflag;
+    return ans / 86400.0;
   }
   /* 1620 - today + a few years (tabend):
    * Tabulated values of deltaT from Astronomical Almanac 
@@ -2673,29 +2711,9 @@ static int32 calc_deltat(double tjd, int32 iflag, double *deltat, char *serr)
    * (http://maia.usno.navy.mil/ser7/deltat.data).
    */
   if (Y >= TABSTART) {
-    *deltat = deltat_aa(tjd, tid_acc);
-    return iflag;
+    return deltat_aa(tjd, tid_acc);
   }
-#ifdef TRACE
-  swi_open_trace(NULL);
-  if (swi_trace_count < TRACE_COUNT_MAX) {
-    if (swi_fp_trace_c != NULL) {
-      fputs("\n/*SWE_DELTAT*/\n", swi_fp_trace_c);
-      fprintf(swi_fp_trace_c, "  tjd = %.9f;", tjd);
-      fprintf(swi_fp_trace_c, "  iflag = %d;", iflag);
-      fprintf(swi_fp_trace_c, " t = swe_deltat_ex(tjd, iflag, NULL);\n");
-      fputs("  printf(\"swe_deltat: %f\\t%f\\t\\n\", ", swi_fp_trace_c);
-      fputs("tjd, t);\n", swi_fp_trace_c);
-      fflush(swi_fp_trace_c);
-    }
-    if (swi_fp_trace_out != NULL) {
-      fprintf(swi_fp_trace_out, "swe_deltat: %f\t%f\t\n", tjd, ans);
-      fflush(swi_fp_trace_out);
-    }
-  }
-#endif
-  *deltat = ans / 86400.0;
-  return iflag;
+  return ans / 86400.0;
 }
 
 double CALL_CONV swe_deltat_ex(double tjd, int32 iflag, char *serr)
@@ -2715,6 +2733,26 @@ double CALL_CONV swe_deltat(double tjd)
   return swe_deltat_ex(tjd, iflag, NULL); /* with default tidal acceleration/default ephemeris */
 }
 
+/* delta t for ntimes dates tjd[] (UT), as with swe_deltat_ex(); 
+ * the tidal acceleration is determined once for all dates */
+void CALL_CONV swe_deltat_array(double *tjd, int32 ntimes, int32 iflag, double *deltat, char *serr)
+{
+  int32 i;
+  double tid_acc;
+  if (serr != NULL)
+    *serr = '\0';
+  if (swed.delta_t_userdef_is_set) {
+    for (i = 0; i < ntimes; i++)
+      deltat[i] = swed.delta_t_userdef;
+    return;
+  }
+  if (ntimes <= 0)
+    return;
+  deltat_tid_acc(tjd[0], iflag, &tid_acc, serr);
+  for (i = 0; i < ntimes; i++)
+    deltat[i] = deltat_by_model(tjd[i], tid_acc);
+}
+
 /* The tabulated values of deltaT, in hundredths of a second,
  * were taken from The Astronomical Almanac 1997etc., pp. K8-K9.  
  * Some more recent values are taken from IERS
@@ -2733,9 +2771,8 @@ double CALL_CONV swe_deltat(double tjd)
 static double deltat_aa(double tjd, double tid_acc)
 {
   double ans = 0, ans2 = 0, ans3;
-  double p, B, B2, Y, dd;
-  double d[6];
-  int i, iy, k;
+  double p, B, B2, Y, dd, *c;
+  int iy;
   /* read additional values from swedelta.txt */
   int tabsiz = init_dt();
   int tabend = TABSTART + tabsiz - 1;
@@ -2747,55 +2784,11 @@ static double deltat_aa(double tjd, double tid_acc)
      */
     p = floor(Y);
     iy = (int) (p - TABSTART);
-    /* Zeroth order estimate is value at start of year */
-    ans = dt[iy];
-    k = iy + 1;
-    if( k >= tabsiz )
-      goto done; /* No data, can't go on. */
     /* The fraction of tabulation interval */
     p = Y - p;
-    /* First order interpolated value */
-    ans += p*(dt[k] - dt[iy]);
-    if( (iy-1 < 0) || (iy+2 >= tabsiz) )
-      goto done; /* can't do second differences */
-    /* Make table of first differences */
-    k = iy - 2;
-    for( i=0; i<5; i++ ) {
-      if( (k < 0) || (k+1 >= tabsiz) ) 
-	d[i] = 0;
-      else
-	d[i] = dt[k+1] - dt[k];
-      k += 1;
-    }
-    /* Compute second differences */
-    for( i=0; i<4; i++ )
-      d[i] = d[i+1] - d[i];
-    B = 0.25*p*(p-1.0);
-    ans += B*(d[1] + d[2]);
-#if DEMO
-    printf( "B %.4lf, ans %.4lf\n", B, ans );
-#endif
-    if( iy+2 >= tabsiz )
-      goto done;
-    /* Compute third differences */
-    for( i=0; i<3; i++ )
-      d[i] = d[i+1] - d[i];
-    B = 2.0*B/3.0;
-    ans += (p-0.5)*B*d[1];
-#if DEMO
-    printf( "B %.4lf, ans %.4lf\n", B*(p-0.5), ans );
-#endif
-    if( (iy-2 < 0) || (iy+3 > tabsiz) )
-      goto done;
-    /* Compute fourth differences */
-    for( i=0; i<2; i++ )
-      d[i] = d[i+1] - d[i];
-    B = 0.125*B*(p+1.0)*(p-2.0);
-    ans += B*(d[0] + d[1]);
-#if DEMO
-    printf( "B %.4lf, ans %.4lf\n", B, ans );
-#endif
-    done:
+    /* Bessel interpolation, as polynomial computed by init_dt() */
+    c = dtcf[iy];
+    ans = c[0] + p * (c[1] + p * (c[2] + p * (c[3] + p * c[4])));
     ans = adjust_for_tidacc(ans, Y, tid_acc, SE_TIDAL_26, FALSE);
     return ans / 86400.0;
   }
@@ -3001,15 +2994,22 @@ double dtcf16[NDTCF16][6] =
 static double deltat_stephenson_etc_2016(double tjd, double tid_acc)
 {
   double t, dt, Ygreg;
-  int i, irec = -1;
+  int i, j, k, irec = -1;
   Ygreg = 2000.0 + (tjd - J2000)/365.2425;
-  // after the year -720 get value from spline curve
-  for (i = 0; i < NDTCF16; i++) {
-    if (tjd < dtcf16[i][0]) break;
-    if (tjd < dtcf16[i][1]) {
-      irec = i;
-      break;
+  // after the year -720 get value from spline curve;
+  // the records are contiguous, binary search for the last one 
+  // that starts before tjd
+  if (tjd >= dtcf16[0][0] && tjd < dtcf16[NDTCF16 - 1][1]) {
+    i = 0; 
+    j = NDTCF16 - 1;
+    while (i < j) {
+      k = (i + j + 1) / 2;
+      if (tjd < dtcf16[k][0]) 
+	j = k - 1;
+      else
+	i = k;
     }
+    irec = i;
   }
   if (irec >= 0) {
     t = (tjd - dtcf16[irec][0]) / (dtcf16[irec][1] - dtcf16[irec][0]);
@@ -3085,6 +3085,7 @@ static double deltat_espenak_meeus_1620(double tjd, double tid_acc)
 
 /* Read delta t values from external file.
 * record structure: year(whitespace)delta_t in 0.01 sec.
+* Returns the size of the table dt[]. 
 */
 static int init_dt(void)
 {
@@ -3098,38 +3099,95 @@ char *sp;
 if (!swed.init_dt_done) {
   swed.init_dt_done = TRUE;
   /* no error message if file is missing */
-  if ((fp = swi_fopen(-1, "swe_deltat.txt", swed.ephepath, NULL)) == NULL
-    && (fp = swi_fopen(-1, "sedeltat.txt", swed.ephepath, NULL)) == NULL)
-    return TABSIZ; 
-  while(fgets(s, AS_MAXCH, fp) != NULL) {
-    sp = s;
-    while (strchr(" \t", *sp) != NULL && *sp != '\0') 
-      sp++;	/* was *sp++  fixed by Alois 2-jul-2003 */
-    if (*sp == '#' || *sp == '\n')
-      continue;
-    year = atoi(s);
-    tab_index = year - TABSTART;
-    /* table space is limited. no error msg, if exceeded */
-    if (tab_index >= TABSIZ_SPACE)
-      continue; 
-    sp += 4;
-    while (strchr(" \t", *sp) != NULL && *sp != '\0')
-      sp++;	/* was *sp++  fixed by Alois 2-jul-2003 */
-    /*dt[tab_index] = (short) (atof(sp) * 100 + 0.5);*/
-    dt[tab_index] = atof(sp);
+  if ((fp = swi_fopen(-1, "swe_deltat.txt", swed.ephepath, NULL)) != NULL
+    || (fp = swi_fopen(-1, "sedeltat.txt", swed.ephepath, NULL)) != NULL) {
+    while(fgets(s, AS_MAXCH, fp) != NULL) {
+      sp = s;
+      while (strchr(" \t", *sp) != NULL && *sp != '\0') 
+	sp++;	/* was *sp++  fixed by Alois 2-jul-2003 */
+      if (*sp == '#' || *sp == '\n')
+	continue;
+      year = atoi(s);
+      tab_index = year - TABSTART;
+      /* table space is limited. no error msg, if exceeded */
+      if (tab_index >= TABSIZ_SPACE)
+	continue; 
+      sp += 4;
+      while (strchr(" \t", *sp) != NULL && *sp != '\0')
+	sp++;	/* was *sp++  fixed by Alois 2-jul-2003 */
+      /*dt[tab_index] = (short) (atof(sp) * 100 + 0.5);*/
+      dt[tab_index] = atof(sp);
+    }
+    fclose(fp);
   }
-  fclose(fp);
+  /* find table size */
+  tabsiz = 2001 - TABSTART + 1;
+  for (i = tabsiz - 1; i < TABSIZ_SPACE; i++) {
+    if (dt[i] == 0) 
+      break;
+    else
+      tabsiz++;
+  }
+  tabsiz--;
+  init_dt_polynomials(tabsiz);
+  dt_tabsiz = tabsiz;
 }
-/* find table size */
-tabsiz = 2001 - TABSTART + 1;
-for (i = tabsiz - 1; i < TABSIZ_SPACE; i++) {
-  if (dt[i] == 0) 
-    break;
-  else
-    tabsiz++;
+return dt_tabsiz;
 }
-tabsiz--;
-return tabsiz;
+
+/* Bessel's interpolation formula of fourth order for the table dt[], 
+ * written as polynomial in the fraction p of the year for each year 
+ * of the table (dtcf[]). Near the ends of the table, the orders that
+ * lack differences are left out.
+ * Note: B = p(p-1)/4; (p-0.5) * 2B/3 = (p^3 - 1.5p^2 + 0.5p) / 6;
+ * B/12 * (p+1)(p-2) = (p^4 - 2p^3 - p^2 + 2p) / 48.
+ */
+static void init_dt_polynomials(int tabsiz)
+{
+  int i, iy, k;
+  double d[6], *c;
+  for (iy = 0; iy < tabsiz; iy++) {
+    c = dtcf[iy];
+    /* Zeroth order estimate is value at start of year */
+    c[0] = dt[iy];
+    c[1] = c[2] = c[3] = c[4] = 0;
+    k = iy + 1;
+    if( k >= tabsiz )
+      continue; /* No data, can't go on. */
+    /* First order interpolated value */
+    c[1] = dt[k] - dt[iy];
+    if( (iy-1 < 0) || (iy+2 >= tabsiz) )
+      continue; /* can't do second differences */
+    /* Make table of first differences */
+    k = iy - 2;
+    for( i=0; i<5; i++ ) {
+      if( (k < 0) || (k+1 >= tabsiz) ) 
+	d[i] = 0;
+      else
+	d[i] = dt[k+1] - dt[k];
+      k += 1;
+    }
+    /* Compute second differences */
+    for( i=0; i<4; i++ )
+      d[i] = d[i+1] - d[i];
+    c[1] -= 0.25 * (d[1] + d[2]);
+    c[2] += 0.25 * (d[1] + d[2]);
+    /* Compute third differences */
+    for( i=0; i<3; i++ )
+      d[i] = d[i+1] - d[i];
+    c[1] += d[1] / 12.0;
+    c[2] -= d[1] / 4.0;
+    c[3] += d[1] / 6.0;
+    if( (iy-2 < 0) || (iy+3 > tabsiz) )
+      continue;
+    /* Compute fourth differences */
+    for( i=0; i<2; i++ )
+      d[i] = d[i+1] - d[i];
+    c[1] += (d[0] + d[1]) / 24.0;
+    c[2] -= (d[0] + d[1]) / 48.0;
+    c[3] -= (d[0] + d[1]) / 24.0;
+    c[4] += (d[0] + d[1]) / 48.0;
+  }
 }
 
 /* Astronomical Almanac table is corrected by adding the expression
@@ -3164,17 +3222,24 @@ double CALL_CONV swe_get_tid_acc()
  */
 void CALL_CONV swe_set_tid_acc(double t_acc)
 {
+  /* Delta T is used in topocentric positions, so saved positions
+   * are invalid */
   if (t_acc == SE_TIDAL_AUTOMATIC) {
+    if (swed.is_tid_acc_manual || swed.tid_acc != SE_TIDAL_DEFAULT)
+      swi_force_app_pos_etc();
     swed.tid_acc = SE_TIDAL_DEFAULT;
     swed.is_tid_acc_manual = FALSE;
     return;
   }
+  if (!swed.is_tid_acc_manual || swed.tid_acc != t_acc)
+    swi_force_app_pos_etc();
   swed.tid_acc = t_acc;
   swed.is_tid_acc_manual = TRUE;
 }
 
 void CALL_CONV swe_set_delta_t_userdef(double dt)
 {
+  swi_force_app_pos_etc();
   if (dt == SE_DELTAT_AUTOMATIC) {
     swed.delta_t_userdef_is_set = FALSE; 
   } else {
@@ -3282,10 +3347,14 @@ int32 swi_set_tid_acc(double tjd_ut, int32 iflag, int32 denum, char *serr)
  */
 /*#define SIDT_LTERM   TRUE
 #if SIDT_LTERM*/
-static double sidtime_long_term(double tjd_ut, double eps, double nut)
+/* part of the long-term sidereal time that does not depend on the 
+ * time of day or on the eps and nut given by the caller:
+ * xlt[0] longitude of the mean earth of date, xlt[1] true obliquity,
+ * xlt[2] nutation in longitude, all in degrees */
+static void sidtime_long_term_mean(double tjd_ut, double *xlt)
 {
-  double tsid = 0, tjd_et;
-  double dlon, xs[6], xobl[6], dhour, nutlo[2];
+  double tjd_et;
+  double dlon, xs[6], xobl[6], nutlo[2];
   double dlt = AUNIT / CLIGHT / 86400.0;
   double t, t2, t3;
   tjd_et = tjd_ut + swe_deltat_ex(tjd_ut, -1, NULL);
@@ -3310,16 +3379,24 @@ static double sidtime_long_term(double tjd_ut, double eps, double nut)
   xobl[2] = nutlo[0] * RADTODEG;
   swi_coortrf(xs, xs, xobl[1] * DEGTORAD);
   swi_cartpol(xs, xs);
-  xs[0] *= RADTODEG;
+  xlt[0] = xs[0] * RADTODEG;
+  xlt[1] = xobl[0];
+  xlt[2] = xobl[2];
+}
+
+static double sidtime_long_term(double tjd_ut, double eps, double nut, double *xlt)
+{
+  double tsid = 0;
+  double x, dhour;
   dhour = fmod(tjd_ut - 0.5, 1) * 360;
   /* mean to true (if nut != 0) */ 
   if (eps == 0)
-    xs[0] += xobl[2] * cos(xobl[0] * DEGTORAD);
+    x = xlt[0] + xlt[2] * cos(xlt[1] * DEGTORAD);
   else
-    xs[0] += nut * cos(eps * DEGTORAD);
+    x = xlt[0] + nut * cos(eps * DEGTORAD);
   /* add hour */
-  xs[0] = swe_degnorm(xs[0] + dhour);
-  tsid = xs[0] / 15;
+  x = swe_degnorm(x + dhour);
+  tsid = x / 15;
   return tsid;
 }
 /*#endif*/
@@ -3461,20 +3538,39 @@ static double sidtime_non_polynomial_part(double tt)
 #define SIDT_LTERM_T1  2469807.5  /* 1 Jan 2050  */
 #define SIDT_LTERM_OFS0   (0.000378172 / 15.0)
 #define SIDT_LTERM_OFS1   (0.001385646 / 15.0)
+/* 
+ * The mean sidereal time of the last date is saved, because houses
+ * for many places or rise and set for many objects are often computed 
+ * for the same time. It only depends on tjd and on the astronomical
+ * models and Delta T, whose changes clear the position cache of 
+ * swe_calc() and this value with it. Interpolated nutation depends
+ * on earlier calls, therefore nothing is saved with it.
+ */
 double CALL_CONV swe_sidtime0(double tjd, double eps, double nut)
 {
   double jd0;    	/* Julian day at midnight Universal Time */
   double secs;   	/* Time of day, UT seconds since UT midnight */
   double eqeq, jd, tu, tt, msday, jdrel;
   double gmst, dadd;
+  struct sidt_save *ss = &swed.sidtsave;
+  AS_BOOL is_saved;
   int prec_model_short = swed.astro_models[SE_MODEL_PREC_SHORTTERM];
   int sidt_model = swed.astro_models[SE_MODEL_SIDT];
   if (prec_model_short == 0) prec_model_short = SEMOD_PREC_DEFAULT_SHORT;
   if (sidt_model == 0) sidt_model = SEMOD_SIDT_DEFAULT;
   swi_init_swed_if_start();
+  if (swed.savepos_gen == 0)
+    swed.savepos_gen = 1;
+  is_saved = (ss->igen == swed.savepos_gen && ss->tjd == tjd 
+	      && !swed.do_interpolate_nut);
   if (sidt_model == SEMOD_SIDT_LONGTERM) {
     if (tjd <= SIDT_LTERM_T0 || tjd >= SIDT_LTERM_T1) {
-      gmst = sidtime_long_term(tjd, eps, nut);
+      if (!is_saved) {
+	sidtime_long_term_mean(tjd, ss->xlt);
+	ss->igen = swed.savepos_gen;
+	ss->tjd = tjd;
+      }
+      gmst = sidtime_long_term(tjd, eps, nut, ss->xlt);
       if (tjd <= SIDT_LTERM_T0)
 	gmst -= SIDT_LTERM_OFS0;
       else if (tjd >= SIDT_LTERM_T1)
@@ -3484,6 +3580,10 @@ double CALL_CONV swe_sidtime0(double tjd, double eps, double nut)
       goto sidtime_done;
     }
   }
+  if (is_saved) {
+    gmst = ss->gmst;
+    goto sidtime_eqeq;
+  }
   /* Julian day at given UT */
   jd = tjd;
   jd0 = floor(jd);
@@ -3524,6 +3624,10 @@ double CALL_CONV swe_sidtime0(double tjd, double eps, double nut)
     msday = 1.0 + ((-1.86e-5*tu + 0.186208)*tu + 8640184.812866)/(86400.*36525.);
     gmst += msday * secs;
   }
+  ss->igen = swed.savepos_gen;
+  ss->tjd = tjd;
+  ss->gmst = gmst;
+sidtime_eqeq:
   /* Local apparent sidereal time at given UT at Greenwich */
   eqeq = 240.0 * nut * cos(eps * DEGTORAD);
   gmst = gmst + eqeq  /* + 240.0*tlong */;
@@ -3559,6 +3663,7 @@ void CALL_CONV swe_set_interpolate_nut(AS_BOOL do_interpolate)
 {
   if (swed.do_interpolate_nut == do_interpolate)
     return;
+  swi_force_app_pos_etc();
   if (do_interpolate) 
     swed.do_interpolate_nut = TRUE;
   else
@@ -3582,6 +3687,13 @@ double CALL_CONV swe_sidtime(double tjd_ut)
   int i;
   double eps, nutlo[2], tsid;
   double tjde;
+  struct sidt_save *ss = &swed.sidtsave;
+  /* last result, see comment with swe_sidtime0() */
+  if (swed.savepos_gen == 0)
+    swed.savepos_gen = 1;
+  if (ss->igen_gast == swed.savepos_gen && ss->tjd_gast == tjd_ut 
+      && !swed.do_interpolate_nut)
+    return ss->gast;
   /* delta t adjusted to default tidal acceleration of the moon */
   tjde = tjd_ut + swe_deltat_ex(tjd_ut, -1, NULL); 
   swi_init_swed_if_start();
@@ -3590,9 +3702,85 @@ double CALL_CONV swe_sidtime(double tjd_ut)
   for (i = 0; i < 2; i++)
     nutlo[i] *= RADTODEG;
   tsid = swe_sidtime0(tjd_ut, eps + nutlo[1], nutlo[0]);
+  ss->igen_gast = swed.savepos_gen;
+  ss->tjd_gast = tjd_ut;
+  ss->gast = tsid;
   return tsid;
 }
 
+/* sidereal time for a series of dates, tjd_ut[] must be UT.
+ * Where the dates are dense (more than one date per SIDT_ARR_STEP 
+ * on average, or more dates in an interval than nodes to compute), 
+ * sidereal time minus the uniform earth rotation is interpolated 
+ * between values of swe_sidtime() at nodes J2000 + n * SIDT_ARR_STEP; 
+ * the rest of the dates are computed with swe_sidtime().
+ */
+#define SIDT_ARR_STEP	0.125	/* distance of interpolation nodes, days */
+#define SIDT_ARR_NSAVE	8	/* nodes kept, power of 2 */
+#define SIDT_ARR_DEGPD	(360.0 * 1.00273781191135448)	/* degrees per day */
+void CALL_CONV swe_sidtime_array(double *tjd_ut, int32 ntimes, double *tsid)
+{
+  int32 i, j, k, n, nnew;
+  AS_BOOL goes_on;
+  int32 knode[SIDT_ARR_NSAVE];
+  double snode[SIDT_ARR_NSAVE], d[4];
+  double t, tk, sk, dt, p, x;
+  for (j = 0; j < SIDT_ARR_NSAVE; j++)
+    knode[j] = -0x7fffffff;
+  for (i = 0; i < ntimes; i += n) {
+    n = 1;
+    t = floor((tjd_ut[i] - J2000) / SIDT_ARR_STEP);
+    if (fabs(t) > 1e8) {
+      tsid[i] = swe_sidtime(tjd_ut[i]);
+      continue;
+    }
+    /* dates between node k and node k + 1 */
+    k = (int32) t;
+    tk = J2000 + k * SIDT_ARR_STEP;
+    while (i + n < ntimes && floor((tjd_ut[i + n] - J2000) / SIDT_ARR_STEP) == t)
+      n++;
+    /* cubic interpolation needs the nodes k - 1 to k + 2 */
+    for (j = k - 1, nnew = 0; j <= k + 2; j++) {
+      if (knode[j & (SIDT_ARR_NSAVE - 1)] != j)
+	nnew++;
+    }
+    /* does the series go on in the adjacent interval? It needs 
+     * only one new node there. */
+    goes_on = (i + n < ntimes 
+      && fabs(floor((tjd_ut[i + n] - J2000) / SIDT_ARR_STEP) - t) == 1);
+    /* not more dates than nodes to compute, unless the series goes on 
+     * and there are two dates or one for one new node; or the 
+     * long-term model begins or ends between the nodes */
+    if ((n <= nnew && !(goes_on && (n >= 2 || n == nnew)))
+      || (tk - SIDT_ARR_STEP <= SIDT_LTERM_T0 && SIDT_LTERM_T0 <= tk + 2 * SIDT_ARR_STEP)
+      || (tk - SIDT_ARR_STEP <= SIDT_LTERM_T1 && SIDT_LTERM_T1 <= tk + 2 * SIDT_ARR_STEP)) {
+      for (j = i; j < i + n; j++)
+	tsid[j] = swe_sidtime(tjd_ut[j]);
+      continue;
+    }
+    for (j = k - 1; j <= k + 2; j++) {
+      if (knode[j & (SIDT_ARR_NSAVE - 1)] != j) {
+	snode[j & (SIDT_ARR_NSAVE - 1)] = swe_sidtime(J2000 + j * SIDT_ARR_STEP) * 15;
+	knode[j & (SIDT_ARR_NSAVE - 1)] = j;
+      }
+    }
+    /* deviations of the nodes from uniform rotation, degrees */
+    sk = snode[k & (SIDT_ARR_NSAVE - 1)];
+    for (j = 0; j < 4; j++) {
+      x = snode[(k - 1 + j) & (SIDT_ARR_NSAVE - 1)] - sk - SIDT_ARR_DEGPD * (j - 1) * SIDT_ARR_STEP;
+      d[j] = x - 360 * floor(x / 360 + 0.5);
+    }
+    for (j = i; j < i + n; j++) {
+      dt = tjd_ut[j] - tk;
+      p = dt / SIDT_ARR_STEP;
+      x = -p * (p - 1) * (p - 2) / 6 * d[0]
+	  - (p + 1) * p * (p - 2) / 2 * d[2]
+	  + (p + 1) * p * (p - 1) / 6 * d[3];
+      tsid[j] = swe_degnorm(sk + x + SIDT_ARR_DEGPD * dt) / 15;
+    }
+  }
+}
+
 /* SWISSEPH
  * generates name of ephemeris file
  * file name looks as follows:
@@ -4186,6 +4374,7 @@ void CALL_CONV swe_set_astro_models(char *samod, int32 iflag)
   double dversion;
   char s[30], *sp;
   swi_init_swed_if_start();
+  swi_force_app_pos_etc();
   if (*samod != '\0' && isdigit((int) *samod)) {
     set_astro_models(samod);
   } else if (*samod == '\0' || strncmp(samod, "SE", 2) == 0) {
@@ -0,0 +1,559 @@
+/********************************************************************
+swerepack.c
+
+Write a reduced copy of Swiss Ephemeris files (*.se1) with a subset 
+of the bodies and of the time range, for hosts with little memory or
+disk space.
+
+usage: swerepack -oDIR [options] file ...
+
+options: -oDIR	output directory (required); the files keep their
+		names, otherwise swe_calc() would not find them
+	 -bJD	start date (ET), default start of the file
+	 -eJD	end date (ET), default end of the file
+	 -pLIST	bodies to keep, comma separated swe_calc() numbers,
+		e.g. -p0,1,2,3,4,5,6,7,8,9; default all. The Earth and
+		the barycentric Sun of a planet file are always kept,
+		all positions depend on them.
+	 -aN	drop trailing Chebyshev coefficients whose sum is less
+		than N arc seconds, as seen from the center of the 
+		body's coordinates (the Sun for planets); geocentric 
+		positions of planets can differ by about three times 
+		as much. Default 0, i.e. only coefficients that are 
+		zero are dropped
+
+The segments are read with the code of swe_calc() (read_const(), 
+get_new_segment()), unrotated, and packed again in the same format:
+per coordinate the number of coefficients of 4, 3, 2 and 1 bytes and,
+if needed, of half and quarter bytes, followed by the coefficients
+as integers of rmax / 2 * 1e-9, with the sign in the lowest bit.
+Without -a, the unpacked coefficients are the same as those of the 
+original file. If the time range is shortened at the start, the segment
+start times are counted from the new start of the body and rounded
+differently, which changes positions by some 0.00003".
+The output is written in the byte order of the machine.
+It can be checked with sweverify.
+
+*********************************************************************/
+/* Copyright (C) 1997 - 2021 Astrodienst AG, Switzerland.  All rights reserved.
+
+  License conditions
+  ------------------
+
+  This file is part of Swiss Ephemeris.
+
+  Swiss Ephemeris is distributed with NO WARRANTY OF ANY KIND.  No author
+  or distributor accepts any responsibility for the consequences of using it,
+  or for whether it serves any particular purpose or works at all, unless he
+  or she says so in writing.
+
+  Swiss Ephemeris is made available by its authors under a dual licensing
+  system. The software developer, who uses any part of Swiss Ephemeris
+  in his or her software, must choose between one of the two license models,
+  which are
+  a) GNU Affero General Public License (AGPL)
+  b) Swiss Ephemeris Professional License
+
+  The choice must be made before the software developer distributes software
+  containing parts of Swiss Ephemeris to others, and before any public
+  service using the developed software is activated.
+
+  If the developer choses the AGPL software license, he or she must fulfill
+  the conditions of that license, which includes the obligation to place his
+  or her whole software project under the AGPL or a compatible license.
+  See https://www.gnu.org/licenses/agpl-3.0.html
+
+  If the developer choses the Swiss Ephemeris Professional license,
+  he must follow the instructions as found in http://www.astro.com/swisseph/
+  and purchase the Swiss Ephemeris Professional Edition from Astrodienst
+  and sign the corresponding license contract.
+
+  The License grants you the right to use, copy, modify and redistribute
+  Swiss Ephemeris, but only under certain conditions described in the License.
+  Among other things, the License requires that the copyright notices and
+  this notice be preserved on all copies.
+
+  Authors of the Swiss Ephemeris: Dieter Koch and Alois Treindl
+
+  The authors of Swiss Ephemeris have no control or influence over any of
+  the derived works, i.e. over software or services created by other
+  programmers which use Swiss Ephemeris functions.
+
+  The names of the authors or of the copyright holder (Astrodienst) must not
+  be used for promoting any software, product or service which uses or contains
+  the Swiss Ephemeris. This copyright notice is the ONLY place where the
+  names of the authors can legally appear, except in cases where they have
+  given special permission in writing.
+
+  The trademarks 'Swiss Ephemeris' and 'Swiss Ephemeris inside' may be used
+  for promoting such software, products or services.
+*/
+
+# include "swephexp.h"
+# include "sweph.h"
+# include "swephlib.h"
+
+/* output buffer; the file is assembled in memory, because the index
+ * and the header need the positions and the sizes of the segments */
+struct obuf {
+  unsigned char *p;
+  int32 n, size;
+};
+
+/* swe_calc() body numbers SE_SUN ... SE_VESTA -> internal numbers */
+static const int se2sei[] = {SEI_SUNBARY, SEI_MOON, SEI_MERCURY, SEI_VENUS, 
+  SEI_MARS, SEI_JUPITER, SEI_SATURN, SEI_URANUS, SEI_NEPTUNE, SEI_PLUTO, 
+  -1, -1, -1, -1, SEI_EMB, SEI_CHIRON, SEI_PHOLUS, SEI_CERES, SEI_PALLAS, 
+  SEI_JUNO, SEI_VESTA, };
+
+static char *arg0;
+static AS_BOOL bigendian;
+static double tjd_start = -1e10, tjd_end = 1e10;
+static double accuracy = 0;	/* arc seconds */
+static int nsel;		/* 0: all bodies */
+static int sel[SEI_FILE_NMAXPLAN];
+
+static void put_bytes(struct obuf *b, void *src, int len)
+{
+  if (b->n + len > b->size) {
+    b->size = (b->n + len) * 2 + 65536;
+    if ((b->p = (unsigned char *) realloc((void *) b->p, (size_t) b->size)) == NULL) {
+      fprintf(stderr, "%s: error in realloc()\n", arg0);
+      exit(1);
+    }
+  }
+  memcpy((void *) (b->p + b->n), src, (size_t) len);
+  b->n += len;
+}
+
+/* the lowest len bytes of v, as do_fread() reads them from a file 
+ * in the byte order of the machine */
+static void put_int(struct obuf *b, uint32 v, int len)
+{
+  unsigned char *c = (unsigned char *) &v;
+  if (bigendian)
+    c += 4 - len;
+  put_bytes(b, (void *) c, len);
+}
+
+static void set_int(struct obuf *b, int32 pos, uint32 v, int len)
+{
+  unsigned char *c = (unsigned char *) &v;
+  if (bigendian)
+    c += 4 - len;
+  memcpy((void *) (b->p + pos), (void *) c, (size_t) len);
+}
+
+static AS_BOOL selected(int ipl)
+{
+  int i;
+  if (nsel == 0 || ipl == SEI_EMB || ipl == SEI_SUNBARY)
+    return TRUE;
+  for (i = 0; i < nsel; i++)
+    if (sel[i] == ipl)
+      return TRUE;
+  return FALSE;
+}
+
+/* at most 15 coefficients per class; the first ones of a full class
+ * are moved into the next larger one. Returns the size in bytes. */
+static int fit_classes(int *nsize)
+{
+  int k;
+  for (k = 5; k > 0; k--) {
+    if (nsize[k] > 15) {
+      nsize[k-1] += nsize[k] - 15;
+      nsize[k] = 15;
+    }
+  }
+  return nsize[0] * 4 + nsize[1] * 3 + nsize[2] * 2 + nsize[3]
+    + (nsize[4] + 1) / 2 + (nsize[5] + 3) / 4;
+}
+
+/* number of coefficients to keep of the segment read last: trailing
+ * coefficients are dropped as long as the sum of their absolute values
+ * is <= tol in each coordinate. rot_back() does not evaluate the last
+ * coefficient that is not zero (neval), so with rotated bodies this 
+ * one counts as dropped, too. */
+static int keep_coefficients(struct plan_data *pdp, double tol)
+{
+  int i, k, n;
+  double sum;
+  for (n = pdp->ncoe; n > 1; n--) {
+    for (i = 0; i <= 2; i++) {
+      k = (pdp->iflg & SEI_FLG_ROTATE) ? n - 2 : n - 1;
+      for (sum = 0; k < pdp->ncoe; k++)
+	sum += fabs(pdp->segp[i * pdp->ncoe + k]);
+      if (sum > tol)
+	return n;
+    }
+  }
+  return n;
+}
+
+/* packs the first nkeep of the coefficients coef of one coordinate, 
+ * as get_new_segment() unpacks them. Returns the number of 
+ * coefficients written, without trailing zeros. */
+static int pack_coord(struct obuf *b, double *coef, int nkeep, double rmax)
+{
+  int i, j, k, n, bits, nco, need, cls[MAXORD+1], nsize[6], nsize4[6];
+  uint32 l[MAXORD+1], m;
+  unsigned char c;
+  double f = 2.0 / rmax * 1e9;
+  /* integers of rmax / 2 * 1e-9, odd if negative */
+  for (i = 0; i < nkeep; i++) {
+    if (fabs(coef[i]) * f >= 2147483647.0) {
+      fprintf(stderr, "%s: coefficient %e too large for rmax %f\n", arg0, coef[i], rmax);
+      exit(1);
+    }
+    m = (uint32) floor(fabs(coef[i]) * f + 0.5);
+    l[i] = (coef[i] < 0 && m > 0) ? 2 * m - 1 : 2 * m;
+  }
+  for (nco = nkeep; nco > 0 && l[nco-1] == 0; nco--)
+    ;
+  /* size class of each coefficient: 0 = 4 bytes, 1 = 3 bytes, 
+   * 2 = 2 bytes, 3 = 1 byte, 4 = half byte, 5 = quarter byte; 
+   * the classes must not decrease from one coefficient to the next */
+  for (i = 0; i < 6; i++)
+    nsize[i] = nsize4[i] = 0;
+  for (i = nco - 1; i >= 0; i--) {
+    if (l[i] >= 0x1000000) need = 0;
+    else if (l[i] >= 0x10000) need = 1;
+    else if (l[i] >= 0x100) need = 2;
+    else if (l[i] >= 0x10) need = 3;
+    else if (l[i] >= 0x4) need = 4;
+    else need = 5;
+    if (i < nco - 1 && cls[i+1] < need)
+      need = cls[i+1];
+    cls[i] = need;
+    nsize[need]++;
+    nsize4[need > 3 ? 3 : need]++;
+  }
+  /* half and quarter bytes need a header of 4 bytes instead of 2; 
+   * they are used only if this makes the segment smaller */
+  if (fit_classes(nsize4) + 2 <= fit_classes(nsize) + 4 && nsize4[0] < 8) {
+    for (k = 0; k < 6; k++)
+      nsize[k] = nsize4[k];
+  }
+  if (nsize[0] > 15) {
+    fprintf(stderr, "%s: more than 15 coefficients of 4 bytes\n", arg0);
+    exit(1);
+  }
+  if (nsize[4] > 0 || nsize[5] > 0 || nsize[0] >= 8) {
+    c = 128;
+    put_bytes(b, (void *) &c, 1);
+    for (k = 0; k < 6; k += 2) {
+      c = (unsigned char) (nsize[k] * 16 + nsize[k+1]);
+      put_bytes(b, (void *) &c, 1);
+    }
+  } else {
+    for (k = 0; k < 4; k += 2) {
+      c = (unsigned char) (nsize[k] * 16 + nsize[k+1]);
+      put_bytes(b, (void *) &c, 1);
+    }
+  }
+  i = 0;
+  for (k = 0; k < 4; k++) {
+    for (n = 0; n < nsize[k]; n++, i++)
+      put_int(b, l[i], 4 - k);
+  }
+  /* half bytes: the first coefficient in the upper half;
+   * quarter bytes: the first coefficient in the highest bits */
+  for (k = 4; k < 6; k++) {
+    bits = (k == 4) ? 4 : 2;
+    for (n = 0; n < nsize[k]; ) {
+      c = 0;
+      for (j = 8 - bits; j >= 0 && n < nsize[k]; j -= bits, n++, i++)
+	c += (unsigned char) (l[i] << j);
+      put_bytes(b, (void *) &c, 1);
+    }
+  }
+  return nco;
+}
+
+/* smallest distance of the body from the center during the segment 
+ * read last, rotated back */
+static double min_distance(struct plan_data *pdp)
+{
+  int i, j;
+  double x[3], r, rmin = 1e10;
+  for (j = -2; j <= 2; j++) {
+    for (i = 0; i <= 2; i++)
+      x[i] = swi_echeb(j * 0.5, pdp->segp + i * pdp->ncoe, pdp->neval);
+    r = sqrt(square_sum(x));
+    if (r < rmin)
+      rmin = r;
+  }
+  return rmin;
+}
+
+static void repack(char *fname, char *odir)
+{
+  int ifno, kpl, ipl, ipli, npl, i, nco, nkeep, nbytes_ipl, ncoe_new[SEI_FILE_NMAXPLAN];
+  int kp[SEI_FILE_NMAXPLAN];
+  int32 iseg, iseg0[SEI_FILE_NMAXPLAN], nseg[SEI_FILE_NMAXPLAN], *segpos[SEI_FILE_NMAXPLAN];
+  int32 pos_lndx[SEI_FILE_NMAXPLAN], pos_len, pos_crc, pos_seg, lng;
+  int32 ftext;
+  short nplan;
+  double t0, t1, tfstart, tfend, tb0[SEI_FILE_NMAXPLAN], tb1[SEI_FILE_NMAXPLAN];
+  double tol, d;
+  char serr[AS_MAXCH], s[AS_MAXCH * 2], oname[AS_MAXCH], *sp;
+  unsigned char astnam[30];
+  struct file_data *fdp;
+  struct plan_data *pdp;
+  struct obuf seg = {NULL, 0, 0}, out = {NULL, 0, 0};
+  FILE *fp;
+  /* output file name: same name, other directory */
+  sp = strrchr(fname, (int) *DIR_GLUE);
+  if (strlen(odir) + strlen(sp == NULL ? fname : sp) + 2 > AS_MAXCH) {
+    fprintf(stderr, "%s: output path too long\n", arg0);
+    exit(1);
+  }
+  if (sp == NULL ? strcmp(odir, ".") == 0 
+    : (strncmp(fname, odir, (size_t) (sp - fname)) == 0 && odir[sp - fname] == '\0')) {
+    fprintf(stderr, "%s: %s would be overwritten, give another directory with -o\n", arg0, fname);
+    exit(1);
+  }
+  sprintf(oname, "%s%s%s", odir, DIR_GLUE, sp == NULL ? fname : sp + 1);
+  ifno = SEI_FILE_ANY_AST;
+  sp = (sp == NULL) ? fname : sp + 1;
+  if (strncmp(sp, "sepl", 4) == 0)
+    ifno = SEI_FILE_PLANET;
+  else if (strncmp(sp, "semo", 4) == 0)
+    ifno = SEI_FILE_MOON;
+  else if (strncmp(sp, "seas", 4) == 0)
+    ifno = SEI_FILE_MAIN_AST;
+  else if (strncmp(sp, "sepm", 4) == 0)
+    ifno = SEI_FILE_PLMOON;
+  *serr = '\0';
+  if (swi_open_ephe_file(ifno, fname, serr) != OK) {
+    fprintf(stderr, "%s: %s\n", arg0, serr);
+    exit(1);
+  }
+  fdp = &swed.fidat[ifno];
+  /* segments of the selected bodies in the time range */
+  npl = 0;
+  tfstart = fdp->tfstart;
+  tfend = fdp->tfend;
+  for (kpl = 0; kpl < fdp->npl; kpl++) {
+    ipl = fdp->ipl[kpl];
+    if (!selected(ipl))
+      continue;
+    ipli = ipl >= SE_PLMOON_OFFSET ? SEI_ANYBODY : ipl;
+    pdp = &swed.pldat[ipli];
+    t0 = tjd_start > pdp->tfstart ? tjd_start : pdp->tfstart;
+    t1 = tjd_end < pdp->tfend ? tjd_end : pdp->tfend;
+    if (t0 > t1)
+      continue;
+    kp[npl] = kpl;
+    iseg0[npl] = (int32) ((t0 - pdp->tfstart) / pdp->dseg);
+    iseg = (int32) ((t1 - pdp->tfstart) / pdp->dseg);
+    if (iseg >= pdp->nndx)
+      iseg = pdp->nndx - 1;
+    nseg[npl] = iseg - iseg0[npl] + 1;
+    tb0[npl] = pdp->tfstart + iseg0[npl] * pdp->dseg;
+    tb1[npl] = tb0[npl] + nseg[npl] * pdp->dseg;
+    if (tb1[npl] > pdp->tfend)
+      tb1[npl] = pdp->tfend;
+    if (tb0[npl] > tfstart)
+      tfstart = tb0[npl];
+    if (tb1[npl] < tfend)
+      tfend = tb1[npl];
+    if ((segpos[npl] = (int32 *) malloc((size_t) nseg[npl] * sizeof(int32))) == NULL) {
+      fprintf(stderr, "%s: error in malloc()\n", arg0);
+      exit(1);
+    }
+    ncoe_new[npl] = 0;
+    for (iseg = 0; iseg < nseg[npl]; iseg++) {
+      tol = 0;
+      if (accuracy > 0) {
+	if (swi_get_ephe_segment(ifno, ipli, iseg0[npl] + iseg, TRUE, serr) != OK) {
+	  fprintf(stderr, "%s: %s\n", arg0, serr);
+	  exit(1);
+	}
+	/* error of each coordinate */
+	tol = accuracy / 3600 * DEGTORAD * min_distance(pdp) / sqrt(3.0);
+      }
+      if (swi_get_ephe_segment(ifno, ipli, iseg0[npl] + iseg, FALSE, serr) != OK) {
+	fprintf(stderr, "%s: %s\n", arg0, serr);
+	exit(1);
+      }
+      nkeep = pdp->ncoe;
+      if (accuracy > 0)
+	nkeep = keep_coefficients(pdp, tol);
+      segpos[npl][iseg] = seg.n;
+      for (i = 0; i <= 2; i++) {
+	nco = pack_coord(&seg, pdp->segp + i * pdp->ncoe, nkeep, pdp->rmax);
+	if (nco > ncoe_new[npl])
+	  ncoe_new[npl] = nco;
+      }
+    }
+    /* the reference ellipse has ncoe coefficients */
+    if ((pdp->iflg & SEI_FLG_ELLIPSE) || ncoe_new[npl] < 1)
+      ncoe_new[npl] = pdp->ncoe;
+    npl++;
+  }
+  if (npl == 0) {
+    printf("%s: no selected body in the time range, not written\n", fname);
+    swe_close();
+    return;
+  }
+  /* text lines of the header, copied */
+  fp = fdp->fptr;
+  fseek(fp, 0L, SEEK_SET);
+  for (i = 0; i < (ifno == SEI_FILE_ANY_AST ? 4 : 3); i++) {
+    if (fgets(s, AS_MAXCH * 2, fp) == NULL) {
+      fprintf(stderr, "%s: can't read %s\n", arg0, fname);
+      exit(1);
+    }
+    put_bytes(&out, (void *) s, (int) strlen(s));
+  }
+  ftext = out.n;
+  put_int(&out, SEI_FILE_TEST_ENDIAN, 4);
+  pos_len = out.n;
+  put_int(&out, 0, 4);
+  put_int(&out, (uint32) fdp->sweph_denum, 4);
+  put_bytes(&out, (void *) &tfstart, 8);
+  put_bytes(&out, (void *) &tfend, 8);
+  nbytes_ipl = 2;
+  for (i = 0; i < npl; i++)
+    if (fdp->ipl[kp[i]] > 65535)
+      nbytes_ipl = 4;
+  nplan = (short) (nbytes_ipl == 4 ? npl + 256 : npl);
+  put_bytes(&out, (void *) &nplan, 2);
+  for (i = 0; i < npl; i++)
+    put_int(&out, (uint32) fdp->ipl[kp[i]], nbytes_ipl);
+  /* name field of an asteroid file, after the planet numbers */
+  if (ifno == SEI_FILE_ANY_AST) {
+    fseek(fp, ftext + 28, SEEK_SET);
+    if (fread((void *) &nplan, 2, 1, fp) != 1) {
+      fprintf(stderr, "%s: can't read %s\n", arg0, fname);
+      exit(1);
+    }
+    if (fdp->iflg & SEI_FILE_REORD)
+      nplan = (short) (((nplan >> 8) & 0xff) | ((nplan & 0xff) << 8));
+    fseek(fp, ftext + 30 + fdp->npl * (nplan > 256 ? 4 : 2), SEEK_SET);
+    if (fread((void *) astnam, 30, 1, fp) != 1) {
+      fprintf(stderr, "%s: can't read %s\n", arg0, fname);
+      exit(1);
+    }
+    put_bytes(&out, (void *) astnam, 30);
+  }
+  pos_crc = out.n;
+  put_int(&out, 0, 4);
+  put_bytes(&out, (void *) &swed.gcdat.clight, 8);
+  put_bytes(&out, (void *) &swed.gcdat.aunit, 8);
+  put_bytes(&out, (void *) &swed.gcdat.helgravconst, 8);
+  put_bytes(&out, (void *) &swed.gcdat.ratme, 8);
+  put_bytes(&out, (void *) &swed.gcdat.sunradius, 8);
+  /* constants of the bodies */
+  for (i = 0; i < npl; i++) {
+    ipl = fdp->ipl[kp[i]];
+    ipli = ipl >= SE_PLMOON_OFFSET ? SEI_ANYBODY : ipl;
+    pdp = &swed.pldat[ipli];
+    pos_lndx[i] = out.n;
+    put_int(&out, 0, 4);
+    put_int(&out, (uint32) pdp->iflg, 1);
+    put_int(&out, (uint32) ncoe_new[i], 1);
+    if (ipl >= SE_PLMOON_OFFSET && ipl < SE_AST_OFFSET 
+      && ((ipl % 100) == 99 || (ipl - 9000) / 100 == SE_MARS))
+      lng = (int32) floor(pdp->rmax * 1000000.0 + 0.5);
+    else
+      lng = (int32) floor(pdp->rmax * 1000.0 + 0.5);
+    put_int(&out, (uint32) lng, 4);
+    put_bytes(&out, (void *) &tb0[i], 8);
+    put_bytes(&out, (void *) &tb1[i], 8);
+    put_bytes(&out, (void *) &pdp->dseg, 8);
+    put_bytes(&out, (void *) &pdp->telem, 8);
+    put_bytes(&out, (void *) &pdp->prot, 8);
+    put_bytes(&out, (void *) &pdp->dprot, 8);
+    put_bytes(&out, (void *) &pdp->qrot, 8);
+    put_bytes(&out, (void *) &pdp->dqrot, 8);
+    put_bytes(&out, (void *) &pdp->peri, 8);
+    put_bytes(&out, (void *) &pdp->dperi, 8);
+    if (pdp->iflg & SEI_FLG_ELLIPSE)
+      put_bytes(&out, (void *) pdp->refep, (int) (2 * pdp->ncoe * sizeof(double)));
+  }
+  /* indices, then the segments */
+  for (i = 0, pos_seg = out.n; i < npl; i++)
+    pos_seg += nseg[i] * 3;
+  for (i = 0; i < npl; i++) {
+    set_int(&out, pos_lndx[i], (uint32) out.n, 4);
+    for (iseg = 0; iseg < nseg[i]; iseg++)
+      put_int(&out, (uint32) (pos_seg + segpos[i][iseg]), 3);
+    free((void *) segpos[i]);
+  }
+  if (pos_seg + seg.n >= 0x1000000) {
+    fprintf(stderr, "%s: %s too large for 3-byte file positions\n", arg0, oname);
+    exit(1);
+  }
+  put_bytes(&out, (void *) seg.p, seg.n);
+  set_int(&out, pos_len, (uint32) out.n, 4);
+  set_int(&out, pos_crc, swi_crc32(out.p, (int) pos_crc), 4);
+  if ((fp = fopen(oname, BFILE_W_CREATE)) == NULL) {
+    fprintf(stderr, "%s: can't open %s\n", arg0, oname);
+    exit(1);
+  }
+  if (fwrite((void *) out.p, (size_t) out.n, 1, fp) != 1 || fclose(fp) != 0) {
+    fprintf(stderr, "%s: error writing %s\n", arg0, oname);
+    remove(oname);
+    exit(1);
+  }
+  fseek(fdp->fptr, 0L, SEEK_END);
+  d = (double) ftell(fdp->fptr);
+  printf("%s: %d bodies, JD %.1f - %.1f, %d bytes (%.1f%% of %s)\n", oname, 
+    npl, tfstart, tfend, out.n, out.n / d * 100, fname);
+  free((void *) out.p);
+  free((void *) seg.p);
+  swe_close();
+}
+
+int main(int argc, char **argv)
+{
+  int i, ipl, nfiles = 0;
+  uint32 one = 1;
+  char odir[AS_MAXCH] = "", *sp;
+  arg0 = argv[0];
+  bigendian = (*(unsigned char *) &one == 0);
+  for (i = 1; i < argc; i++) {
+    if (*argv[i] != '-') {
+      nfiles++;
+    } else if (strncmp(argv[i], "-o", 2) == 0) {
+      strncpy(odir, argv[i] + 2, AS_MAXCH - 1);
+    } else if (strncmp(argv[i], "-b", 2) == 0) {
+      tjd_start = atof(argv[i] + 2);
+    } else if (strncmp(argv[i], "-e", 2) == 0) {
+      tjd_end = atof(argv[i] + 2);
+    } else if (strncmp(argv[i], "-a", 2) == 0) {
+      accuracy = atof(argv[i] + 2);
+    } else if (strncmp(argv[i], "-p", 2) == 0) {
+      for (sp = argv[i] + 2; *sp != '\0' && nsel < SEI_FILE_NMAXPLAN; ) {
+	ipl = atoi(sp);
+	if (ipl >= SE_PLMOON_OFFSET)
+	  sel[nsel++] = ipl;
+	else if (ipl >= 0 && ipl <= SE_VESTA && se2sei[ipl] >= 0)
+	  sel[nsel++] = se2sei[ipl];
+	else {
+	  fprintf(stderr, "%s: body %d not in Swiss Ephemeris files\n", arg0, ipl);
+	  exit(1);
+	}
+	while (*sp != ',' && *sp != '\0')
+	  sp++;
+	if (*sp == ',')
+	  sp++;
+      }
+    } else {
+      fprintf(stderr, "%s: illegal option %s\n", arg0, argv[i]);
+      exit(1);
+    }
+  }
+  if (nfiles == 0 || *odir == '\0' || tjd_end < tjd_start || accuracy < 0) {
+    fprintf(stderr, "usage: %s -oDIR [-bJD] [-eJD] [-pLIST] [-aN] file ...\n", arg0);
+    exit(1);
+  }
+  for (i = 1; i < argc; i++) {
+    if (*argv[i] != '-')
+      repack(argv[i], odir);
+  }
+  return 0;
+}
@@ -125,6 +125,10 @@ static char *infocmd1 = "\n\
                 for example -s15m for a time step of 15 minutes.\n\
                 If an 's' is appended, the time step is in seconds instead of days, \n\
                 for example -s1s for a time step of 1 second.\n\
+        -jobsN  compute the time steps of option -n in N parallel jobs,\n\
+                each with its own ephemeris files; the output is printed\n\
+                in the original order. The line limit applies per job.\n\
+                Not available on Windows.\n\
 ";
 static char *infocmd2 = "\
      output format:\n\
@@ -675,6 +679,9 @@ static char *infoexamp = "\n\
 #  include <console.h>
 # else
 #  include <sys/stat.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#  define USE_JOBS	/* option -jobsN: date range split into parallel jobs */
 # endif
 #endif
 
@@ -706,6 +713,8 @@ static char *infoexamp = "\n\
 
 #define SEARCH_RANGE_LUNAR_CYCLES 20000
 
+#define NJOBS_MAX   256 // max. number of parallel jobs with option -jobs
+
 #define LEN_SOUT    1000 // length of output string variable
 #define SIND(x) sin((x) * DEGTORAD)
 #define COSD(x) cos((x) * DEGTORAD)
@@ -734,6 +743,13 @@ static int cut_str_any(char *s, char *cutlist, char *cpos[], int nmax);
 static int32 call_swe_fixstar(char *star, double te, int32 iflag, double *x, char *serr);
 static void jd_to_time_string(double jut, char *stimeout);
 static char *our_strcpy(char *to, char *from);
+static void set_swe_state(char *ephepath, char *fname, int32 sid_mode, double aya_t0, double aya_val0, AS_BOOL do_ayanamsa, double tid_acc);
+static double get_step_date(double tjd, double t, double tstep, int32 istep);
+static void set_gregflag(double t, char *sdate);
+#ifdef USE_JOBS
+static int start_jobs(int32 *istep_beg, int32 *istep_end);
+static void end_job(void);
+#endif
 
 /* globals shared between main() and print_line() */
 static char *fmt = "PLBRS";
@@ -775,6 +791,8 @@ static AS_BOOL step_in_months = FALSE;
 static int32 helflag = 0;
 static double tjd = 2415020.5;
 static int32 nstep = 1, istep;
+static int32 njobs = 1;
+static AS_BOOL is_job = FALSE;
 static int32 search_flag = 0;
 static char sout[LEN_SOUT];
 static int32 whicheph = SEFLG_SWIEPH;   
@@ -822,6 +840,7 @@ int main(int argc, char *argv[])
   char hostname[80];
 #endif
   int i, j, n, iflag_f = -1, iflgt;
+  int32 istep_beg, istep_end;
   int line_count, line_limit = 36525; // days in a century
   double daya;
   double top_long = 0.0;	/* Greenwich UK */
@@ -928,6 +947,12 @@ int main(int argc, char *argv[])
       iflag |= SEFLG_TEST_PLMOON;
     } else if (strcmp(argv[i], "-jplhor") == 0) {
       iflag |= SEFLG_JPLHOR;
+    } else if (strncmp(argv[i], "-jobs", 5) == 0) {
+      njobs = atoi(argv[i]+5);
+      if (njobs < 1)
+	njobs = 1;
+      if (njobs > NJOBS_MAX)
+	njobs = NJOBS_MAX;
     } else if (strncmp(argv[i], "-j", 2) == 0) {
       begindate = argv[i] + 1;
     } else if (strncmp(argv[i], "-ejpl", 5) == 0) {
@@ -1297,31 +1322,10 @@ int main(int argc, char *argv[])
       whicheph = SEFLG_MOSEPH;
     }
   }
-  if (whicheph != SEFLG_MOSEPH) 
-    swe_set_ephe_path(ephepath);
-  if (whicheph & SEFLG_JPLEPH)
-    swe_set_jpl_file(fname);
-  /* the following is only a test feature */
-  if (do_set_astro_models) {
-    swe_set_astro_models(astro_models, iflag); /* secret test feature for dieter */
-    swe_get_astro_models(astro_models, smod, iflag);
-  }
-#if 1
-  if (inut) /* Astrodienst internal feature */
-    swe_set_interpolate_nut(TRUE);
-#endif
-  if ((iflag & SEFLG_SIDEREAL) || do_ayanamsa) {
-    if (sid_mode & SE_SIDM_USER) 
-      swe_set_sid_mode(sid_mode, aya_t0, aya_val0);
-    else
-      swe_set_sid_mode(sid_mode, 0, 0);
-  }
   geopos[0] = top_long;
   geopos[1] = top_lat;
   geopos[2] = top_elev;
-  swe_set_topo(top_long, top_lat, top_elev);
-  if (tid_acc != 0) 
-    swe_set_tid_acc(tid_acc); 
+  set_swe_state(ephepath, fname, sid_mode, aya_t0, aya_val0, do_ayanamsa, tid_acc);
   serr[0] = serr_save[0] = serr_warn[0] = '\0';
   while (TRUE) {
     if (begindate == NULL) {
@@ -1429,30 +1433,28 @@ int main(int argc, char *argv[])
       return OK;
     }
     line_count = 0;
-    for (t = tjd, istep = 1; istep <= nstep; t += tstep, istep++) {
-      if (step_in_minutes) 
-        t = tjd + (istep -1) * tstep / 1440;
-      if (step_in_seconds) 
-        t = tjd + (istep -1) * tstep / 86400;
-      if (step_in_years) {
-	swe_revjul(tjd, gregflag, &jyear, &jmon, &jday, &jut);
-	t = swe_julday(jyear + (istep - 1) * (int) tstep, jmon, jday, jut, gregflag);
-      }
-      if (step_in_months) {
-	swe_revjul(tjd, gregflag, &jyear, &jmon, &jday, &jut);
-	jmon += (istep - 1) * (int) tstep;
-	jyear += (int) ((jmon - 1) / 12);
-	jmon = ((jmon - 1) % 12) + 1;
-	t = swe_julday(jyear, jmon, jday, jut, gregflag);
-      }
-      if (t < 2299160.5)
-        gregflag = SE_JUL_CAL;
-      else
-        gregflag = SE_GREG_CAL;
-      if (strstr(sdate, "jul") != NULL)
-        gregflag = SE_JUL_CAL;
-      else if (strstr(sdate, "greg") != NULL)
-        gregflag = SE_GREG_CAL;
+    istep_beg = 1;
+    istep_end = nstep;
+#ifdef USE_JOBS
+    if (njobs > 1 && nstep > 1) {
+      /* start_jobs() closes all ephemeris files before forking,
+       * jobs and parent reopen them here */
+      start_jobs(&istep_beg, &istep_end);
+      set_swe_state(ephepath, fname, sid_mode, aya_t0, aya_val0, do_ayanamsa, tid_acc);
+      if (istep_beg > 1 && !with_header_always)
+	with_header = FALSE;
+    }
+#endif
+    /* the steps before istep_beg are repeated without output,
+     * so that a job starting with step istep_beg gets exactly
+     * the same dates and calendar as a single process */
+    for (t = tjd, istep = 1; istep < istep_beg; t += tstep, istep++) {
+      t = get_step_date(tjd, t, tstep, istep);
+      set_gregflag(t, sdate);
+    }
+    for (; istep <= istep_end; t += tstep, istep++) {
+      t = get_step_date(tjd, t, tstep, istep);
+      set_gregflag(t, sdate);
       delt = swe_deltat_ex(t, iflag, serr);
       if (!universal_time) {
 	delt = swe_deltat_ex(t - delt, iflag, serr);
@@ -1970,6 +1972,10 @@ int main(int argc, char *argv[])
         break;
       }
     }           /* for tjd */
+#ifdef USE_JOBS
+    if (is_job)
+      end_job();
+#endif
     if (*serr_warn != '\0') {
       printf("\nwarning: ");
       fputs(serr_warn,stdout);
@@ -1985,6 +1991,158 @@ int main(int argc, char *argv[])
   return  OK;
 }
 
+/* sets ephemeris path and files, sidereal mode, topocentric position etc.
+ * as requested on the command line */
+static void set_swe_state(char *ephepath, char *fname, int32 sid_mode, double aya_t0, double aya_val0, AS_BOOL do_ayanamsa, double tid_acc)
+{
+  if (whicheph != SEFLG_MOSEPH) 
+    swe_set_ephe_path(ephepath);
+  if (whicheph & SEFLG_JPLEPH)
+    swe_set_jpl_file(fname);
+  /* the following is only a test feature */
+  if (do_set_astro_models) {
+    swe_set_astro_models(astro_models, iflag); /* secret test feature for dieter */
+    swe_get_astro_models(astro_models, smod, iflag);
+  }
+#if 1
+  if (inut) /* Astrodienst internal feature */
+    swe_set_interpolate_nut(TRUE);
+#endif
+  if ((iflag & SEFLG_SIDEREAL) || do_ayanamsa) {
+    if (sid_mode & SE_SIDM_USER) 
+      swe_set_sid_mode(sid_mode, aya_t0, aya_val0);
+    else
+      swe_set_sid_mode(sid_mode, 0, 0);
+  }
+  swe_set_topo(geopos[0], geopos[1], geopos[2]);
+  if (tid_acc != 0) 
+    swe_set_tid_acc(tid_acc); 
+}
+
+/* date of time step istep of option -n; t is the date of the
+ * previous step plus tstep. Steps in years and months are counted
+ * in the calendar of the previous step, i.e. with gregflag as it
+ * was set by set_gregflag() for that step. */
+static double get_step_date(double tjd, double t, double tstep, int32 istep)
+{
+  if (step_in_minutes) 
+    t = tjd + (istep -1) * tstep / 1440;
+  if (step_in_seconds) 
+    t = tjd + (istep -1) * tstep / 86400;
+  if (step_in_years) {
+    swe_revjul(tjd, gregflag, &jyear, &jmon, &jday, &jut);
+    t = swe_julday(jyear + (istep - 1) * (int) tstep, jmon, jday, jut, gregflag);
+  }
+  if (step_in_months) {
+    swe_revjul(tjd, gregflag, &jyear, &jmon, &jday, &jut);
+    jmon += (istep - 1) * (int) tstep;
+    jyear += (int) ((jmon - 1) / 12);
+    jmon = ((jmon - 1) % 12) + 1;
+    t = swe_julday(jyear, jmon, jday, jut, gregflag);
+  }
+  return t;
+}
+
+/* calendar of date t, unless the date argument sdate 
+ * contains "jul" or "greg" */
+static void set_gregflag(double t, char *sdate)
+{
+  if (t < 2299160.5)
+    gregflag = SE_JUL_CAL;
+  else
+    gregflag = SE_GREG_CAL;
+  if (strstr(sdate, "jul") != NULL)
+    gregflag = SE_JUL_CAL;
+  else if (strstr(sdate, "greg") != NULL)
+    gregflag = SE_GREG_CAL;
+}
+
+#ifdef USE_JOBS
+static FILE *job_fwarn = NULL;
+
+/* Splits the time steps 1 ... nstep of option -n into njobs ranges
+ * and forks one job process for each of them. A job writes its
+ * output into a temporary file and returns with its range in
+ * istep_beg, istep_end.
+ * The parent waits for the jobs, prints their output in the original
+ * order, and returns with the range it still has to compute itself;
+ * this range is empty, unless a job could not be started.
+ * All ephemeris files are closed before forking, because jobs
+ * must not share file positions. The caller has to reopen them. */
+static int start_jobs(int32 *istep_beg, int32 *istep_end)
+{
+  int32 ij, nj, nper, nrest, ibeg, iend;
+  pid_t pid[NJOBS_MAX];
+  FILE *fout[NJOBS_MAX], *fwarn[NJOBS_MAX];
+  char s[AS_MAXCH];
+  size_t n;
+  int status;
+  AS_BOOL job_failed = FALSE;
+  nj = njobs;
+  if (nj > nstep)
+    nj = nstep;
+  nper = nstep / nj;
+  nrest = nstep % nj;
+  swe_close();
+  fflush(stdout);
+  for (ij = 0, ibeg = 1; ij < nj; ij++, ibeg = iend + 1) {
+    iend = ibeg + nper - 1;
+    if (ij < nrest)
+      iend++;
+    fout[ij] = tmpfile();
+    fwarn[ij] = tmpfile();
+    if (fout[ij] == NULL || fwarn[ij] == NULL
+      || (pid[ij] = fork()) < 0) {
+      if (fout[ij] != NULL) fclose(fout[ij]);
+      if (fwarn[ij] != NULL) fclose(fwarn[ij]);
+      break;
+    }
+    if (pid[ij] == 0) {	/* job process */
+      dup2(fileno(fout[ij]), fileno(stdout));
+      job_fwarn = fwarn[ij];
+      is_job = TRUE;
+      *istep_beg = ibeg;
+      *istep_end = iend;
+      return 1;
+    }
+  }
+  nj = ij;
+  for (ij = 0; ij < nj; ij++) {
+    if (waitpid(pid[ij], &status, 0) < 0 
+      || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      job_failed = TRUE;
+    rewind(fout[ij]);
+    while ((n = fread(s, 1, AS_MAXCH, fout[ij])) > 0)
+      fwrite(s, 1, n, stdout);
+    fclose(fout[ij]);
+    rewind(fwarn[ij]);
+    if (*serr_warn == '\0') {
+      n = fread(serr_warn, 1, AS_MAXCH - 1, fwarn[ij]);
+      serr_warn[n] = '\0';
+    }
+    fclose(fwarn[ij]);
+    /* a sequential run would have stopped here */
+    if (job_failed) {
+      fflush(stdout);
+      exit(1);
+    }
+  }
+  *istep_beg = ibeg;
+  *istep_end = nstep;
+  return 0;
+}
+
+/* terminates a job process started by start_jobs() */
+static void end_job(void)
+{
+  fflush(stdout);
+  fputs(serr_warn, job_fwarn);
+  fflush(job_fwarn);
+  swe_close();
+  exit(0);
+}
+#endif
+
 static int32 call_swe_fixstar(char *star, double te, int32 iflag, double *x, char *serr)
 {
   if (use_swe_fixstar2) 
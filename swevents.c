@@ -96,6 +96,10 @@ static char *info = "\n\
 		number is given, the default is 20.\n\
 	-sN	timestep N days, default 1. This option is only meaningful\n\
 		when combined with option -n.\n\
+	-jobsN	with -doasp or -dovoc: compute the search in N parallel\n\
+		jobs; the result is the same as with one job.\n\
+	-vN	with -dovoc: void of course method N = 1, 2, 3;\n\
+		-v0 outputs all three methods, default is 1.\n\
 	-edirPATH change the directory of the ephemeris files \n\
 	-cycol.. number cycles per column\n\
 	-doall | -doingr etc : do just that\n\
@@ -185,6 +189,11 @@ static char *info = "\n\
 #include "sweph.h"
 #include "swevents.h"
 #include <time.h>
+#if !MSDOS
+# include <sys/mman.h>
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
 
 #define MAX_LINES       67
 #define MAX_COLS        2
@@ -261,6 +270,12 @@ char *stit = "Planetary Phenomena";
 # define   EPHEPATH "/home/ephe"
 #endif
 
+char ephepath[AS_MAXCH] = EPHEPATH;
+char fname[80] = "de431.eph";
+int njobs = 1;
+int vocmethod = 1;
+#define NJOBS_MAX 256
+
 static char *dms(double x, int iflag);
 static int find_zero(double y00, double y11, double y2, double dx, 
 			double *dxret, double *dxret2);
@@ -271,7 +286,6 @@ static int print_motab();
 
 // from old swevents.c
 static char *hms(double x, int32 iflag);
-static int32 get_next_voc(double tet0, int32 iflag, int32 vocmethod, VOC *pvoc, char *serr);
 static int32 calc_all_crossings(
               int32 iflag,    /* swiss ephemeris flags */
               int32 itype,    /* type of calculation:
@@ -288,7 +302,7 @@ static int32 calc_all_crossings(
               struct event *pev,  /* struct for output */
               char *serr      /* error string */
              );
-static int32 calc_all_voc(int32 iflag, double te, double tend, char *serr);
+static int32 calc_all_voc(int32 iflag, double te, double tend, int32 vocmethod, char *serr);
 static int32 extract_data_of_day(int32 do_flag, double te, double dtol, char *splan, char *sasp, EVENT *pev, char *serr);
 static int letter_to_ipl(int letter);
 
@@ -341,8 +355,6 @@ int main(int argc, char *argv[])
   double attr[20];
   double xel, xma, sunrad;
   double dt, dt1, dt2, elong, rphel;
-  char ephepath[AS_MAXCH] = EPHEPATH;
-  char fname[80] = "de431.eph";
   char *begindate = NULL;
   int iflag = SEFLG_RADIANS | SEFLG_SPEED;   /* external flag: helio, geo... */
   int nzer, iflgret;
@@ -389,6 +401,13 @@ int main(int argc, char *argv[])
       do_flag |= DO_ASPECTS;
     } else if (strcmp(argv[i], "-dovoc") == 0) {
       do_flag |= DO_VOC;
+    } else if (strncmp(argv[i], "-jobs", 5) == 0) {
+      njobs = atoi(argv[i] + 5);
+      if (njobs < 1) njobs = 1;
+      if (njobs > NJOBS_MAX) njobs = NJOBS_MAX;
+    } else if (strncmp(argv[i], "-v", 2) == 0 && isdigit((int) argv[i][2])) {
+      vocmethod = atoi(argv[i] + 2);
+      if (vocmethod > 3) vocmethod = 1;
     } else if (strcmp(argv[i], "-getday") == 0) {
       get_data_of_day = TRUE;
     } else if (strcmp(argv[i], "-et") == 0) {
@@ -642,7 +661,7 @@ int main(int argc, char *argv[])
     /* moon void of course */
     if (do_flag & DO_VOC) {
       tend = te + nstep;
-      if (calc_all_voc(iflag, te, tend, serr) == ERR) {
+      if (calc_all_voc(SEFLG_SPEED, te, tend, vocmethod, serr) == ERR) {
 	fprintf(stderr, "%s\n", serr);
 	return ERR;
       }
@@ -2084,76 +2103,731 @@ static int pev_compare(const EVENT *a1, const EVENT *a2)
 #define NSTARS_MAX 30
 #define NMAXPL 50
 #define NEAR_CROSSING_ORB 1
+#define NSTEP_BLOCK 1000	/* time steps per block of precomputed positions */
 #define FOUTNAM   "sweasp.dat"
 #define PATH_FOUTNAM   "."
 
-static int read_sweasp_dat(char *foutnam) 
+static void sweasp_get_rec(char *p, struct sweasp_rec *prec)
 {
-  FILE *fpout;
-  char serr[AS_MAXCH];
-  int32 flen = 0, headerlen = 0;
-  int32 i, nrec = 0, ipla, iplb, iasp;
-  double tjd, dasp, tjd_pre, tjd_post;
-  int jyear, jmon, jday;
-  double jut, dorb, dur;
-  char s[AS_MAXCH], *sp;
-  char spl1[30], spl2[30];
-  /* open aspects file */
-  if ((fpout = fopen(foutnam, BFILE_R_ACCESS)) == NULL) {
+  memcpy((void *) &prec->tjd, p, sizeof(double)); p += sizeof(double);
+  memcpy((void *) &prec->ipla, p, sizeof(int32)); p += sizeof(int32);
+  memcpy((void *) &prec->iplb, p, sizeof(int32)); p += sizeof(int32);
+  memcpy((void *) &prec->iasp, p, sizeof(int32)); p += sizeof(int32);
+  memcpy((void *) &prec->dasp, p, sizeof(double)); p += sizeof(double);
+  memcpy((void *) &prec->dorb, p, sizeof(double)); p += sizeof(double);
+  memcpy((void *) &prec->tjd_pre, p, sizeof(double)); p += sizeof(double);
+  memcpy((void *) &prec->tjd_post, p, sizeof(double));
+}
+
+static void sweasp_put_rec(char *p, struct sweasp_rec *prec)
+{
+  memcpy(p, (void *) &prec->tjd, sizeof(double)); p += sizeof(double);
+  memcpy(p, (void *) &prec->ipla, sizeof(int32)); p += sizeof(int32);
+  memcpy(p, (void *) &prec->iplb, sizeof(int32)); p += sizeof(int32);
+  memcpy(p, (void *) &prec->iasp, sizeof(int32)); p += sizeof(int32);
+  memcpy(p, (void *) &prec->dasp, sizeof(double)); p += sizeof(double);
+  memcpy(p, (void *) &prec->dorb, sizeof(double)); p += sizeof(double);
+  memcpy(p, (void *) &prec->tjd_pre, sizeof(double)); p += sizeof(double);
+  memcpy(p, (void *) &prec->tjd_post, sizeof(double));
+}
+
+/* record irec of aspect database */
+static void sweasp_db_rec(struct sweasp_db *pdb, int32 irec, struct sweasp_rec *prec)
+{
+  sweasp_get_rec(pdb->prec + (size_t) irec * SWEASP_DAT_RECLEN, prec);
+}
+
+/* Opens aspect database and maps it into memory (on systems without mmap()
+ * the file is read). The database can be shared by several processes. */
+static int open_sweasp_db(char *foutnam, struct sweasp_db *pdb, char *serr)
+{
+  FILE *fp;
+  struct sweasp_head *ph = &pdb->head;
+  long flen;
+  memset((void *) pdb, 0, sizeof(struct sweasp_db));
+  if ((fp = fopen(foutnam, BFILE_R_ACCESS)) == NULL) {
     sprintf(serr, "could not open file %s", foutnam);
     return ERR;
   }
-  while (fgets(s, AS_MAXCH, fpout) != NULL && (sp = strchr(s, '\n')) != NULL) {
-    headerlen += strlen(s);
-    if (strncmp(s, "####", 4) == 0) 
-      break;
+  if (fread((void *) ph, sizeof(struct sweasp_head), 1, fp) != 1
+    || strncmp(ph->magic, SWEASP_MAGIC, sizeof(ph->magic)) != 0 || ph->version != SWEASP_VERSION) {
+    sprintf(serr, "file %s has an old or unknown format, recompute it with -doasp", foutnam);
+    fclose(fp);
+    return ERR;
   }
-  if (fseek(fpout, 0L, SEEK_END) != 0) {
+  if (ph->endian != SWEASP_TEST_ENDIAN || ph->reclen != SWEASP_DAT_RECLEN) {
+    sprintf(serr, "file %s was created on a machine with different byte order", foutnam);
+    fclose(fp);
+    return ERR;
+  }
+  if (fseek(fp, 0L, SEEK_END) != 0 || (flen = ftell(fp)) <= 0) {
     sprintf(serr, "fseek failed (SEEK_END): %s", foutnam);
+    fclose(fp);
     return ERR;
   }
-  flen = ftell(fpout) - headerlen;
-  nrec = flen / 52;
-  if (fseek(fpout, headerlen, SEEK_SET) != 0) {
-    sprintf(serr, "fseek failed (SEEK_SET): %s", foutnam);
+  if (flen < ph->fpos_plist + (long) ph->nrec * (long) sizeof(int32)) {
+    sprintf(serr, "file %s is truncated", foutnam);
+    fclose(fp);
+    return ERR;
+  }
+  pdb->flen = (size_t) flen;
+#if !MSDOS
+  pdb->fbuf = (char *) mmap(NULL, pdb->flen, PROT_READ, MAP_SHARED, fileno(fp), 0);
+  if (pdb->fbuf == (char *) MAP_FAILED)
+    pdb->fbuf = NULL;
+  else
+    pdb->is_mapped = TRUE;
+#endif
+  if (pdb->fbuf == NULL) {
+    if ((pdb->fbuf = (char *) malloc(pdb->flen)) == NULL) {
+      sprintf(serr, "error in malloc() for %s", foutnam);
+      fclose(fp);
+      return ERR;
+    }
+    if (fseek(fp, 0L, SEEK_SET) != 0 || fread(pdb->fbuf, 1, pdb->flen, fp) != pdb->flen) {
+      sprintf(serr, "error while trying to read %s", foutnam);
+      free(pdb->fbuf);
+      pdb->fbuf = NULL;
+      fclose(fp);
+      return ERR;
+    }
+  }
+  fclose(fp);
+  pdb->prec = pdb->fbuf + ph->fpos_rec;
+  pdb->tindex = (int32 *) (pdb->fbuf + ph->fpos_tindex);
+  pdb->pindex = (struct sweasp_pair *) (pdb->fbuf + ph->fpos_pindex);
+  pdb->plist = (int32 *) (pdb->fbuf + ph->fpos_plist);
+  return OK;
+}
+
+static void close_sweasp_db(struct sweasp_db *pdb)
+{
+  if (pdb->fbuf == NULL)
+    return;
+#if !MSDOS
+  if (pdb->is_mapped)
+    munmap((void *) pdb->fbuf, pdb->flen);
+  else
+#endif
+    free(pdb->fbuf);
+  pdb->fbuf = NULL;
+}
+
+/* number of first record with time of exactness >= tjd;
+ * nrec if there is none */
+static int32 sweasp_first_rec(struct sweasp_db *pdb, double tjd)
+{
+  struct sweasp_head *ph = &pdb->head;
+  struct sweasp_rec rec;
+  int32 ib, i0, i1, im;
+  if (tjd <= ph->tjd_beg)
+    return 0;
+  if (tjd > ph->tjd_end)
+    return ph->nrec;
+  ib = (int32) ((tjd - ph->tjd_beg) / ph->tbucket);
+  if (ib >= ph->nbucket)
+    ib = ph->nbucket - 1;
+  /* binary search within bucket */
+  i0 = pdb->tindex[ib];
+  i1 = pdb->tindex[ib + 1];
+  while (i0 < i1) {
+    im = (i0 + i1) / 2;
+    sweasp_db_rec(pdb, im, &rec);
+    if (rec.tjd < tjd)
+      i0 = im + 1;
+    else
+      i1 = im;
+  }
+  return i0;
+}
+
+/* number of next record after irec with the same body pair;
+ * -1 if there is none */
+static int32 sweasp_next_rec_of_pair(struct sweasp_db *pdb, int32 irec, int32 ipla, int32 iplb)
+{
+  struct sweasp_pair *pp;
+  int32 *plist;
+  int32 i0 = 0, i1 = pdb->head.npair, im;
+  /* find body pair */
+  while (i0 < i1) {
+    im = (i0 + i1) / 2;
+    pp = &pdb->pindex[im];
+    if (pp->ipla < ipla || (pp->ipla == ipla && pp->iplb < iplb))
+      i0 = im + 1;
+    else
+      i1 = im;
+  }
+  if (i0 >= pdb->head.npair)
+    return -1;
+  pp = &pdb->pindex[i0];
+  if (pp->ipla != ipla || pp->iplb != iplb)
+    return -1;
+  /* find first record number > irec in list of pair */
+  plist = pdb->plist + pp->ilist;
+  i0 = 0; i1 = pp->nlist;
+  while (i0 < i1) {
+    im = (i0 + i1) / 2;
+    if (plist[im] <= irec)
+      i0 = im + 1;
+    else
+      i1 = im;
+  }
+  if (i0 >= pp->nlist)
+    return -1;
+  return plist[i0];
+}
+
+static int read_sweasp_dat(char *foutnam) 
+{
+  char serr[AS_MAXCH];
+  int32 i;
+  struct sweasp_db db;
+  struct sweasp_rec rec;
+  double tjd;
+  int jyear, jmon, jday;
+  double jut, dur;
+  char s[AS_MAXCH];
+  char spl1[30], spl2[30];
+  /* open aspects file */
+  if (open_sweasp_db(foutnam, &db, serr) == ERR) {
+    fprintf(stderr, "%s\n", serr);
     return ERR;
   }
 dur = 0;
-  for (i = 0; i < nrec; i++) {
-    fread((void *) &tjd, sizeof(double), 1, fpout);
-    fread((void *) &ipla, sizeof(int32), 1, fpout);
-    fread((void *) &iplb, sizeof(int32), 1, fpout);
-    fread((void *) &iasp, sizeof(int32), 1, fpout);
-    fread((void *) &dasp, sizeof(double), 1, fpout);
-    fread((void *) &dorb, sizeof(double), 1, fpout);
-    fread((void *) &tjd_pre, sizeof(double), 1, fpout);
-    fread((void *) &tjd_post, sizeof(double), 1, fpout);
+  for (i = 0; i < db.head.nrec; i++) {
+    sweasp_db_rec(&db, i, &rec);
 if ((0)) { /* test output find longest possible aspect duration */
-if (ipla <= 9 && tjd_pre > 0 && tjd_post > 0 && tjd_post - tjd_pre > dur) {
-  dur = tjd_post - tjd_pre;
+if (rec.ipla <= 9 && rec.tjd_pre > 0 && rec.tjd_post > 0 && rec.tjd_post - rec.tjd_pre > dur) {
+  dur = rec.tjd_post - rec.tjd_pre;
   fprintf(stderr, "dur = %f\n", dur);
 } else {
   continue;
 }
 }
-    swe_get_planet_name(ipla, spl1);
-    swe_get_planet_name(iplb, spl2);
-/*    if (ipla == SE_FIXSTAR) 
-      strcpy(spl1, stara);
-    if (iplb == SE_FIXSTAR) 
-      strcpy(spl2, starb);*/
+    swe_get_planet_name(rec.ipla, spl1);
+    swe_get_planet_name(rec.iplb, spl2);
     spl1[3] = '\0';
     spl2[3] = '\0';
-    tjd -= swe_deltat(tjd);  /* now we have UT */
+    tjd = rec.tjd - swe_deltat(rec.tjd);  /* now we have UT */
     swe_revjul(tjd, 1, &jyear, &jmon, &jday, &jut);
-    sprintf(s, "%d/%02d/%02d %s: %s - %s ang=%.0f, orb=%.4f, %.5f, %.5f, %.5f", jyear, jmon, jday, hms(jut, BIT_LZEROES), spl1, spl2, dasp, dorb, tjd, tjd_pre, tjd_post);
+    sprintf(s, "%d/%02d/%02d %s: %s - %s ang=%.0f, orb=%.4f, %.5f, %.5f, %.5f", jyear, jmon, jday, hms(jut, BIT_LZEROES), spl1, spl2, rec.dasp, rec.dorb, tjd, rec.tjd_pre, rec.tjd_post);
     strcat(s, "\n");
     fprintf(stderr, s);
   }
-  fclose(fpout);
+  close_sweasp_db(&db);
   return OK;
 }
 
+static int sweasp_rec_compare(const struct sweasp_rec *a1, const struct sweasp_rec *a2)
+{
+  if (a1->tjd > a2->tjd)
+    return 1;
+  if (a1->tjd < a2->tjd)
+    return -1;
+  return 0;
+}
+
+static int sweasp_pair_compare(const struct sweasp_pair *p1, const struct sweasp_pair *p2)
+{
+  if (p1->ipla != p2->ipla)
+    return p1->ipla > p2->ipla ? 1 : -1;
+  if (p1->iplb != p2->iplb)
+    return p1->iplb > p2->iplb ? 1 : -1;
+  /* ilist holds the record number before the list is built */
+  if (p1->ilist != p2->ilist)
+    return p1->ilist > p2->ilist ? 1 : -1;
+  return 0;
+}
+
+/* Completes aspect database: sorts the records written by 
+ * calc_mundane_aspects() by time, appends time index and body pair index
+ * and writes the file header. */
+static int write_sweasp_index(FILE *fpout, int32 fpos_text, int32 fpos_rec, char *serr)
+{
+  struct sweasp_head head;
+  struct sweasp_rec *rec = NULL;
+  struct sweasp_pair *pair = NULL;
+  int32 *tindex = NULL, *plist = NULL;
+  char *buf = NULL;
+  int32 i, k, nrec, npair, nbucket;
+  long flen;
+  int retc = ERR;
+  if (fseek(fpout, 0L, SEEK_END) != 0 || (flen = ftell(fpout)) < fpos_rec) {
+    strcpy(serr, "error in fseek (2)");
+    return ERR;
+  }
+  nrec = (int32) ((flen - fpos_rec) / SWEASP_DAT_RECLEN);
+  rec = (struct sweasp_rec *) malloc((nrec + 1) * sizeof(struct sweasp_rec));
+  pair = (struct sweasp_pair *) malloc((nrec + 1) * sizeof(struct sweasp_pair));
+  plist = (int32 *) malloc((nrec + 1) * sizeof(int32));
+  buf = (char *) malloc((size_t) (nrec + 1) * SWEASP_DAT_RECLEN);
+  if (rec == NULL || pair == NULL || plist == NULL || buf == NULL) {
+    strcpy(serr, "error in malloc() for aspect index");
+    goto end_index;
+  }
+  /* records sorted by time; qsort() is not stable, but records with 
+   * equal times are in no particular order anyway */
+  if (fseek(fpout, fpos_rec, SEEK_SET) != 0 
+    || (int32) fread(buf, SWEASP_DAT_RECLEN, nrec, fpout) != nrec) {
+    strcpy(serr, "error while trying to read aspect records");
+    goto end_index;
+  }
+  for (i = 0; i < nrec; i++)
+    sweasp_get_rec(buf + (size_t) i * SWEASP_DAT_RECLEN, &rec[i]);
+  qsort((void *) rec, (size_t) nrec, sizeof(struct sweasp_rec),
+        (int (*)(const void *, const void *))(sweasp_rec_compare));
+  for (i = 0; i < nrec; i++)
+    sweasp_put_rec(buf + (size_t) i * SWEASP_DAT_RECLEN, &rec[i]);
+  memset((void *) &head, 0, sizeof(struct sweasp_head));
+  strcpy(head.magic, SWEASP_MAGIC);
+  head.version = SWEASP_VERSION;
+  head.endian = SWEASP_TEST_ENDIAN;
+  head.reclen = SWEASP_DAT_RECLEN;
+  head.nrec = nrec;
+  head.tbucket = SWEASP_TBUCKET;
+  if (nrec > 0) {
+    head.tjd_beg = rec[0].tjd;
+    head.tjd_end = rec[nrec - 1].tjd;
+  }
+  /* time index */
+  nbucket = (int32) ((head.tjd_end - head.tjd_beg) / head.tbucket) + 1;
+  if ((tindex = (int32 *) malloc((nbucket + 1) * sizeof(int32))) == NULL) {
+    strcpy(serr, "error in malloc() for aspect index");
+    goto end_index;
+  }
+  for (k = 0, i = 0; k <= nbucket; k++) {
+    while (i < nrec && rec[i].tjd < head.tjd_beg + k * head.tbucket)
+      i++;
+    tindex[k] = i;
+  }
+  head.nbucket = nbucket;
+  /* body pair index */
+  for (i = 0; i < nrec; i++) {
+    pair[i].ipla = rec[i].ipla;
+    pair[i].iplb = rec[i].iplb;
+    pair[i].ilist = i;
+    pair[i].nlist = 1;
+  }
+  qsort((void *) pair, (size_t) nrec, sizeof(struct sweasp_pair),
+        (int (*)(const void *, const void *))(sweasp_pair_compare));
+  for (i = 0, npair = 0; i < nrec; i++) {
+    plist[i] = pair[i].ilist;
+    if (npair > 0 && pair[npair - 1].ipla == pair[i].ipla 
+      && pair[npair - 1].iplb == pair[i].iplb) {
+      pair[npair - 1].nlist++;
+    } else {
+      pair[npair] = pair[i];
+      pair[npair].ilist = i;
+      npair++;
+    }
+  }
+  head.npair = npair;
+  head.fpos_text = fpos_text;
+  head.fpos_rec = fpos_rec;
+  head.fpos_tindex = fpos_rec + nrec * SWEASP_DAT_RECLEN;
+  head.fpos_pindex = head.fpos_tindex + (nbucket + 1) * (int32) sizeof(int32);
+  head.fpos_plist = head.fpos_pindex + npair * (int32) sizeof(struct sweasp_pair);
+  if (fseek(fpout, fpos_rec, SEEK_SET) != 0
+    || (int32) fwrite(buf, SWEASP_DAT_RECLEN, nrec, fpout) != nrec
+    || (int32) fwrite((void *) tindex, sizeof(int32), nbucket + 1, fpout) != nbucket + 1
+    || (int32) fwrite((void *) pair, sizeof(struct sweasp_pair), npair, fpout) != npair
+    || (int32) fwrite((void *) plist, sizeof(int32), nrec, fpout) != nrec
+    || fseek(fpout, 0L, SEEK_SET) != 0
+    || fwrite((void *) &head, sizeof(struct sweasp_head), 1, fpout) != 1) {
+    strcpy(serr, "error while trying to write aspect index");
+    goto end_index;
+  }
+  retc = OK;
+end_index:
+  if (rec != NULL) free(rec);
+  if (pair != NULL) free(pair);
+  if (plist != NULL) free(plist);
+  if (tindex != NULL) free(tindex);
+  if (buf != NULL) free(buf);
+  return retc;
+}
+
+/* Updates the aspect database with an event found by calc_aspect_events().
+ * The events must come in time order. */
+static int32 write_aspect_event(FILE *fpout, struct aspdat *aspdat, EVENT *pevd, char *serr)
+{
+  struct aspdat *pasp;
+  test_print_date(pevd->tjd, pevd->ipla, pevd->iplb, pevd->stnama, pevd->stnamb, pevd->dang, pevd->dorb, "");
+  pasp = &(aspdat[pevd->bpind]);
+  /* new aspect between body pair: init structure */
+  if (pasp->tjd == 0 && pasp->tjd_pre == 0) 
+    pasp->iasp = -1;
+  if (pasp->iasp != pevd->iasp) {
+    pasp->tjd = 0;
+    pasp->tjd_pre = 0;
+    pasp->iasp = pevd->iasp;
+  }
+  /* aspect is exact */
+  if (pevd->dasp == pevd->dang) {
+    /* if there was another exactness before this one, we delete tjd_pre */
+    if (pasp->tjd != 0) 
+      pasp->tjd_pre = 0;
+    pasp->tjd = pevd->tjd;
+    /* write database */
+    if (fseek(fpout, 0, SEEK_END) != 0) {
+      strcpy(serr, "error in fseek (1)");
+      return ERR;
+    }
+    fwrite((char *) &(pasp->tjd), sizeof(double), 1, fpout);
+    fwrite((char *) &(pevd->ipla), sizeof(int32), 1, fpout);
+    fwrite((char *) &(pevd->iplb), sizeof(int32), 1, fpout);
+    fwrite((char *) &(pevd->iasp), sizeof(int32), 1, fpout);
+    fwrite((char *) &(pevd->dasp), sizeof(double), 1, fpout);
+    fwrite((char *) &(pevd->dorb), sizeof(double), 1, fpout);
+    fwrite((char *) &(pasp->tjd_pre), sizeof(double), 1, fpout);
+    pasp->fpos_tjd_post = ftell(fpout);
+    fwrite((char *) &(pasp->tjd_post), sizeof(double), 1, fpout);
+    /*fprintf(stderr, "%f: %d - %d ang=%.0f tpre=%f\n", pasp->tjd, pevd->ipla, pevd->iplb, pevd->dasp, pasp->tjd_pre);*/
+  /* entering orb: save tjd_pre */
+  } else if (pasp->tjd == 0) {
+    pasp->tjd_pre = pevd->tjd;
+  /* leaving orb */
+  } else {
+    /* write database: tjd_post */
+    if (fseek(fpout, pasp->fpos_tjd_post, SEEK_SET) != 0) {
+      strcpy(serr, "error in fseek (1)");
+      return ERR;
+    }
+    fwrite((char *) &(pevd->tjd), sizeof(double), 1, fpout);
+    /* after writing database, init aspdat */
+    pasp->iasp = -1;
+    pasp->tjd = 0;
+    pasp->tjd_pre = 0;
+  }
+  return OK;
+}
+
+/* Finds the aspect events of the time steps istep_beg <= istep < istep_end,
+ * where step istep covers the time from tjd0 + istep * tstep to 
+ * tjd0 + (istep + 1) * tstep.
+ * Positions are computed in blocks of NSTEP_BLOCK steps. Within a block,
+ * the maximum motion of each body per step is known; a body pair that is 
+ * far from all aspect angles is skipped for as many steps as it needs to 
+ * come near one of them.
+ * The events of each step are sorted by time. They are written into 
+ * file fpev, if it is given; otherwise they are entered into the aspect 
+ * database fpout.
+ */
+static int32 calc_aspect_events(int32 iflag, double tjd0, double tstep, int32 istep_beg, int32 istep_end, int32 nbody, struct aspbody *pbody, int32 nasp, char *saspi, double *dasp, FILE *fpev, FILE *fpout, struct aspdat *aspdat, char *serr)
+{
+  int32 ipla, iplb, iplia, iplib, ib, k, nb, istep, istep0, bpind, nskip;
+  int32 retflag = 0;
+  int32 retc = ERR;
+  int iaspi, iorb, nev;
+  double t, tt0, tret, tret2, dang = 0, dorb = 0;
+  double x[6], xta1, xta2, xtb1, xtb2, dt, d1, d2, d1d, d2d, dmin, dlim, vrel;
+  double *xl = NULL, *xld = NULL, *vmax = NULL, *tt = NULL;
+  int32 *skip_until = NULL;
+  EVENT events_day[500], *pevd;
+  xl = (double *) malloc((size_t) nbody * (NSTEP_BLOCK + 1) * sizeof(double));
+  xld = (double *) malloc((size_t) nbody * (NSTEP_BLOCK + 1) * sizeof(double));
+  vmax = (double *) malloc((size_t) nbody * sizeof(double));
+  tt = (double *) malloc((NSTEP_BLOCK + 1) * sizeof(double));
+  skip_until = (int32 *) calloc((size_t) NMAXPL * NMAXPL, sizeof(int32));
+  if (xl == NULL || xld == NULL || vmax == NULL || tt == NULL || skip_until == NULL) {
+    strcpy(serr, "error in malloc() for positions of aspect search");
+    goto end_events;
+  }
+#define XL(ib, k)	xl[(ib) * (NSTEP_BLOCK + 1) + (k)]
+#define XLD(ib, k)	xld[(ib) * (NSTEP_BLOCK + 1) + (k)]
+  /* same summation as in a search that starts at tjd0 */
+  for (t = tjd0, istep = 0; istep < istep_beg; istep++)
+    t += tstep;
+  for (istep0 = istep_beg; istep0 < istep_end; istep0 += nb) {
+    nb = istep_end - istep0;
+    if (nb > NSTEP_BLOCK)
+      nb = NSTEP_BLOCK;
+    /* positions at the begin and end times of all steps of the block;
+     * the first one is the last one of the previous block */
+    for (k = 0; k <= nb; k++) {
+      if (k == 0 && istep0 > istep_beg) {
+	tt[0] = tt[NSTEP_BLOCK];
+	for (ib = 0; ib < nbody; ib++) {
+	  XL(ib, 0) = XL(ib, NSTEP_BLOCK);
+	  XLD(ib, 0) = XLD(ib, NSTEP_BLOCK);
+	}
+	continue;
+      }
+      if (k > 0)
+	t += tstep;
+      tt[k] = t;
+      for (ib = 0; ib < nbody; ib++) {
+	if (call_swe_calc(t, pbody[ib].ipl, iflag|SEFLG_SPEED, pbody[ib].stnam, x, serr) == ERR)
+	  goto end_events;
+	XL(ib, k) = x[0];
+	XLD(ib, k) = x[0] + tstep / 10.0 * x[3];
+      }
+    }
+    for (ib = 0; ib < nbody; ib++) {
+      vmax[ib] = 0;
+      for (k = 0; k < nb; k++) {
+	d1 = fabs(swe_difdeg2n(XL(ib, k + 1), XL(ib, k)));
+	if (d1 > vmax[ib]) vmax[ib] = d1;
+      }
+    }
+    for (k = 0; k < nb; k++) {
+      istep = istep0 + k;
+      nev = 0;
+      pevd = &(events_day[0]);
+      /* for all planets a */
+      for (iplia = 0; iplia < nbody; iplia++) {
+	ipla = pbody[iplia].ipl;
+	/* fixed stars are not considered to transit over other bodies */
+	if (ipla == SE_FIXSTAR) continue; /* ????? */
+	/* for all planets b */
+	for (iplib = iplia + 1; iplib < nbody; iplib++) {
+	  iplb = pbody[iplib].ipl;
+	  bpind = iplia * NMAXPL + iplib;
+	  if (istep < skip_until[bpind])
+	    continue;
+	  xta1 = XL(iplia, k);
+	  xta2 = XL(iplia, k + 1);
+	  xtb1 = XL(iplib, k);
+	  xtb2 = XL(iplib, k + 1);
+	  if (ipla == SE_MOON || iplb == SE_MOON)
+	    dlim = 20;
+	  else
+	    dlim = NEAR_CROSSING_ORB + 3;
+	  /* distance from nearest aspect angle (including orbs) */
+	  dmin = 360;
+	  for (iaspi = 0; iaspi < nasp; iaspi++) {
+	    for (iorb = -1; iorb <= 1; iorb++) {
+	      d1 = swe_degnorm(xta1 - xtb1 - swe_degnorm(dasp[iaspi] + SWEV_ASPORB * iorb));
+	      if (d1 > 180) d1 -= 360;
+	      if (fabs(d1) < dmin) dmin = fabs(d1);
+	    }
+	  }
+	  /* body pair is too far from all aspects; in the following steps, 
+	   * the distance cannot decrease faster than vrel per step */
+	  if (dmin > dlim) {
+	    vrel = vmax[iplia] + vmax[iplib];
+	    if (vrel > 0 && (dmin - dlim) / vrel < NSTEP_BLOCK) 
+	      nskip = (int32) ((dmin - dlim) / vrel - 1e-6);
+	    else
+	      nskip = nb;
+	    skip_until[bpind] = istep + 1 + nskip;
+	    if (skip_until[bpind] > istep0 + nb) 
+	      skip_until[bpind] = istep0 + nb;
+	    continue;
+	  }
+	  /* for all aspects */
+	  for (iaspi = 0; iaspi < nasp; iaspi++) {
+	    int norb = 3;
+	    int orbfac;
+	    double dmaxorb;
+	    int iasp = (int) saspi[iaspi] - (int) '0';
+	    /* for pre-orb, exact, post-orb: */
+	    for (iorb = 0; iorb < norb; iorb++) {
+	      /* no pre- and post orbs for aspects between different kinds of
+	       * nodes and apsides */
+	      if (norb == 3 && iorb != 1) {
+		if (pbody[iplia].is_nodaps && pbody[iplib].is_nodaps)
+		   continue;
+	      }
+	      orbfac = (iorb - 1);  /* is -1, 0, 1 */
+	      if (norb == 1)
+		orbfac = 0;
+	      dmaxorb = SWEV_ASPORB * orbfac;
+	      dang = swe_degnorm(dasp[iaspi] + dmaxorb);
+	      tt0 = tt[k];
+	      dt = tstep;
+	      d1 = swe_degnorm(xta1 - xtb1 - dang);
+	      if (d1 > 180) d1 -= 360;
+	      d2 = swe_degnorm(xta2 - xtb2 - dang);
+	      if (d2 > 180) d2 -= 360;
+	      if (fabs(d1) > dlim) 
+		continue;
+	      d1d = swe_degnorm(XLD(iplia, k) - XLD(iplib, k) - dang);
+	      if (d1d > 180) d1d -= 360;
+	      d2d = swe_degnorm(XLD(iplia, k + 1) - XLD(iplib, k + 1) - dang);
+	      if (d2d > 180) d2d -= 360;
+	      /* 
+	       * crossing found 
+	       * find t of exact aspect
+	       * if exactness happens twice within step width, the aspect is
+	       * lost
+	       */
+	      if (d1 * d2 < 0) {
+		/*
+		 * step width 1 day:     1min20sec/100 yr (1 or 2 asp lost per cty)
+		 * step width 0.1 day:   1min55sec/100 years
+		 * step width 0.01 day:  9min32sec/100 years 
+		 * (calculations with SEFLG_NONUT)
+		 * Still, we use 1-day step width. The lost aspects will
+		 * be found in the "else".
+		 */
+		if ((retflag = get_crossing_bin_search(dt, tt0, dang, xta1, xta2, xtb1, xtb2, &tret, ipla, iplb, pbody[iplia].stnam, pbody[iplib].stnam, iflag, FALSE, serr)) == ERR)
+		  goto end_events;
+		fill_pev_day(pevd + nev, tret, ipla, iplb, pbody[iplia].stnam, pbody[iplib].stnam, iasp, bpind, dasp[iaspi], dang, 0, NULL);
+		nev++;
+	      /* 
+	       * - near crossing occurs (t of smallest orb is found)
+	       * - or exact aspect occurs twice within step width
+	       *   (was lost by "if")
+	       */
+	      } else if (fabs(d1) < NEAR_CROSSING_ORB || fabs(d2) < NEAR_CROSSING_ORB) {
+		/* printf("d1=%f, d1d=%f, d2=%f, d2d=%f\n", d1, d1d, d2, d2d);*/
+		if (d1 > 0 && d2 > 0) {
+		  if (d1 > d2 && d2 > d2d) continue;
+		  if (d1 < d2 && d1 < d1d) continue;
+		} else {
+		  if (d1 > d2 && d1 > d1d) continue;
+		  if (d1 < d2 && d2 < d2d) continue;
+		}
+		if ((retflag = get_near_crossing_bin_search(dt, tt0, dang, xta1, xta2, xtb1, xtb2, &tret, &tret2, &dorb, ipla, iplb, pbody[iplia].stnam, pbody[iplib].stnam, iflag, serr)) == ERR)
+		  goto end_events;
+		if (retflag == -2)
+		  continue;
+		if (fabs(dorb) > 0) {
+		  if (orbfac == 0) {
+		    fill_pev_day(pevd + nev, tret, ipla, iplb, pbody[iplia].stnam, pbody[iplib].stnam, iasp, bpind, dasp[iaspi], dang, dorb, "*");
+		    nev++;
+		  }
+		} else {
+		  fill_pev_day(pevd + nev, tret, ipla, iplb, pbody[iplia].stnam, pbody[iplib].stnam, iasp, bpind, dasp[iaspi], dang, dorb, "x");
+		  nev++;
+		  if (tret2 != 0) {
+		    fill_pev_day(pevd + nev, tret2, ipla, iplb, pbody[iplia].stnam, pbody[iplib].stnam, iasp, bpind, dasp[iaspi], dang, dorb, "x");
+		    nev++;
+		  }
+		}
+	      }
+	    }
+	  }
+	}
+      }
+      /* sort transits of current day (time step) */
+      qsort((void *) &(events_day[0]), (size_t) nev, sizeof(EVENT),
+	    (int (*)(const void *, const void *))(pev_compare));
+      if (fpev != NULL) {
+	if (nev > 0 && fwrite((void *) &(events_day[0]), sizeof(EVENT), nev, fpev) != (size_t) nev) {
+	  strcpy(serr, "error while trying to write aspect events");
+	  goto end_events;
+	}
+      } else {
+	for (pevd = &(events_day[0]); pevd - &(events_day[0]) < nev; pevd++) {
+	  if (write_aspect_event(fpout, aspdat, pevd, serr) == ERR)
+	    goto end_events;
+	}
+      }
+    }
+  }
+#undef XL
+#undef XLD
+  retc = OK;
+end_events:
+  if (xl != NULL) free(xl);
+  if (xld != NULL) free(xld);
+  if (vmax != NULL) free(vmax);
+  if (tt != NULL) free(tt);
+  if (skip_until != NULL) free(skip_until);
+  return retc;
+}
+
+#if !MSDOS
+/* Runs nj jobs in forked processes. Job ij calls fjob(ij, pdata, fpjob[ij], serr),
+ * which writes its results into the temporary file fpjob[ij].
+ * Ephemeris files are closed before the jobs are started, because 
+ * processes must not share file positions; every process reopens them.
+ * After all jobs have finished, the files are rewound for reading. 
+ * The caller must close all files fpjob[] that are not NULL. */
+static int32 run_jobs(int32 nj, int32 (*fjob)(int32 ij, void *pdata, FILE *fp, char *serr), void *pdata, FILE **fpjob, char *serr)
+{
+  int32 ij;
+  pid_t pid[NJOBS_MAX];
+  int status;
+  int32 retc = OK;
+  for (ij = 0; ij < nj; ij++)
+    fpjob[ij] = NULL;
+  swe_close();
+  fflush(NULL);
+  for (ij = 0; ij < nj; ij++) {
+    if ((fpjob[ij] = tmpfile()) == NULL) {
+      strcpy(serr, "could not create temporary file for job");
+      retc = ERR;
+      break;
+    }
+    if ((pid[ij] = fork()) < 0) {
+      strcpy(serr, "could not start job");
+      retc = ERR;
+      break;
+    }
+    if (pid[ij] == 0) {	/* job process */
+      swe_set_ephe_path(ephepath);
+      swe_set_jpl_file(fname);
+      if ((*fjob)(ij, pdata, fpjob[ij], serr) == ERR) {
+	fprintf(stderr, "%s\n", serr);
+	exit(1);
+      }
+      fflush(NULL);
+      exit(0);
+    }
+  }
+  nj = ij;
+  swe_set_ephe_path(ephepath);
+  swe_set_jpl_file(fname);
+  for (ij = 0; ij < nj; ij++) {
+    if (waitpid(pid[ij], &status, 0) < 0 
+      || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      if (retc == OK)
+	sprintf(serr, "job %d failed", ij + 1);
+      retc = ERR;
+    }
+    rewind(fpjob[ij]);
+  }
+  return retc;
+}
+
+/* job of the aspect search: a range of time steps */
+static int32 aspect_events_job(int32 ij, void *pdata, FILE *fp, char *serr)
+{
+  struct aspjob *pj = (struct aspjob *) pdata;
+  int32 ibeg = (int32) ((double) pj->nstep * ij / pj->njobs);
+  int32 iend = (int32) ((double) pj->nstep * (ij + 1) / pj->njobs);
+  return calc_aspect_events(pj->iflag, pj->tjd0, pj->tstep, ibeg, iend, pj->nbody, pj->pbody, pj->nasp, pj->saspi, pj->dasp, fp, NULL, NULL, serr);
+}
+
+/* Splits the time steps of the aspect search into njobs ranges and 
+ * computes them in parallel jobs. The parent enters the events of the 
+ * jobs into the aspect database in time order. Since each time step is 
+ * independent of the others, the result is the same as with a single 
+ * process. */
+static int32 calc_aspect_events_jobs(int32 iflag, double tjd0, double tstep, int32 nstep, int32 nbody, struct aspbody *pbody, int32 nasp, char *saspi, double *dasp, FILE *fpout, struct aspdat *aspdat, char *serr)
+{
+  int32 ij, retc;
+  FILE *fpev[NJOBS_MAX];
+  EVENT ev;
+  struct aspjob job;
+  job.iflag = iflag;
+  job.tjd0 = tjd0;
+  job.tstep = tstep;
+  job.nstep = nstep;
+  job.njobs = (njobs > nstep ? nstep : njobs);
+  job.nbody = nbody;
+  job.pbody = pbody;
+  job.nasp = nasp;
+  job.saspi = saspi;
+  job.dasp = dasp;
+  fflush(fpout);
+  retc = run_jobs(job.njobs, aspect_events_job, (void *) &job, fpev, serr);
+  for (ij = 0; ij < job.njobs; ij++) {
+    if (fpev[ij] == NULL)
+      continue;
+    while (retc == OK && fread((void *) &ev, sizeof(EVENT), 1, fpev[ij]) == 1) {
+      if (write_aspect_event(fpout, aspdat, &ev, serr) == ERR)
+	retc = ERR;
+    }
+    fclose(fpev[ij]);
+  }
+  return retc;
+}
+#endif
+
 /* Search for mundane aspects.
  * The algorithm finds
  * 1. exact aspects
@@ -2162,33 +2836,29 @@ if (ipla <= 9 && tjd_pre > 0 && tjd_post > 0 && tjd_post - tjd_pre > dur) {
 int32 calc_mundane_aspects(int32 iflag, double tjd0, double tjde, double tstep, 
   char *splan, char *sasp, EVENT *pev, char *serr)
 {
-  int32 ipl, ipla, iplb, ipli, iplia, iplib, bpind;
-  char *sp, *spa, *spb;
-  char stnam[40], stnama[40], stnamb[40];
-  double t, tt0, tret, tret2, dang = 0, dorb = 0;
-  double x[6], x1[30], x2[30], x1d[30], x2d[30];
-  double xa[6], xa1[30], xa2[30], xa1d[30], xa2d[30];
-  double d1d, d2d;
-  double xta1, xta2, xtb1, xtb2, dt, d1, d2;
-  int32 retflag = 0;
+  int32 ipli, nbody, nstep, i;
+  char *sp;
+  double t;
   int32 jyear, jmon, jday;
   double jut;
   char saspi[30];
   double dasp[30];
-  int iaspi;
   int nasp = get_aspect_angles(sasp, saspi, dasp, serr);
-  int nev;
-  EVENT events_day[500], *pevd = &(events_day[0]);
-  struct aspdat aspdat[NMAXPL * NMAXPL], *pasp;
+  struct aspdat aspdat[NMAXPL * NMAXPL];
+  struct aspbody body[NMAXPL];
   char foutnam[AS_MAXCH];
   FILE *fpout = NULL;
-  UNUSED(xa1);
-  UNUSED(xa1d);
+  struct sweasp_head head;
+  int32 fpos_text, fpos_rec, retc;
   sprintf(foutnam, "%s/%s", PATH_FOUTNAM, FOUTNAM);
-  if ((fpout = fopen(foutnam, "w+")) == NULL) {
+  if ((fpout = fopen(foutnam, "w+b")) == NULL) {
     sprintf(serr, "could not open file %s", foutnam);
     return ERR;
   }
+  /* empty header, is written by write_sweasp_index() at the end */
+  memset((void *) &head, 0, sizeof(struct sweasp_head));
+  fwrite((void *) &head, sizeof(struct sweasp_head), 1, fpout);
+  fpos_text = ftell(fpout);
   fprintf(fpout, "%s, mundane aspects\ncreation date: %s\n%s\n", FOUTNAM, sdate, cmdline);
   swe_revjul(tjd0, 1, &jyear, &jmon, &jday, &jut);
   fprintf(fpout, "start date: %d/%02d/%02d, ", jyear, jmon, jday);
@@ -2202,196 +2872,37 @@ int32 calc_mundane_aspects(int32 iflag, double tjd0, double tjde, double tstep,
   fprintf(fpout, "          = %s\n", saspi);
   fprintf(fpout, "data structure:\ndouble time of exactness (TT)\nint32  number of planet a\nint32  number of planet b\nint32  number of aspect\ndouble aspect angle\ndouble precision of aspect; 0 if exact\ndouble time of crossing of pre-orb\ndouble time of crossing of post-orb\n");
   fprintf(fpout, "Aspects between nodes and apsides have no pre-orb and post-orb.\nIf an aspect comes into orb but does not become exact, time of exactness is the moment of closest approach.\nIf an aspect has no preorb, there is another exactness before that. And if it has no postorb, there is another exactness after that.\n");
-  fprintf(fpout, "######################\n");
+  fprintf(fpout, "The records are followed by a time index and a body pair index, see swevents.h.\n");
+  /* the marker line is padded, so that the records start at a multiple 
+   * of 8 bytes and the index tables of the mapped file are aligned */
+  for (i = 0, fpos_rec = ftell(fpout); i < 22 || (fpos_rec + i + 1) % 8 != 0; i++)
+    fputc('#', fpout);
+  fputc('\n', fpout);
+  fpos_rec = ftell(fpout);
   memset((void *) &(aspdat[0]), 0, NMAXPL * NMAXPL * sizeof(struct aspdat));
-  /* *stnam = '\0';*/
-  for (t = tjd0; t < tjde; t += tstep) {
-    nev = 0;
-    pevd = &(events_day[0]);
-    for (sp = splan, ipli = 0; *sp != '\0'; sp = forw_splan(sp), ipli++) {
-      ipl = letter_to_ipl_or_star(sp, stnam);
-      if (t == tjd0) {
-	if (call_swe_calc(t, ipl, iflag|SEFLG_SPEED, stnam, x, serr) == ERR)
-	  return ERR;
-	if (call_swe_calc(t, ipl, iflag|SEFLG_SPEED|SEFLG_EQUATORIAL, stnam, xa, serr) == ERR)
-	  return ERR;
-	x1[ipli] = x[0];
-	x1d[ipli] = x[0] + tstep / 10.0 * x[3];
-	/* declination */
-	xa1[ipli] = xa[1]; 
-	xa1d[ipli] = xa[1] + tstep / 10.0 * xa[4];
-      } else {
-        x1[ipli] = x2[ipli];
-	x1d[ipli] = x2d[ipli];
-	/* declination */
-        xa1[ipli] = xa2[ipli];
-	xa1d[ipli] = xa2d[ipli];
-      }
-      if (call_swe_calc(t + tstep, ipl, iflag|SEFLG_SPEED, stnam, x, serr) == ERR)
-	return ERR;
-      if (call_swe_calc(t + tstep, ipl, iflag|SEFLG_SPEED|SEFLG_EQUATORIAL, stnam, xa, serr) == ERR)
-	return ERR;
-      x2[ipli] = x[0];
-      x2d[ipli] = x[0] + tstep / 10.0 * x[3];
-      /* declination */
-      xa2[ipli] = xa[1];
-      xa2d[ipli] = xa[1] + tstep / 10.0 * xa[4];
-    }
-    /* for all planets a */
-    for (spa = splan, iplia = 0; *spa != '\0'; spa = forw_splan(spa), iplia++) {
-      ipla = letter_to_ipl_or_star(spa, stnama);
-      /* fixed stars are not considered to transit over other bodies */
-      if (ipla == SE_FIXSTAR) continue; /* ????? */
-      /* for all planets b */
-      for (spb = forw_splan(spa), iplib = iplia + 1; *spb != '\0'; spb = forw_splan(spb), iplib++) {
-	iplb = letter_to_ipl_or_star(spb, stnamb);
-	bpind = iplia * NMAXPL + iplib;
-	/* for all aspects */
-	for (iaspi = 0; iaspi < nasp; iaspi++) {
-	  int iorb, norb = 3;
-	  int orbfac;
-	  double dmaxorb;
-	  int iasp = (int) saspi[iaspi] - (int) '0';
-	  /* for pre-orb, exact, post-orb: */
-	  for (iorb = 0; iorb < norb; iorb++) {
-	    /* no pre- and post orbs for aspects between different kinds of
-	     * nodes and apsides */
-	    if (norb == 3 && iorb != 1) {
-	      if (strchr("mtABcg", *spa) != NULL && strchr("mtABcg", *spb) != NULL)
-	         continue;
-	    }
-	    orbfac = (iorb - 1);  /* is -1, 0, 1 */
-	    if (norb == 1)
-	      orbfac = 0;
-	    dmaxorb = SWEV_ASPORB * orbfac;
-	    dang = swe_degnorm(dasp[iaspi] + dmaxorb);
-	    xta1 = x1[iplia];
-	    xta2 = x2[iplia];
-	    xtb1 = x1[iplib];
-	    xtb2 = x2[iplib];
-	    tt0 = t;
-	    dt = tstep;
-	    d1 = swe_degnorm(xta1 - xtb1 - dang);
-	    if (d1 > 180) d1 -= 360;
-	    d2 = swe_degnorm(xta2 - xtb2 - dang);
-	    if (d2 > 180) d2 -= 360;
-	    if (ipla == SE_MOON || iplb == SE_MOON) {
-	      if (fabs(d1) >  20)
-		continue;
-	    } else if (fabs(d1) > NEAR_CROSSING_ORB + 3) {
-	      continue;
-	    }
-	    d1d = swe_degnorm(x1d[iplia] - x1d[iplib] - dang);
-	    if (d1d > 180) d1d -= 360;
-	    d2d = swe_degnorm(x2d[iplia] - x2d[iplib] - dang);
-	    if (d2d > 180) d2d -= 360;
-	    /* 
-	     * crossing found 
-	     * find t of exact aspect
-	     * if exactness happens twice within step width, the aspect is
-	     * lost
-	     */
-	    if (d1 * d2 < 0) {
-	      /*
-	       * step width 1 day:     1min20sec/100 yr (1 or 2 asp lost per cty)
-	       * step width 0.1 day:   1min55sec/100 years
-	       * step width 0.01 day:  9min32sec/100 years 
-	       * (calculations with SEFLG_NONUT)
-	       * Still, we use 1-day step width. The lost aspects will
-	       * be found in the "else".
-	       */
-	      if ((retflag = get_crossing_bin_search(dt, tt0, dang, xta1, xta2, xtb1, xtb2, &tret, ipla, iplb, stnama, stnamb, iflag, FALSE, serr)) == ERR)
-		return ERR;
-	      fill_pev_day(pevd + nev, tret, ipla, iplb, stnama, stnamb, iasp, bpind, dasp[iaspi], dang, 0, NULL);
-	      nev++;
-	    /* 
-	     * - near crossing occurs (t of smallest orb is found)
-	     * - or exact aspect occurs twice within step width
-	     *   (was lost by "if")
-	     */
-	    } else if (fabs(d1) < NEAR_CROSSING_ORB || fabs(d2) < NEAR_CROSSING_ORB) {
-	      /* printf("d1=%f, d1d=%f, d2=%f, d2d=%f\n", d1, d1d, d2, d2d);*/
-	      if (d1 > 0 && d2 > 0) {
-		if (d1 > d2 && d2 > d2d) continue;
-		if (d1 < d2 && d1 < d1d) continue;
-	      } else {
-		if (d1 > d2 && d1 > d1d) continue;
-		if (d1 < d2 && d2 < d2d) continue;
-	      }
-	      if ((retflag = get_near_crossing_bin_search(dt, tt0, dang, xta1, xta2, xtb1, xtb2, &tret, &tret2, &dorb, ipla, iplb, stnama, stnamb, iflag, serr)) == ERR)
-		return ERR;
-	      if (retflag == -2)
-		continue;
-	      if (fabs(dorb) > 0) {
-		if (orbfac == 0) {
-		  fill_pev_day(pevd + nev, tret, ipla, iplb, stnama, stnamb, iasp, bpind, dasp[iaspi], dang, dorb, "*");
-		  nev++;
-		}
-	      } else {
-		fill_pev_day(pevd + nev, tret, ipla, iplb, stnama, stnamb, iasp, bpind, dasp[iaspi], dang, dorb, "x");
-		nev++;
-		if (tret2 != 0) {
-		  fill_pev_day(pevd + nev, tret2, ipla, iplb, stnama, stnamb, iasp, bpind, dasp[iaspi], dang, dorb, "x");
-		  nev++;
-		}
-	      }
-	    }
-	  }
-	}
-      }
-    }
-    /* sort transits of current day (time step) */
-    qsort((void *) &(events_day[0]), (size_t) nev, sizeof(EVENT),
-          (int (*)(const void *, const void *))(pev_compare));
-    for (pevd = &(events_day[0]); pevd - &(events_day[0]) < nev; pevd++) {
-      test_print_date(pevd->tjd, pevd->ipla, pevd->iplb, pevd->stnama, pevd->stnamb, pevd->dang, pevd->dorb, "");
-      pasp = &(aspdat[pevd->bpind]);
-      /* new aspect between body pair: init structure */
-      if (pasp->tjd == 0 && pasp->tjd_pre == 0) 
-        pasp->iasp = -1;
-      if (pasp->iasp != pevd->iasp) {
-        pasp->tjd = 0;
-        pasp->tjd_pre = 0;
-	pasp->iasp = pevd->iasp;
-      }
-      /* aspect is exact */
-      if (pevd->dasp == pevd->dang) {
-	/* if there was another exactness before this one, we delete tjd_pre */
-        if (pasp->tjd != 0) 
-	  pasp->tjd_pre = 0;
-        pasp->tjd = pevd->tjd;
-        /* write database */
-	if (fseek(fpout, 0, SEEK_END) != 0) {
-	  strcpy(serr, "error in fseek (1)");
-	  return ERR;
-	}
-	fwrite((char *) &(pasp->tjd), sizeof(double), 1, fpout);
-	fwrite((char *) &(pevd->ipla), sizeof(int32), 1, fpout);
-	fwrite((char *) &(pevd->iplb), sizeof(int32), 1, fpout);
-	fwrite((char *) &(pevd->iasp), sizeof(int32), 1, fpout);
-	fwrite((char *) &(pevd->dasp), sizeof(double), 1, fpout);
-	fwrite((char *) &(pevd->dorb), sizeof(double), 1, fpout);
-	fwrite((char *) &(pasp->tjd_pre), sizeof(double), 1, fpout);
-	pasp->fpos_tjd_post = ftell(fpout);
-	fwrite((char *) &(pasp->tjd_post), sizeof(double), 1, fpout);
-        /*fprintf(stderr, "%f: %d - %d ang=%.0f tpre=%f\n", pasp->tjd, pevd->ipla, pevd->iplb, pevd->dasp, pasp->tjd_pre);*/
-      /* entering orb: save tjd_pre */
-      } else if (pasp->tjd == 0) {
-        pasp->tjd_pre = pevd->tjd;
-      /* leaving orb */
-      } else {
-        /* write database: tjd_post */
-	if (fseek(fpout, pasp->fpos_tjd_post, SEEK_SET) != 0) {
-	  strcpy(serr, "error in fseek (1)");
-	  return ERR;
-	}
-	fwrite((char *) &(pevd->tjd), sizeof(double), 1, fpout);
-	/* after writing database, init aspdat */
-	pasp->iasp = -1;
-        pasp->tjd = 0;
-        pasp->tjd_pre = 0;
-      }
-    }
+  /* bodies, decoded only once */
+  for (sp = splan, ipli = 0; *sp != '\0' && ipli < NMAXPL; sp = forw_splan(sp), ipli++) {
+    *body[ipli].stnam = '\0';
+    body[ipli].ipl = letter_to_ipl_or_star(sp, body[ipli].stnam);
+    body[ipli].is_nodaps = (strchr("mtABcg", *sp) != NULL);
+  }
+  nbody = ipli;
+  /* number of time steps */
+  for (t = tjd0, nstep = 0; t < tjde; t += tstep)
+    nstep++;
+#if !MSDOS
+  if (njobs > 1 && nstep > 1)
+    retc = calc_aspect_events_jobs(iflag, tjd0, tstep, nstep, nbody, body, nasp, saspi, dasp, fpout, aspdat, serr);
+  else
+#endif
+    retc = calc_aspect_events(iflag, tjd0, tstep, 0, nstep, nbody, body, nasp, saspi, dasp, NULL, fpout, aspdat, serr);
+  if (retc == ERR) {
+    fclose(fpout);
+    return ERR;
+  }
+  if (write_sweasp_index(fpout, fpos_text, fpos_rec, serr) == ERR) {
+    fclose(fpout);
+    return ERR;
   }
   fclose(fpout);
   read_sweasp_dat(foutnam);
@@ -2399,69 +2910,6 @@ int32 calc_mundane_aspects(int32 iflag, double tjd0, double tjde, double tstep,
   return OK;
 }
 
-static int do_fread_double(FILE *fpout, char *foutnam, int32 fposbeg, double *tjdbeg, char *serr)
-{
-  if (fseek(fpout, fposbeg, SEEK_SET) != 0) {
-    sprintf(serr, "fseek failed (SEEK_SET): %s", foutnam);
-    return ERR;   
-  }
-  if (fread((void *) tjdbeg, sizeof(double), 1, fpout) <= 0) {
-    sprintf(serr, "error while trying to read %s (1)", foutnam);
-    return ERR;   
-  }
-  return OK;
-}
-
-static int do_fread_asp(FILE *fpout, int32 fpos1, double *tjd_ex, int *ipla, int *iplb, int *iasp, double *dasp, double *dorb, double *tjd_pre, double *tjd_post, char *serr)
-{
-  if (fseek(fpout, fpos1, SEEK_SET) != 0) {
-    sprintf(serr, "do_fread_asp(): fseek failed (SEEK_SET)");
-    return ERR;   
-  }
-  if (fread((void *) tjd_ex, sizeof(double), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) ipla, sizeof(int), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) iplb, sizeof(int), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) iasp, sizeof(int), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) dasp, sizeof(double), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) dorb, sizeof(double), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) tjd_pre, sizeof(double), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  if (fread((void *) tjd_post, sizeof(double), 1, fpout) <= 0) {
-    sprintf(serr, "do_fread_asp(): error while trying to read");
-    return ERR;   
-  }
-  return OK;
-}
-
-static int start_and_end_date_sweasp(FILE *fpout, char *foutnam, int32 fposbeg, int32 fposlast, double *tjdbeg, double *tjdend, char *serr)
-{
-  if (do_fread_double(fpout, foutnam, fposbeg, tjdbeg, serr) == ERR)
-    return ERR;
-  if (do_fread_double(fpout, foutnam, fposlast, tjdend, serr) == ERR)
-    return ERR;
-  return OK;   
-}
-
 static int is_node_apsis(int ipl) 
 {
   if (ipl == SE_MEAN_NODE || ipl == SE_TRUE_NODE 
@@ -2471,157 +2919,97 @@ static int is_node_apsis(int ipl)
   return 0;
 }
 
-#define SWEASP_DAT_RECLEN  52
 #define PERIOD_PRE_POST  365 /* days */
 /* returns all aspects, that are within orb during the time (tjd +- dtol) */
 static int32 extract_data_of_day(int32 doflag, double tjd, double dtol, char *splan, char *sasp, EVENT *pev, char *serr)
 {
-  int32 flen = 0, headerlen = 0, fposfirst = 0, fposlast = 0, nrecdif;
-  int32 fpos0, fpos1, fpos2;
-  int32 retc, nrec = 0, ipla, iplb, iasp;
-  double dasp, dorb, dorb2, tjd_pre, tjd_post, tjd_ex, tjdstart;
-  double tjd0, tjd1, tjd2;
-  int ipla2, iplb2, iasp2;
-  double tjd_pre2, tjd_post2, tjd_ex2;
-  double tjdbeg, tjdend;
-  char s[AS_MAXCH], *sp;
-  FILE *fpout = NULL;
+  int32 irec, irec2;
+  double tjdstart;
+  struct sweasp_db db;
+  struct sweasp_rec rec, rec2;
   char foutnam[AS_MAXCH];
-  UNUSED(tjd2);
   /* open aspects file */
   sprintf(foutnam, "%s/%s", PATH_FOUTNAM, FOUTNAM);
-  if ((fpout = fopen(foutnam, BFILE_R_ACCESS)) == NULL) {
-    sprintf(serr, "could not open file %s", foutnam);
-    return ERR;
-  }
-  /* read file header */
-  while (fgets(s, AS_MAXCH, fpout) != NULL && (sp = strchr(s, '\n')) != NULL) {
-    headerlen += strlen(s);
-    if (strncmp(s, "####", 4) == 0) 
-      break;
-  }
-  /* start position of file */
-  fposfirst = headerlen;
-  /* end position of file */
-  if (fseek(fpout, 0L, SEEK_END) != 0) {
-    sprintf(serr, "fseek failed (SEEK_END): %s", foutnam);
+  if (open_sweasp_db(foutnam, &db, serr) == ERR)
     return ERR;
-  }
-  fposlast = ftell(fpout); /* pointer to end of file */
-  flen = fposlast - headerlen;
-  /* number of records in file */
-  nrec = flen / SWEASP_DAT_RECLEN;
-  fposlast = fposfirst + (nrec - 1) * SWEASP_DAT_RECLEN; /* pointer to last record in file */
   /* is search date in file range ? */
-  if ((retc = start_and_end_date_sweasp(fpout, foutnam, fposfirst, fposlast, &tjdbeg, &tjdend, serr)) == ERR) 
-    goto end_extract;
-  if (tjd <= tjdbeg || tjd >= tjdend) {
-    sprintf(serr, "date %f is beyond range of file %s (%.0f - %.0f)", tjd, foutnam, tjdbeg, tjdend);
+  if (db.head.nrec == 0 || tjd <= db.head.tjd_beg || tjd >= db.head.tjd_end) {
+    sprintf(serr, "date %f is beyond range of file %s (%.0f - %.0f)", tjd, foutnam, db.head.tjd_beg, db.head.tjd_end);
+    close_sweasp_db(&db);
     return ERR;
-    goto end_extract;
-  }
-  /* binary search for date in file */
-  tjdstart = tjd - PERIOD_PRE_POST; /* we start our search a year before the date we want */
-  if (tjdstart < tjdbeg)
-    tjdstart = tjdbeg;
-  nrecdif = (fposlast - fposfirst) / SWEASP_DAT_RECLEN;
-  tjd0 = tjdbeg; tjd2 = tjdend; tjd1 = tjd0;
-  fpos0 = fposfirst; fpos2 = fposlast;
-  fpos1 = fpos0;  // silence compiler
-  while(fabs(tjdstart - tjd1) > 2) {
-    fpos1 = fpos0 + (nrecdif / 2) * SWEASP_DAT_RECLEN;
-    if ((retc = do_fread_double(fpout, foutnam, fpos1, &tjd1, serr)) == ERR) {
-      goto end_extract;
-    }
-    if (tjdstart >= tjd1) {
-      tjd0 = tjd1; 
-      fpos0 = fpos1;
-    } else {
-      tjd2 = tjd1; 
-      fpos2 = fpos1;
-    }
-    nrecdif = (fpos2 - fpos0) / SWEASP_DAT_RECLEN;
   }
-  /*fprintf(stderr, "ts = %.0f, t0 = %.0f, t1 = %.0f, t2 = %.0f, d = %d\n", tjdstart, tjd0, tjd1, tjd2, nrecdif);*/
+  /* we start our search a year before the date we want */
+  tjdstart = tjd - PERIOD_PRE_POST; 
   /* now, from this date we start searching for aspects whose period covers
    * or overlaps with our date tjd +- dtol */
-  if ((retc = do_fread_asp(fpout, fpos1, &tjd_ex, &ipla, &iplb, &iasp, &dasp, &dorb, &tjd_pre, &tjd_post, serr)) == ERR)
-    goto end_extract;
-  while(tjd_ex < tjd + PERIOD_PRE_POST) {
-      /*if (ipla == 8 && iplb == 11) {
-        fprintf(stderr, "hallo\n");
-      }*/
-    if (ipla <= SE_CHIRON && iplb <= SE_CHIRON && ipla >= 0 && iplb >= 0 && iasp < 8) {
-      /* complete aspect with tjd_pre and tjd_post */
-      if (tjd_pre > 0 && tjd_post > 0) {
-	/* within time range */
-        if (tjd_post >= tjd - dtol && tjd_pre <= tjd + dtol) {
-	  fprintf(stderr, "tjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", tjd_ex, tjd_pre, tjd_post, ipla, iplb, dasp, iasp);
-        }
-      /* aspect between nodes and aspides (no tjd_pre and tjd_post) */
-      } else if (is_node_apsis(ipla) && is_node_apsis(iplb)) {
-	/* exactness is within time range */
-        if (tjd_ex >= tjd - dtol && tjd_ex <= tjd + dtol) {
-	  fprintf(stderr, "tjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", tjd_ex, tjd_pre, tjd_post, ipla, iplb, dasp, iasp);
+  for (irec = sweasp_first_rec(&db, tjdstart); irec < db.head.nrec; irec++) {
+    sweasp_db_rec(&db, irec, &rec);
+    if (rec.tjd >= tjd + PERIOD_PRE_POST)
+      break;
+    if (!(rec.ipla <= SE_CHIRON && rec.iplb <= SE_CHIRON && rec.ipla >= 0 && rec.iplb >= 0 && rec.iasp < 8))
+      continue;
+    /* complete aspect with tjd_pre and tjd_post */
+    if (rec.tjd_pre > 0 && rec.tjd_post > 0) {
+      /* within time range */
+      if (rec.tjd_post >= tjd - dtol && rec.tjd_pre <= tjd + dtol) {
+	fprintf(stderr, "tjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", rec.tjd, rec.tjd_pre, rec.tjd_post, rec.ipla, rec.iplb, rec.dasp, rec.iasp);
+      }
+    /* aspect between nodes and aspides (no tjd_pre and tjd_post) */
+    } else if (is_node_apsis(rec.ipla) && is_node_apsis(rec.iplb)) {
+      /* exactness is within time range */
+      if (rec.tjd >= tjd - dtol && rec.tjd <= tjd + dtol) {
+	fprintf(stderr, "tjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", rec.tjd, rec.tjd_pre, rec.tjd_post, rec.ipla, rec.iplb, rec.dasp, rec.iasp);
+      }
+    /* aspect is in process already at the beginning of search period,
+     * too far away from the required date range */
+    } else if (rec.tjd_pre == 0) {
+      ;
+    /* aspect begins after end of required date range */
+    } else if (tjd + dtol < rec.tjd_pre) {
+      ;
+    /* aspect with unknown end, possibly covering our required date range.
+     * we search for its end in the following records of the body pair */
+    } else {
+      AS_BOOL do_output = FALSE;
+      if (rec.tjd > tjd - dtol) {
+	do_output = TRUE;
+	fprintf(stderr, "xxtjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", rec.tjd, rec.tjd_pre, rec.tjd_post, rec.ipla, rec.iplb, rec.dasp, rec.iasp);
+      }
+      for (irec2 = sweasp_next_rec_of_pair(&db, irec, rec.ipla, rec.iplb);
+	   irec2 >= 0;
+	   irec2 = sweasp_next_rec_of_pair(&db, irec2, rec.ipla, rec.iplb)) {
+	sweasp_db_rec(&db, irec2, &rec2);
+	if (rec2.tjd >= tjd + PERIOD_PRE_POST)
+	  break;
+	if (rec2.iasp != rec.iasp)
+	  continue;
+	fprintf(stderr, "yytjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f\n", rec2.tjd, rec2.tjd_pre, rec2.tjd_post, rec2.ipla, rec2.iplb, rec2.dasp);
+	fprintf(stderr, "yytjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", rec2.tjd, rec2.tjd_pre, rec2.tjd_post, rec2.ipla, rec2.iplb, rec2.dasp, rec2.iasp);
+	/* if previous phases had no exactness, but the current one has
+	 * or is exacter, take over its time of exactness */
+	if (fabs(rec2.dorb) < fabs(rec.dorb)) {
+	  rec.dorb = rec2.dorb;
+	  rec.tjd = rec2.tjd;
 	}
-      /* aspect is in process already at the beginning of search period,
-       * too far away from the required date range */
-      } else if (tjd_pre == 0) {
-        ;
-      /* aspect begins after end of required date range */
-      } else if (tjd + dtol < tjd_pre) {
-        ;
-      /* aspect with unknown end, possibly covering our required date range.
-       * we search for its end */
-      } else {
-        AS_BOOL do_output = FALSE;
-	if (tjd_ex > tjd - dtol) {
-	  do_output = TRUE;
-	  fprintf(stderr, "xxtjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", tjd_ex, tjd_pre, tjd_post, ipla, iplb, dasp, iasp);
+	/* if there are several exactnesses, select the one closest
+	 * to the required date */
+	if (rec2.dorb == 0 && fabs(rec2.tjd - tjd) < fabs(rec.tjd - tjd)) {
+	  rec.tjd = rec2.tjd;
+	  rec.dorb = 0;
 	}
-	fpos2 = fpos1;
-	tjd_ex2 = tjd_ex;
-	while(tjd_ex2 < tjd + PERIOD_PRE_POST && fpos2 < fposlast) {
-	  fpos2 += SWEASP_DAT_RECLEN;
-	  if ((retc = do_fread_asp(fpout, fpos2, &tjd_ex2, &ipla2, &iplb2, &iasp2, &dasp, &dorb2, &tjd_pre2, &tjd_post2, serr)) == ERR)
-	    goto end_extract;
-	  if (ipla == ipla2 && iplb == iplb2 && iasp == iasp2) {
-	    fprintf(stderr, "yytjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f\n", tjd_ex2, tjd_pre2, tjd_post2, ipla2, iplb2, dasp);
-	    fprintf(stderr, "yytjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", tjd_ex2, tjd_pre2, tjd_post2, ipla2, iplb2, dasp, iasp);
-	    /* if previous phases had no exactness, but the current one has
-	     * or is exacter, take over its time of exactness */
-	    if (fabs(dorb2) < fabs(dorb)) {
-	      dorb = dorb2;
-	      tjd_ex = tjd_ex2;
-	    }
-	    /* if there are several exactnesses, select the one closest
-	     * to the required date */
-	    if (dorb2 == 0 && fabs(tjd_ex2 - tjd) < fabs(tjd_ex - tjd)) {
-	      tjd_ex = tjd_ex2;
-	      dorb = 0;
-	    }
-	    if (tjd_post2 > tjd - dtol) {
-	      do_output = TRUE;
-	      tjd_post = tjd_post2;
-	    }
-	    if (tjd_post2 > 0) /* there is no future exactness after that */
-	      break;
-	  }
+	if (rec2.tjd_post > tjd - dtol) {
+	  do_output = TRUE;
+	  rec.tjd_post = rec2.tjd_post;
 	}
-	if (do_output)
-	  fprintf(stderr, "xxtjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", tjd_ex, tjd_pre, tjd_post, ipla, iplb, dasp, iasp);
+	if (rec2.tjd_post > 0) /* there is no future exactness after that */
+	  break;
       }
-
+      if (do_output)
+	fprintf(stderr, "xxtjd_ex=%.1f, tjd_pre=%.1f, tjd_post=%.1f, %d, %d, %.0f %d\n", rec.tjd, rec.tjd_pre, rec.tjd_post, rec.ipla, rec.iplb, rec.dasp, rec.iasp);
     }
-    fpos1 += SWEASP_DAT_RECLEN;
-    if ((retc = do_fread_asp(fpout, fpos1, &tjd_ex, &ipla, &iplb, &iasp, &dasp, &dorb, &tjd_pre, &tjd_post, serr)) == ERR)
-      goto end_extract;
   }
-end_extract:
-  fclose(fpout);
-  if (retc == ERR)
-    fprintf(stderr, serr);
-  return retc;
+  close_sweasp_db(&db);
+  return OK;
 }
 
 int32 calc_all_crossings(
@@ -2782,106 +3170,343 @@ but after that:
 - calculate previous lunar ingress (ti_prev)
 - if ta_last < ti_prev, then ta_last = ti_prev
 */
-static int32 get_next_voc(double tet0, int32 iflag, int32 vocmethod, VOC *pvoc, char *serr) 
+/*
+The generator below computes the void-of-course phases of a time range 
+year by year. For each year, the positions of the Moon and the planets are
+computed with a fixed step width (VOC_MSTEP, VOC_PSTEP) and interpolated
+with Hermite polynomials. In one sweep over these tracks, all lunar 
+ingresses and all lunar aspects are found approximately. Ingresses are
+refined at once, aspects only when they are candidates for the last aspect
+before an ingress. Then the VOC phases of all requested methods are derived
+from the two lists.
+Every year starts its search VOC_WARMUP days early, and only outputs the 
+phases that start in it. Therefore the years are independent of each other,
+and they can be computed in parallel jobs.
+*/
+#define VOC_MSTEP	1.0	/* step width for Moon */
+#define VOC_PSTEP	4.0	/* step width for planets */
+#define VOC_WARMUP	20.0	/* search starts so many days before year */
+#define VOC_MARGIN	10.0	/* tracks extend so many days beyond search */
+#define VOC_DTAPPROX	0.01	/* max. error of approximate times */
+#define VOC_YEAR	365.25
+#define VOC_NPL		9	/* Sun, Mercury, ..., Pluto */
+
+/* Hermite interpolation of longitude (unwrapped) and speed at time t 
+ * from a track with step h, starting at t0 */
+static void voc_track_interp(double t, double t0, double h, double *xlon, double *xspeed, double *lon, double *speed)
 {
-  int32 retc;
-  double tet_asp, daspi, tvoc_end, tingr_save;
-  double tret[2], dasp;
-  int32 ipl, ipllast;
-  int32 isign, isigni, isign_save;
-  int32 isign_ingr;
-  if (vocmethod == 0) vocmethod = 3;
-  /* next ingress */
-  if ((retc = get_sign_ingress_direct_body(tet0, SE_MOON, iflag, 0, &(tret[1]), &isign, serr)) == ERR)
-    return retc;
-  isign_save = isign;
-  tingr_save = tret[1];
-  tvoc_end = tret[1];
-  /* overnext ingress */
-  if (vocmethod == 1 && (retc = get_sign_ingress_direct_body(tret[1] + 1, SE_MOON, iflag, 0, &tvoc_end, &isign, serr)) == ERR)
-    return retc;
-  isign_ingr = isign;
-  /* find the last aspect with a planet within this time range */
-  tret[0] = 0;
-repeat_loop:
-  for (ipl = SE_SUN; ipl <= SE_PLUTO; ipl++) {
-    if (ipl == SE_MOON)
-      continue;
-    if ((retc = get_prev_lunasp(tvoc_end, ipl, iflag, &tet_asp, &daspi, &isigni, serr)) == ERR)
-      return retc;
-    if (vocmethod == 1 && tet_asp > tret[1]) {
-      tvoc_end = tret[1];
-      isign_ingr--;
-      if (isign_ingr < 0) isign_ingr = 11;
-      goto repeat_loop;
-    }
-    if (tet_asp > tret[0]) {
-      tret[0] = tet_asp;
-      dasp = daspi;
-      ipllast = ipl;
-      isign = isigni;
-    }
+  int32 i = (int32) ((t - t0) / h);
+  double u, p0, p1, m0, m1, h00, h10, h01, h11;
+  u = (t - t0) / h - i;
+  p0 = xlon[i];
+  p1 = p0 + swe_difdeg2n(xlon[i + 1], xlon[i]);
+  m0 = xspeed[i] * h;
+  m1 = xspeed[i + 1] * h;
+  h00 = (1 + 2 * u) * (1 - u) * (1 - u);
+  h10 = u * (1 - u) * (1 - u);
+  h01 = u * u * (3 - 2 * u);
+  h11 = u * u * (u - 1);
+  *lon = h00 * p0 + h10 * m0 + h01 * p1 + h11 * m1;
+  if (speed != NULL) 
+    *speed = ((6 * u * u - 6 * u) * (p0 - p1) + (3 * u * u - 4 * u + 1) * m0 + (3 * u * u - 2 * u) * m1) / h;
+}
+
+static int voc_asp_compare(const void *a, const void *b)
+{
+  double d = ((struct vocasp *) a)->tjd - ((struct vocasp *) b)->tjd;
+  if (d < 0) return -1;
+  if (d > 0) return 1;
+  return 0;
+}
+
+static int voc_out_compare(const void *a, const void *b)
+{
+  struct vocout *pa = (struct vocout *) a, *pb = (struct vocout *) b;
+  if (pa->voc.tingr < pb->voc.tingr) return -1;
+  if (pa->voc.tingr > pb->voc.tingr) return 1;
+  return pa->vocmethod - pb->vocmethod;
+}
+
+/* Returns the index of the last lunar aspect before tjd, or -1.
+ * The aspects are sorted by approximate time. Candidates are refined
+ * with get_prev_lunasp(), until no other aspect can be later. */
+static int32 voc_last_asp(double tjd, int32 iflag, struct vocasp *pasp, int32 nasp, char *serr)
+{
+  int32 i, ilo, ihi, ibest = -1;
+  double tret, dasp;
+  int32 isign;
+  /* first aspect with approximate time >= tjd + VOC_DTAPPROX */
+  ilo = 0; ihi = nasp;
+  while (ilo < ihi) {
+    i = (ilo + ihi) / 2;
+    if (pasp[i].tjd < tjd + VOC_DTAPPROX)
+      ilo = i + 1;
+    else
+      ihi = i;
   }
-  tret[1] = tvoc_end;
-  if (vocmethod == 3) {
-    double tingr_prev;
-    /* get previous lunar ingress */
-    if ((retc = get_sign_ingress_direct_body(tet0, SE_MOON, iflag, 1, &tingr_prev, &isign, serr)) == ERR)
-      return retc;
-    if (tret[0] < tingr_prev)
-      tret[0] = tingr_prev;
-  }
-  pvoc->tvoc = tret[0];
-  pvoc->tingr = tret[1];
-  pvoc->casp = get_casp(dasp);
-  pvoc->cpl = (char) ipllast;
-  pvoc->isign_voc = isign;
-  pvoc->isign_ingr = isign_ingr;
-  if (isign_save == isign_ingr) {
-    pvoc->tingr0 = 0;
-    pvoc->isign_ingr0 = 0;
-  } else {
-    pvoc->tingr0 = tingr_save;
-    pvoc->isign_ingr0 = isign_save;
+  for (i = ilo - 1; i >= 0; i--) {
+    if (ibest >= 0 && pasp[i].tjd < pasp[ibest].tjd - 2 * VOC_DTAPPROX)
+      break;
+    if (!pasp[i].is_exact) {
+      if (get_prev_lunasp(pasp[i].tjd + VOC_DTAPPROX, pasp[i].ipl, iflag, &tret, &dasp, &isign, serr) == ERR)
+	return -2;
+      pasp[i].tjd = tret;
+      pasp[i].dasp = dasp;
+      pasp[i].isign = isign;
+      pasp[i].is_exact = TRUE;
+    }
+    if (pasp[i].tjd < tjd && (ibest < 0 || pasp[i].tjd > pasp[ibest].tjd))
+      ibest = i;
   }
-  return OK;
+  return ibest;
 }
 
-static int32 calc_all_voc(int32 iflag, double te, double tend, char *serr)
+static void print_voc(FILE *fp, struct vocout *pout, AS_BOOL show_method)
 {
-  double t, tnext;
   int jday, jmon, jyear, gregflag = SE_GREG_CAL;
   double jut;
-/*  int32 ctyp = CTYP_VOC; */
-  int32 retc;
-  VOC dvoc;
-  /* moon void of course */
-  for (t = te; t < tend; t = tnext) {
-    retc = get_next_voc(t, SEFLG_SPEED, 1, &dvoc, serr);
-    if (retc == ERR) {
-      printf("%s\n", serr);
-      return ERR;
+  VOC *pvoc = &(pout->voc);
+  /* content of voc:
+   * double tvoc;    : time of begin of voc phase 
+   * double tingr;   : time of ingress that ends voc phase 
+   * double tingr0;  : time of first ingress, if there are two ingresses
+   *                   during voc phase 
+   * char casp, cpl; : aspect and planet that marks begin of voc phase 
+   * int isign_voc;  : sign in which moon begins voc phase 
+   * int isign_ingr; : sign of ingress that ends voc phase 
+   * int isign_ingr0;: sign of first ingress, if there are two ingresses
+   *                   during voc phase 
+   */
+  if (show_method)
+    fprintf(fp, "v%d ", pout->vocmethod);
+  swe_revjul(pvoc->tvoc, gregflag, &jyear, &jmon, &jday, &jut);
+  fprintf(fp, "VOCBEG: %d.%d.%d, %f, %d -> ", jday, jmon, jyear, jut, pvoc->isign_voc);
+  swe_revjul(pvoc->tingr, gregflag, &jyear, &jmon, &jday, &jut);
+  fprintf(fp, "VOCEND: %d.%d.%d, %f, %d \n", jday, jmon, jyear, jut, pvoc->isign_ingr);
+  if (pvoc->tingr0 != 0) {
+    swe_revjul(pvoc->tingr0, gregflag, &jyear, &jmon, &jday, &jut);
+    fprintf(fp, "                  -> VOCEND0: %d.%d.%d, %f, %d \n", jday, jmon, jyear, jut, pvoc->isign_ingr0);
+  }
+}
+
+/* Computes the VOC phases that start in the time range ty0 <= t < ty1, 
+ * where t is the search date of a phase, i.e. te or the end of the 
+ * previous phase + 0.1 day. The search begins at te, if ty0 == te, 
+ * otherwise VOC_WARMUP days earlier.
+ * vocmethod is 1, 2, 3, or 0 for all three methods. 
+ * The phases are written to fp, sorted by end time and method. */
+static int32 calc_voc_year(int32 iflag, double te, double ty0, double ty1, int32 vocmethod, FILE *fp, char *serr)
+{
+  static int32 ipl_voc[VOC_NPL] = {SE_SUN, SE_MERCURY, SE_VENUS, SE_MARS, SE_JUPITER, SE_SATURN, SE_URANUS, SE_NEPTUNE, SE_PLUTO};
+  static double dasp_voc[] = {0, 60, 90, 120, 180, 240, 270, 300, 360};
+  int32 retc = ERR;
+  int32 i, j, k, m, ipli, nm, np, ningr = 0, nasp = 0, nout = 0, ia, ia2;
+  int32 nasp_max, ningr_max, nout_max, isign;
+  double tc, ta, tb, t, tend, tvoc, lm, lp, sm, sp, e0, e1, d, x[6];
+  double *xm = NULL, *xms = NULL, *xp = NULL, *xps = NULL;
+  struct vocasp *pasp = NULL;
+  struct vocingr *pingr = NULL;
+  struct vocout *pout = NULL;
+  VOC *pvoc;
+  tc = (ty0 == te) ? te : ty0 - VOC_WARMUP;
+  ta = tc - VOC_MARGIN;
+  tb = ty1 + VOC_MARGIN;
+  nm = (int32) ((tb - ta) / VOC_MSTEP) + 2;
+  np = (int32) ((tb - ta) / VOC_PSTEP) + 3;
+  ningr_max = (int32) ((tb - ta) / 2) + 2;
+  nasp_max = ningr_max * 8 * VOC_NPL;
+  nout_max = ningr_max * 3;
+  xm = (double *) malloc(nm * 2 * sizeof(double));
+  xp = (double *) malloc(np * 2 * VOC_NPL * sizeof(double));
+  pasp = (struct vocasp *) malloc(nasp_max * sizeof(struct vocasp));
+  pingr = (struct vocingr *) malloc(ningr_max * sizeof(struct vocingr));
+  pout = (struct vocout *) malloc(nout_max * sizeof(struct vocout));
+  if (xm == NULL || xp == NULL || pasp == NULL || pingr == NULL || pout == NULL) {
+    strcpy(serr, "error in malloc() for void of course search");
+    goto end_voc;
+  }
+  xms = xm + nm;
+  xps = xp + np * VOC_NPL;
+  /* tracks of Moon and planets */
+  for (i = 0; i < nm; i++) {
+    if (swe_calc(ta + i * VOC_MSTEP, SE_MOON, iflag, x, serr) == ERR) 
+      goto end_voc;
+    xm[i] = x[0];
+    xms[i] = x[3];
+  }
+  for (ipli = 0; ipli < VOC_NPL; ipli++) {
+    for (i = 0; i < np; i++) {
+      if (swe_calc(ta + i * VOC_PSTEP, ipl_voc[ipli], iflag, x, serr) == ERR) 
+	goto end_voc;
+      xp[ipli * np + i] = x[0];
+      xps[ipli * np + i] = x[3];
     }
-    /* content of dvoc:
-     * double tvoc;    : time of begin of voc phase 
-     * double tingr;   : time of ingress that ends voc phase 
-     * double tingr0;  : time of first ingress, if there are two ingresses
-     *                   during voc phase 
-     * char casp, cpl; : aspect and planet that marks begin of voc phase 
-     * int isign_voc;  : sign in which moon begins voc phase 
-     * int isign_ingr; : sign of ingress that ends voc phase 
-     * int isign_ingr0;: sign of first ingress, if there are two ingresses
-     *                   during voc phase 
-     */
-    swe_revjul(dvoc.tvoc, gregflag, &jyear, &jmon, &jday, &jut);
-    printf("VOCBEG: %d.%d.%d, %f, %d -> ", jday, jmon, jyear, jut, dvoc.isign_voc);
-    swe_revjul(dvoc.tingr, gregflag, &jyear, &jmon, &jday, &jut);
-    printf("VOCEND: %d.%d.%d, %f, %d \n", jday, jmon, jyear, jut, dvoc.isign_ingr);
-    if (dvoc.tingr0 != 0) {
-      swe_revjul(dvoc.tingr0, gregflag, &jyear, &jmon, &jday, &jut);
-      printf("                  -> VOCEND0: %d.%d.%d, %f, %d \n", jday, jmon, jyear, jut, dvoc.isign_ingr0);
+  }
+  /* sweep: ingresses and approximate aspects */
+  for (i = 0; i < nm - 1; i++) {
+    t = ta + i * VOC_MSTEP;
+    e0 = xm[i];
+    e1 = e0 + swe_difdeg2n(xm[i + 1], xm[i]);
+    if ((int32) floor(e1 / 30) != (int32) floor(e0 / 30) && ningr < ningr_max) {
+      /* approximate time, by Newton iteration on the interpolated track */
+      d = floor(e1 / 30) * 30;
+      tend = t + (d - e0) / (e1 - e0) * VOC_MSTEP;
+      for (k = 0; k < 3; k++) {
+	voc_track_interp(tend, ta, VOC_MSTEP, xm, xms, &lm, &sm);
+	tend += swe_difdeg2n(d, lm) / sm;
+      }
+      if (get_sign_ingress_direct_body(tend - VOC_DTAPPROX, SE_MOON, iflag, 0, &(pingr[ningr].tjd), &isign, serr) == ERR)
+	goto end_voc;
+      pingr[ningr].isign = isign;
+      ningr++;
+    }
+    for (ipli = 0; ipli < VOC_NPL; ipli++) {
+      voc_track_interp(t, ta, VOC_PSTEP, xp + ipli * np, xps + ipli * np, &lp, NULL);
+      e0 = swe_degnorm(xm[i] - lp);
+      voc_track_interp(t + VOC_MSTEP, ta, VOC_PSTEP, xp + ipli * np, xps + ipli * np, &lp, NULL);
+      e1 = e0 + swe_difdeg2n(swe_degnorm(xm[i + 1] - lp), e0);
+      for (k = 0; k < 9; k++) {
+	d = dasp_voc[k];
+	if (!(e0 < d && d <= e1) || nasp >= nasp_max)
+	  continue;
+	tend = t + (d - e0) / (e1 - e0) * VOC_MSTEP;
+	for (j = 0; j < 3; j++) {
+	  voc_track_interp(tend, ta, VOC_MSTEP, xm, xms, &lm, &sm);
+	  voc_track_interp(tend, ta, VOC_PSTEP, xp + ipli * np, xps + ipli * np, &lp, &sp);
+	  tend += swe_difdeg2n(d, lm - lp) / (sm - sp);
+	}
+	pasp[nasp].tjd = tend;
+	pasp[nasp].ipl = ipl_voc[ipli];
+	pasp[nasp].dasp = fmod(d, 360);
+	pasp[nasp].isign = 0;
+	pasp[nasp].is_exact = FALSE;
+	nasp++;
+      }
+    }
+  }
+  qsort((void *) pasp, (size_t) nasp, sizeof(struct vocasp), voc_asp_compare);
+  /* VOC phases of all methods */
+  for (m = 1; m <= 3; m++) {
+    if (vocmethod != 0 && m != vocmethod)
+      continue;
+    for (t = tc; t < ty1; t = pvoc->tingr + 0.1) {
+      /* next ingress */
+      for (k = 0; k < ningr && pingr[k].tjd <= t; k++)
+	;
+      if (k == 0 || k + 1 >= ningr || nout >= nout_max) {
+	sprintf(serr, "void of course search: no ingress around %f", t);
+	goto end_voc;
+      }
+      pvoc = &(pout[nout].voc);
+      pout[nout].vocmethod = m;
+      if ((ia = voc_last_asp(pingr[k].tjd, iflag, pasp, nasp, serr)) < -1)
+	goto end_voc;
+      pvoc->tingr = pingr[k].tjd;
+      pvoc->isign_ingr = pingr[k].isign;
+      pvoc->tingr0 = 0;
+      pvoc->isign_ingr0 = 0;
+      /* method 1: without aspect in the following sign, the phase lasts 
+       * until the overnext ingress */
+      if (m == 1) {
+	if ((ia2 = voc_last_asp(pingr[k + 1].tjd, iflag, pasp, nasp, serr)) < -1)
+	  goto end_voc;
+	if (ia2 >= 0 && pasp[ia2].tjd < pingr[k].tjd) {
+	  ia = ia2;
+	  pvoc->tingr = pingr[k + 1].tjd;
+	  pvoc->isign_ingr = pingr[k + 1].isign;
+	  pvoc->tingr0 = pingr[k].tjd;
+	  pvoc->isign_ingr0 = pingr[k].isign;
+	}
+      }
+      if (ia < 0) {
+	sprintf(serr, "void of course search: no aspect before %f", pingr[k].tjd);
+	goto end_voc;
+      }
+      tvoc = pasp[ia].tjd;
+      pvoc->tvoc = tvoc;
+      pvoc->casp = get_casp(pasp[ia].dasp);
+      pvoc->cpl = (char) pasp[ia].ipl;
+      pvoc->isign_voc = pasp[ia].isign;
+      /* method 3: phase does not start before the previous ingress */
+      if (m == 3 && tvoc < pingr[k - 1].tjd) {
+	pvoc->tvoc = pingr[k - 1].tjd;
+	pvoc->isign_voc = pingr[k - 1].isign;
+      }
+      if (t >= ty0)
+	nout++;
+    }
+  }
+  qsort((void *) pout, (size_t) nout, sizeof(struct vocout), voc_out_compare);
+  for (i = 0; i < nout; i++)
+    print_voc(fp, &(pout[i]), (vocmethod == 0));
+  retc = OK;
+end_voc:
+  if (xm != NULL) free(xm);
+  if (xp != NULL) free(xp);
+  if (pasp != NULL) free(pasp);
+  if (pingr != NULL) free(pingr);
+  if (pout != NULL) free(pout);
+  return retc;
+}
+
+#if !MSDOS
+/* job of the void of course search: a range of years */
+static int32 voc_job(int32 ij, void *pdata, FILE *fp, char *serr)
+{
+  struct vocjob *pj = (struct vocjob *) pdata;
+  int32 iy;
+  int32 iybeg = (int32) ((double) pj->nyear * ij / pj->njobs);
+  int32 iyend = (int32) ((double) pj->nyear * (ij + 1) / pj->njobs);
+  double ty0, ty1;
+  for (iy = iybeg; iy < iyend; iy++) {
+    ty0 = pj->te + iy * VOC_YEAR;
+    ty1 = (iy == pj->nyear - 1) ? pj->tend : ty0 + VOC_YEAR;
+    if (calc_voc_year(pj->iflag, pj->te, ty0, ty1, pj->vocmethod, fp, serr) == ERR)
+      return ERR;
+  }
+  return OK;
+}
+#endif
+
+/* Lunar void-of-course phases from te to tend, for method vocmethod 
+ * (1, 2, 3; 0 = all methods). The phases are output year by year; with 
+ * option -jobsN, the years are computed in parallel jobs. */
+static int32 calc_all_voc(int32 iflag, double te, double tend, int32 vocmethod, char *serr)
+{
+  int32 iy, nyear;
+  double ty0, ty1;
+  nyear = (int32) ceil((tend - te) / VOC_YEAR);
+  if (nyear < 1) 
+    nyear = 1;
+#if !MSDOS
+  if (njobs > 1 && nyear > 1) {
+    int32 ij, retc;
+    int c;
+    FILE *fpjob[NJOBS_MAX];
+    struct vocjob job;
+    job.iflag = iflag;
+    job.te = te;
+    job.tend = tend;
+    job.vocmethod = vocmethod;
+    job.nyear = nyear;
+    job.njobs = (njobs > nyear ? nyear : njobs);
+    retc = run_jobs(job.njobs, voc_job, (void *) &job, fpjob, serr);
+    for (ij = 0; ij < job.njobs; ij++) {
+      if (fpjob[ij] == NULL)
+	continue;
+      while (retc == OK && (c = fgetc(fpjob[ij])) != EOF)
+	putchar(c);
+      fclose(fpjob[ij]);
     }
-    tnext = dvoc.tingr + 0.1;
+    return retc;
+  }
+#endif
+  for (iy = 0; iy < nyear; iy++) {
+    ty0 = te + iy * VOC_YEAR;
+    ty1 = (iy == nyear - 1) ? tend : ty0 + VOC_YEAR;
+    if (calc_voc_year(iflag, te, ty0, ty1, vocmethod, stdout, serr) == ERR)
+      return ERR;
+    fflush(stdout);
   }
   return OK;
 }
@@ -82,6 +82,89 @@ struct aspdat {
   int32 fpos_tjd_post;
 };
 
+/* body of the aspect search, decoded from the planets string */
+struct aspbody {
+  int32 ipl;
+  char stnam[40];		/* name of fixed star, if ipl == SE_FIXSTAR */
+  AS_BOOL is_nodaps;		/* node or apsis */
+};
+
+/* parameters of a parallel job of the aspect search */
+struct aspjob {
+  int32 iflag;
+  double tjd0, tstep;
+  int32 nstep, njobs;
+  int32 nbody;
+  struct aspbody *pbody;
+  int32 nasp;
+  char *saspi;
+  double *dasp;
+};
+
+/* aspect database sweasp.dat, written by calc_mundane_aspects().
+ * file layout:
+ *   struct sweasp_head
+ *   free text description, terminated by a line "####...\n"
+ *   nrec aspect records of SWEASP_DAT_RECLEN bytes, sorted by time:
+ *     double time of exactness (TT), int32 planet a, int32 planet b,
+ *     int32 aspect number, double aspect angle, double orb,
+ *     double time of entering orb, double time of leaving orb
+ *   time index: int32[nbucket + 1], number of first record with
+ *     time >= tjd_beg + i * tbucket
+ *   body pair index: struct sweasp_pair[npair], sorted by ipla, iplb
+ *   body pair record lists: int32[nrec], record numbers grouped by 
+ *     body pair, in time order
+ * All numbers are in the byte order of the machine that wrote the file.
+ */
+#define SWEASP_MAGIC		"SWEASP"
+#define SWEASP_VERSION		2
+#define SWEASP_TEST_ENDIAN	(0x616263L) 	/* abc*/ 
+#define SWEASP_DAT_RECLEN	52
+#define SWEASP_TBUCKET		10.0	/* days per bucket of time index */
+
+struct sweasp_head {
+  char magic[8];
+  int32 version;
+  int32 endian;		/* SWEASP_TEST_ENDIAN */
+  int32 reclen;		/* SWEASP_DAT_RECLEN */
+  int32 nrec;		/* number of aspect records */
+  double tjd_beg;	/* time of first record */
+  double tjd_end;	/* time of last record */
+  double tbucket;	/* width of time index buckets, in days */
+  int32 nbucket;
+  int32 npair;
+  int32 fpos_text;	/* file positions of the parts of the file */
+  int32 fpos_rec;
+  int32 fpos_tindex;
+  int32 fpos_pindex;
+  int32 fpos_plist;
+  int32 reserved;
+};
+
+struct sweasp_pair {
+  int32 ipla, iplb;
+  int32 ilist;		/* index of first record number in pair list */
+  int32 nlist;		/* number of records of this pair */
+};
+
+struct sweasp_rec {
+  double tjd;
+  int32 ipla, iplb, iasp;
+  double dasp, dorb, tjd_pre, tjd_post;
+};
+
+/* aspect database in memory (mapped or read) */
+struct sweasp_db {
+  struct sweasp_head head;
+  char *fbuf;		/* whole file */
+  size_t flen;
+  AS_BOOL is_mapped;
+  char *prec;		/* first record */
+  int32 *tindex;
+  struct sweasp_pair *pindex;
+  int32 *plist;
+};
+
 #define CTYP_MASPECTS	0
 #define CTYP_INGRESSES	1
 #define CTYP_TRANSITS	2
@@ -107,6 +190,33 @@ VOC {
                     * during voc phase */
 };
 
+/* lunar aspect or ingress, for the void of course search */
+struct vocasp {
+  double tjd;		/* approximate or exact time */
+  int32 ipl;		/* planet */
+  double dasp;		/* aspect angle */
+  int32 isign;		/* sign of the Moon */
+  AS_BOOL is_exact;	/* tjd and isign are refined */
+};
+
+struct vocingr {
+  double tjd;
+  int32 isign;		/* sign that the Moon enters */
+};
+
+struct vocout {
+  int32 vocmethod;
+  VOC voc;
+};
+
+/* parameters of a parallel job of the void of course search */
+struct vocjob {
+  int32 iflag;
+  double te, tend;
+  int32 vocmethod;
+  int32 nyear, njobs;
+};
+
 #define INGRESS	struct ingress
 
 INGRESS {
@@ -0,0 +1,459 @@
+/********************************************************************
+sweverify.c
+
+Check the integrity and the layout of ephemeris files before they
+are deployed, and measure how fast they are decoded.
+
+usage: sweverify [options] file ...
+
+options: -i	dump the segment index: segment number, start date,
+		file position and size of every segment
+	 -jN	greatest tolerated discontinuity of a body between two
+		adjacent segments, in arc seconds as seen from the center
+		of the body's coordinates, default 0.1
+
+Swiss Ephemeris files (*.se1) are opened with the same code as 
+swe_calc() uses (read_const()), which checks the file name, the file 
+length and the CRC of the header. Then, for every body of the file,
+- the constants (coefficients, segment size, range) must be sane
+  and the segment index must lie within the file,
+- every segment is decoded (get_new_segment()) and rotated back, 
+  its data must lie within the file,
+- the position at the end of a segment must agree with the position
+  at the start of the next one within the tolerance of -j.
+Finally no two of header, indices and segments may overlap. 
+Bytes used by none of them are reported as unused.
+The decoding of all segments is timed in a second pass.
+
+Other files are taken as JPL ephemeris files. The file length and 
+the dates of the first and the last record are checked when the 
+file is opened (swejpl.c), the dates of all records are checked
+here. All records are evaluated for every body, and the positions
+just before and after each record boundary must agree.
+
+Per body, the number of segments (records), their size and the
+decoding time are printed. The exit code is 1 if an error was found.
+
+*********************************************************************/
+/* Copyright (C) 1997 - 2021 Astrodienst AG, Switzerland.  All rights reserved.
+
+  License conditions
+  ------------------
+
+  This file is part of Swiss Ephemeris.
+
+  Swiss Ephemeris is distributed with NO WARRANTY OF ANY KIND.  No author
+  or distributor accepts any responsibility for the consequences of using it,
+  or for whether it serves any particular purpose or works at all, unless he
+  or she says so in writing.
+
+  Swiss Ephemeris is made available by its authors under a dual licensing
+  system. The software developer, who uses any part of Swiss Ephemeris
+  in his or her software, must choose between one of the two license models,
+  which are
+  a) GNU Affero General Public License (AGPL)
+  b) Swiss Ephemeris Professional License
+
+  The choice must be made before the software developer distributes software
+  containing parts of Swiss Ephemeris to others, and before any public
+  service using the developed software is activated.
+
+  If the developer choses the AGPL software license, he or she must fulfill
+  the conditions of that license, which includes the obligation to place his
+  or her whole software project under the AGPL or a compatible license.
+  See https://www.gnu.org/licenses/agpl-3.0.html
+
+  If the developer choses the Swiss Ephemeris Professional license,
+  he must follow the instructions as found in http://www.astro.com/swisseph/
+  and purchase the Swiss Ephemeris Professional Edition from Astrodienst
+  and sign the corresponding license contract.
+
+  The License grants you the right to use, copy, modify and redistribute
+  Swiss Ephemeris, but only under certain conditions described in the License.
+  Among other things, the License requires that the copyright notices and
+  this notice be preserved on all copies.
+
+  Authors of the Swiss Ephemeris: Dieter Koch and Alois Treindl
+
+  The authors of Swiss Ephemeris have no control or influence over any of
+  the derived works, i.e. over software or services created by other
+  programmers which use Swiss Ephemeris functions.
+
+  The names of the authors or of the copyright holder (Astrodienst) must not
+  be used for promoting any software, product or service which uses or contains
+  the Swiss Ephemeris. This copyright notice is the ONLY place where the
+  names of the authors can legally appear, except in cases where they have
+  given special permission in writing.
+
+  The trademarks 'Swiss Ephemeris' and 'Swiss Ephemeris inside' may be used
+  for promoting such software, products or services.
+*/
+
+# include <time.h>
+# include "swephexp.h"
+# include "sweph.h"
+# include "swephlib.h"
+# include "swejpl.h"
+
+/* part of an ephemeris file: header, segment index or segment */
+struct region {
+  int32 fpos, len;
+  int ipl;		/* -1 header, otherwise body */
+  int32 iseg;		/* -1 index, otherwise segment number */
+};
+
+static char *sei_name[SEI_NPLANETS] = {
+  "Earth/EMB", "Moon", "Mercury", "Venus", "Mars", "Jupiter", 
+  "Saturn", "Uranus", "Neptune", "Pluto", "Sun bary", "asteroid",
+  "Chiron", "Pholus", "Ceres", "Pallas", "Juno", "Vesta",
+};
+
+static char *jpl_name[13] = {
+  "Mercury", "Venus", "EMB", "Mars", "Jupiter", "Saturn", 
+  "Uranus", "Neptune", "Pluto", "Moon", "Sun", "nutation", "libration",
+};
+
+static char *arg0;
+static AS_BOOL dump_index = FALSE;
+static double maxjump = 0.1;	/* arc seconds */
+static int nerr;
+
+/* errors of a body beyond this number are counted, but not printed */
+#define MAX_PRINTED_ERRORS	5
+
+static void report_error(char *s, int *nerr_body)
+{
+  nerr++;
+  if (nerr_body != NULL && ++(*nerr_body) > MAX_PRINTED_ERRORS)
+    return;
+  printf("  ERROR: %s\n", s);
+}
+
+static int compare_regions(const void *a, const void *b)
+{
+  int32 d = ((const struct region *) a)->fpos - ((const struct region *) b)->fpos;
+  return d < 0 ? -1 : d > 0 ? 1 : 0;
+}
+
+static double elapsed(clock_t t0)
+{
+  return (double) (clock() - t0) / CLOCKS_PER_SEC;
+}
+
+/* file number as in swi_gen_filename() */
+static int file_number(char *fname)
+{
+  char *sp = strrchr(fname, (int) *DIR_GLUE);
+  sp = (sp == NULL) ? fname : sp + 1;
+  if (strncmp(sp, "sepl", 4) == 0)
+    return SEI_FILE_PLANET;
+  if (strncmp(sp, "semo", 4) == 0)
+    return SEI_FILE_MOON;
+  if (strncmp(sp, "seas", 4) == 0)
+    return SEI_FILE_MAIN_AST;
+  if (strncmp(sp, "sepm", 4) == 0)
+    return SEI_FILE_PLMOON;
+  return SEI_FILE_ANY_AST;
+}
+
+static void verify_sweph(char *fname)
+{
+  int ifno, kpl, ipl, ipli, i, nerr_body;
+  int32 iseg, fpos, len, lenmax, nreg, hdrend, flen, nunused;
+  int32 nbytes_ndx, nbytes_seg;
+  double xend[3], x[3], d, jump, jumpmax, tjump, tdecode;
+  char serr[AS_MAXCH], s[AS_MAXCH * 2], sname[AS_MAXCH];
+  struct file_data *fdp;
+  struct plan_data *pdp;
+  struct region *reg;
+  FILE *fp;
+  clock_t t0;
+  ifno = file_number(fname);
+  *serr = '\0';
+  if (swi_open_ephe_file(ifno, fname, serr) != OK) {
+    printf("%s:\n", fname);
+    report_error(serr, NULL);
+    return;
+  }
+  fdp = &swed.fidat[ifno];
+  fp = fdp->fptr;
+  hdrend = (int32) ftell(fp);
+  fseek(fp, 0L, SEEK_END);
+  flen = (int32) ftell(fp);
+  printf("%s: Swiss Ephemeris file version %d, DE%d, %s byte order\n", fname,
+    fdp->fversion, fdp->sweph_denum, 
+    (fdp->iflg & SEI_FILE_REORD) ? "reversed" : "native");
+  printf("  JD %.1f - %.1f, %d bodies, %d bytes, header %d bytes\n", 
+    fdp->tfstart, fdp->tfend, fdp->npl, flen, hdrend);
+  if (swi_read_segment_index(ifno, serr) != OK) {
+    report_error(serr, NULL);
+    return;
+  }
+  nreg = 1;
+  for (kpl = 0; kpl < fdp->npl; kpl++) {
+    ipli = fdp->ipl[kpl] >= SE_PLMOON_OFFSET ? SEI_ANYBODY : fdp->ipl[kpl];
+    nreg += 1 + swed.pldat[ipli].nndx;
+  }
+  if ((reg = (struct region *) malloc((size_t) nreg * sizeof(struct region))) == NULL) {
+    fprintf(stderr, "%s: error in malloc()\n", arg0);
+    exit(1);
+  }
+  reg[0].fpos = 0;
+  reg[0].len = hdrend;
+  reg[0].ipl = -1;
+  reg[0].iseg = -1;
+  nreg = 1;
+  printf("  %-10s %6s %4s %7s %6s %10s %7s %10s %12s\n", "body", "ipl", "ncoe", 
+    "dseg", "nseg", "bytes", "max", "us/seg", "jump[\"]");
+  for (kpl = 0; kpl < fdp->npl; kpl++) {
+    ipl = fdp->ipl[kpl];
+    ipli = ipl >= SE_PLMOON_OFFSET ? SEI_ANYBODY : ipl;
+    pdp = &swed.pldat[ipli];
+    if (ipli == SEI_ANYBODY && *fdp->astnam != '\0')
+      sprintf(sname, "%.10s", fdp->astnam);
+    else
+      strcpy(sname, sei_name[ipli]);
+    nerr_body = 0;
+    if (pdp->ncoe < 1 || pdp->ncoe > MAXORD + 1 || pdp->dseg <= 0 
+      || pdp->tfend <= pdp->tfstart || pdp->nndx < 1 || pdp->rmax <= 0) {
+      sprintf(s, "%s: bad constants, ncoe %d, dseg %f, JD %f - %f, rmax %f", 
+	sname, pdp->ncoe, pdp->dseg, pdp->tfstart, pdp->tfend, pdp->rmax);
+      report_error(s, &nerr_body);
+      continue;
+    }
+    nbytes_ndx = pdp->nndx * 3;
+    if (pdp->lndx0 < hdrend || pdp->lndx0 + nbytes_ndx > flen) {
+      sprintf(s, "%s: index at %d - %d outside of data", sname, pdp->lndx0, pdp->lndx0 + nbytes_ndx);
+      report_error(s, &nerr_body);
+      continue;
+    }
+    reg[nreg].fpos = pdp->lndx0;
+    reg[nreg].len = nbytes_ndx;
+    reg[nreg].ipl = ipl;
+    reg[nreg].iseg = -1;
+    nreg++;
+    if (dump_index)
+      printf("  %s: index at %d, %d segments\n", sname, pdp->lndx0, pdp->nndx);
+    nbytes_seg = 0;
+    lenmax = 0;
+    jumpmax = 0;
+    tjump = 0;
+    for (iseg = 0; iseg < pdp->nndx; iseg++) {
+      fpos = pdp->segidx[iseg];
+      if (fpos < hdrend || fpos >= flen) {
+	sprintf(s, "%s: segment %d at %d outside of data", sname, iseg, fpos);
+	report_error(s, &nerr_body);
+	continue;
+      }
+      if (swi_get_ephe_segment(ifno, ipli, iseg, TRUE, serr) != OK) {
+	/* the file has been closed */
+	sprintf(s, "%s: segment %d at %d: %s", sname, iseg, fpos, serr);
+	report_error(s, NULL);
+	free((void *) reg);
+	return;
+      }
+      len = (int32) ftell(fp) - fpos;
+      reg[nreg].fpos = fpos;
+      reg[nreg].len = len;
+      reg[nreg].ipl = ipl;
+      reg[nreg].iseg = iseg;
+      nreg++;
+      nbytes_seg += len;
+      if (len > lenmax)
+	lenmax = len;
+      if (dump_index)
+	printf("  %6d %12.1f %10d %5d\n", iseg, pdp->tseg0, fpos, len);
+      /* continuity with the previous segment */
+      for (i = 0; i <= 2; i++)
+	x[i] = swi_echeb(-1.0, pdp->segp + i * pdp->ncoe, pdp->neval);
+      if (iseg > 0) {
+	for (i = 0, d = 0; i <= 2; i++)
+	  d += (x[i] - xend[i]) * (x[i] - xend[i]);
+	jump = sqrt(d / square_sum(x)) * RADTODEG * 3600;
+	if (jump > jumpmax) {
+	  jumpmax = jump;
+	  tjump = pdp->tseg0;
+	}
+      }
+      for (i = 0; i <= 2; i++)
+	xend[i] = swi_echeb(1.0, pdp->segp + i * pdp->ncoe, pdp->neval);
+    }
+    if (jumpmax > maxjump) {
+      sprintf(s, "%s: discontinuity of %.4f\" at JD %.1f", sname, jumpmax, tjump);
+      report_error(s, &nerr_body);
+    }
+    /* second pass: decoding only */
+    tdecode = 0;
+    if (nerr_body == 0) {
+      t0 = clock();
+      for (iseg = 0; iseg < pdp->nndx; iseg++) {
+	if (swi_get_ephe_segment(ifno, ipli, iseg, TRUE, serr) != OK) {
+	  report_error(serr, NULL);
+	  free((void *) reg);
+	  return;
+	}
+      }
+      tdecode = elapsed(t0) / pdp->nndx * 1e6;
+    }
+    printf("  %-10s %6d %4d %7.1f %6d %10d %7d %10.3f %12.6f\n", sname, ipl, 
+      pdp->ncoe, pdp->dseg, pdp->nndx, nbytes_seg, lenmax, tdecode, jumpmax);
+    if (nerr_body > MAX_PRINTED_ERRORS)
+      printf("  (%d more errors of %s)\n", nerr_body - MAX_PRINTED_ERRORS, sname);
+  }
+  /* layout: header, indices and segments must not overlap */
+  qsort((void *) reg, (size_t) nreg, sizeof(struct region), compare_regions);
+  nerr_body = 0;
+  nunused = 0;
+  for (i = 0; i < nreg; i++) {
+    fpos = (i < nreg - 1) ? reg[i+1].fpos : flen;
+    if (reg[i].fpos + reg[i].len > fpos) {
+      sprintf(s, "%s %d of body %d at %d - %d overlaps the data at %d", 
+	reg[i].iseg < 0 ? "index" : "segment", reg[i].iseg, reg[i].ipl, 
+	reg[i].fpos, reg[i].fpos + reg[i].len, fpos);
+      report_error(s, &nerr_body);
+    } else {
+      nunused += fpos - (reg[i].fpos + reg[i].len);
+    }
+  }
+  printf("  layout: %d regions, %d bytes unused\n", nreg, nunused);
+  free((void *) reg);
+  swe_close();
+}
+
+static void verify_jpl(char *fname)
+{
+  int ibdy, i, retc, nerr_body;
+  int32 irec, nrec, ndbl, ipt[39];
+  double ss[3], ts[2], tb, dt = 1e-4, xm[6], xp[6], d, dx, jump, jumpmax, tjump, tdecode;
+  char serr[AS_MAXCH], s[AS_MAXCH * 2], fpath[AS_MAXCH], *sp;
+  clock_t t0;
+  *serr = '\0';
+  strncpy(fpath, fname, AS_MAXCH - 1);
+  fpath[AS_MAXCH - 1] = '\0';
+  if ((sp = strrchr(fpath, (int) *DIR_GLUE)) != NULL) {
+    *sp = '\0';
+    sp = fname + (sp - fpath) + 1;
+  } else {
+    strcpy(fpath, ".");
+    sp = fname;
+  }
+  retc = swi_open_jpl_file(ss, sp, fpath, serr);
+  if (retc != OK) {
+    printf("%s:\n", fname);
+    if (*serr == '\0')
+      sprintf(serr, "%s is no ephemeris file", fname);
+    report_error(serr, NULL);
+    swi_close_jpl_file();
+    return;
+  }
+  nrec = (int32) ((ss[1] - ss[0]) / ss[2] + 0.5);
+  printf("%s: JPL ephemeris DE%d\n", fname, swi_get_jpl_denum());
+  printf("  JD %.1f - %.1f, %d records of %.1f days\n", ss[0], ss[1], nrec, ss[2]);
+  /* dates of the records */
+  nerr_body = 0;
+  for (irec = 0; irec < nrec; irec++) {
+    tb = ss[0] + irec * ss[2];
+    if ((retc = swi_get_jpl_record(tb + ss[2] / 2, ts, ipt, serr)) != OK) {
+      report_error(serr, NULL);
+      swi_close_jpl_file();
+      return;
+    }
+    if (ts[0] != tb || ts[1] != tb + ss[2]) {
+      sprintf(s, "record %d has dates %.1f - %.1f instead of %.1f - %.1f", 
+	irec, ts[0], ts[1], tb, tb + ss[2]);
+      report_error(s, &nerr_body);
+    }
+  }
+  if (nerr_body > MAX_PRINTED_ERRORS)
+    printf("  (%d more errors of record dates)\n", nerr_body - MAX_PRINTED_ERRORS);
+  printf("  %-10s %4s %4s %8s %12s %10s %12s\n", "body", "ncf", "nsub", 
+    "doubles", "bytes", "us/rec", "jump[\"]");
+  for (ibdy = 0; ibdy < 13; ibdy++) {
+    if (ipt[ibdy * 3 + 1] <= 0 || ipt[ibdy * 3 + 2] <= 0)
+      continue;
+    ndbl = ipt[ibdy * 3 + 1] * ipt[ibdy * 3 + 2] * (ibdy == 11 ? 2 : 3);
+    tdecode = 0;
+    jumpmax = 0;
+    tjump = 0;
+    nerr_body = 0;
+    if (ibdy <= J_SUN) {
+      t0 = clock();
+      for (irec = 0; irec < nrec; irec++) {
+	if ((retc = swi_pleph(ss[0] + (irec + 0.5) * ss[2], ibdy, J_SBARY, xm, serr)) != OK) {
+	  report_error(serr, NULL);
+	  swi_close_jpl_file();
+	  return;
+	}
+      }
+      tdecode = elapsed(t0) / nrec * 1e6;
+      /* positions just before and after the record boundaries,
+       * corrected for the motion in between */
+      for (irec = 1; irec < nrec; irec++) {
+	tb = ss[0] + irec * ss[2];
+	if ((retc = swi_pleph(tb - dt, ibdy, J_SBARY, xm, serr)) != OK
+	  || (retc = swi_pleph(tb + dt, ibdy, J_SBARY, xp, serr)) != OK) {
+	  report_error(serr, NULL);
+	  swi_close_jpl_file();
+	  return;
+	}
+	for (i = 0, d = 0; i <= 2; i++) {
+	  dx = xp[i] - xm[i] - (xp[i+3] + xm[i+3]) * dt;
+	  d += dx * dx;
+	}
+	jump = sqrt(d / square_sum(xp)) * RADTODEG * 3600;
+	if (jump > jumpmax) {
+	  jumpmax = jump;
+	  tjump = tb;
+	}
+      }
+      if (jumpmax > maxjump) {
+	sprintf(s, "%s: discontinuity of %.4f\" at JD %.1f", jpl_name[ibdy], jumpmax, tjump);
+	report_error(s, &nerr_body);
+      }
+    }
+    printf("  %-10s %4d %4d %8d %12.0f %10.3f %12.6f\n", jpl_name[ibdy], 
+      ipt[ibdy * 3 + 1], ipt[ibdy * 3 + 2], ndbl, (double) ndbl * 8 * nrec, 
+      tdecode, jumpmax);
+  }
+  swi_close_jpl_file();
+}
+
+int main(int argc, char **argv)
+{
+  int i, nfiles = 0;
+  char *sp;
+  arg0 = argv[0];
+  for (i = 1; i < argc; i++) {
+    if (*argv[i] != '-') {
+      nfiles++;
+      continue;
+    }
+    if (strcmp(argv[i], "-i") == 0) {
+      dump_index = TRUE;
+    } else if (strncmp(argv[i], "-j", 2) == 0) {
+      maxjump = atof(argv[i] + 2);
+    } else {
+      fprintf(stderr, "%s: illegal option %s\n", arg0, argv[i]);
+      exit(1);
+    }
+  }
+  if (nfiles == 0) {
+    fprintf(stderr, "usage: %s [-i] [-jN] file ...\n", arg0);
+    exit(1);
+  }
+  for (i = 1; i < argc; i++) {
+    if (*argv[i] == '-')
+      continue;
+    sp = strrchr(argv[i], '.');
+    if (sp != NULL && strcmp(sp + 1, SE_FILE_SUFFIX) == 0)
+      verify_sweph(argv[i]);
+    else
+      verify_jpl(argv[i]);
+  }
+  if (nerr > 0) {
+    printf("%d errors\n", nerr);
+    return 1;
+  }
+  printf("no errors\n");
+  return 0;
+}